@@ -8,7 +8,7 @@ local texture = require("texture")
 
 local gifrecorder = {}
 
-gifrecorder._VERSION = "1.1.0"
+gifrecorder._VERSION = "1.3.0"
 
 local KEY_F7 = 64
 local KEY_F8 = 65
@@ -32,7 +32,10 @@ end
 --- Record a single frame
 function gifrecorder.Recorder:record()
     local render_texture = graphics.get_render_texture()
-    table.insert(self.frames, texture.copy(render_texture))
+
+    -- Snapshots share unchanged tiles with the previous frame
+    local previous = self.frames[#self.frames]
+    table.insert(self.frames, render_texture:snapshot(previous))
 end
 
 --- Save gif with given filename
@@ -40,16 +43,22 @@ end
 function gifrecorder.Recorder:save(filename)
     local frames = {}
 
-    for _, frame in ipairs(self.frames) do
+    for _, snapshot in ipairs(self.frames) do
+        local frame = snapshot:to_texture()
         local w = frame.width * self.scale
         local h = frame.height * self.scale
         local t = texture.new(w, h)
         t:blit(frame, 0, 0, w, h)
+        texture.release(frame)
 
         table.insert(frames, t)
     end
 
     gif.save(filename, frames)
+
+    for _, frame in ipairs(frames) do
+        texture.release(frame)
+    end
 end
 
 --- Clear internal frame buffer
@@ -66,7 +75,9 @@ function gifrecorder.Recorder:update()
 
             print(string.format("Saving %s", name))
 
-            gif.save(name, texture.copy(graphics.get_render_texture()))
+            local screenshot = texture.copy(graphics.get_render_texture())
+            gif.save(name, screenshot)
+            texture.release(screenshot)
 
         -- Record the screen
         elseif keyboard.key(KEY_F8) then
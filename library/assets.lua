@@ -9,6 +9,12 @@ local assets = {}
 --- @return texture Texture userdata if found, nil otherwise.
 function assets.get_texture(filename, frame) end
 
+--- Get sprite compiled from texture for given filename and frame. Sprites are compiled the first time they are requested, with color 0 as the transparent color.
+--- @param filename string  Name of texture asset to look for
+--- @param frame integer?  Index of frame (default 1)
+--- @return sprite Sprite userdata if found, nil otherwise.
+function assets.get_sprite(filename, frame) end
+
 --- Get sound for given filename
 --- @param filename string  Name of sound asset to look for
 --- @return sound Sound userdata if found, nil otherwise.
@@ -41,6 +41,28 @@ function draw.textured_line(x0, y0, u0, v0, x1, y1, u1, v1, texture) end
 --- @param color integer  Line color
 function draw.bezier(x0, y0, x1, y1, x2, y2, x3, y3, color) end
 
+--- Draw a quadratic bezier curve with the given anchor and control points, and color.
+--- @param x0 integer  Start anchor point x-coordinate
+--- @param y0 integer  Start anchor point y-coordinate
+--- @param x1 integer  Control point x-coordinate
+--- @param y1 integer  Control point y-coordinate
+--- @param x2 integer  End anchor point x-coordinate
+--- @param y2 integer  End anchor point y-coordinate
+--- @param color integer  Line color
+function draw.quadratic_bezier(x0, y0, x1, y1, x2, y2, color) end
+
+--- Draw list of bezier curves. Curves starting where the previous one ended
+--- are drawn as one continuous line.
+--- @param points number[]|floatarray  Interleaved x, y coordinates, four anchor and control points per curve
+--- @param color integer  Line color
+function draw.beziers(points, color) end
+
+--- Draw list of quadratic bezier curves. Curves starting where the previous
+--- one ended are drawn as one continuous line.
+--- @param points number[]|floatarray  Interleaved x, y coordinates, three anchor and control points per curve
+--- @param color integer  Line color
+function draw.quadratic_beziers(points, color) end
+
 --- Draw rectangle.
 --- @param x integer  Rect top left x-coordinate
 --- @param y integer  Rect top left y-coordinate
@@ -57,6 +79,31 @@ function draw.rectangle(x, y, width, height, color) end
 --- @param color integer  Fill color
 function draw.filled_rectangle(x, y, width, height, color) end
 
+--- Draw rectangle with rounded corners.
+--- @param x integer  Rect top left x-coordinate
+--- @param y integer  Rect top left y-coordinate
+--- @param width integer  Rect width
+--- @param height integer  Rect height
+--- @param radius integer  Corner radius, limited to what fits in the rectangle
+--- @param color integer  Line color
+function draw.rounded_rectangle(x, y, width, height, radius, color) end
+
+--- Draw filled rectangle with rounded corners.
+--- @param x integer  Rect top left x-coordinate
+--- @param y integer  Rect top left y-coordinate
+--- @param width integer  Rect width
+--- @param height integer  Rect height
+--- @param radius integer  Corner radius, limited to what fits in the rectangle
+--- @param color integer  Fill color
+function draw.filled_rounded_rectangle(x, y, width, height, radius, color) end
+
+--- Fill region of pixels sharing the color at given position and connected
+--- to it horizontally or vertically. The region ends at the clipping rectangle.
+--- @param x integer  Start x-coordinate
+--- @param y integer  Start y-coordinate
+--- @param color integer  Fill color
+function draw.flood_fill(x, y, color) end
+
 --- Draw circle
 --- @param x integer  Circle center x-coordinate
 --- @param y integer  Circle center y-coordinate
@@ -71,6 +118,41 @@ function draw.circle(x, y, radius, color) end
 --- @param color integer  Fill color
 function draw.filled_circle(x, y, radius, color) end
 
+--- Draw ellipse.
+--- @param x integer  Ellipse center x-coordinate
+--- @param y integer  Ellipse center y-coordinate
+--- @param radius_x integer  Ellipse radius along the x-axis
+--- @param radius_y integer  Ellipse radius along the y-axis
+--- @param color integer  Line color
+function draw.ellipse(x, y, radius_x, radius_y, color) end
+
+--- Draw filled ellipse.
+--- @param x integer  Ellipse center x-coordinate
+--- @param y integer  Ellipse center y-coordinate
+--- @param radius_x integer  Ellipse radius along the x-axis
+--- @param radius_y integer  Ellipse radius along the y-axis
+--- @param color integer  Fill color
+function draw.filled_ellipse(x, y, radius_x, radius_y, color) end
+
+--- Draw arc of a circle. Angles go clockwise from the positive x-axis, and arcs
+--- spanning a full turn or more draw the whole circle.
+--- @param x integer  Arc center x-coordinate
+--- @param y integer  Arc center y-coordinate
+--- @param radius integer  Arc radius
+--- @param start_angle number  Start angle in radians
+--- @param end_angle number  End angle in radians
+--- @param color integer  Line color
+function draw.arc(x, y, radius, start_angle, end_angle, color) end
+
+--- Draw arc filled to its center, like a slice of pie. Same angles as draw.arc.
+--- @param x integer  Arc center x-coordinate
+--- @param y integer  Arc center y-coordinate
+--- @param radius integer  Arc radius
+--- @param start_angle number  Start angle in radians
+--- @param end_angle number  End angle in radians
+--- @param color integer  Fill color
+function draw.filled_arc(x, y, radius, start_angle, end_angle, color) end
+
 --- Clear screen to given color.
 --- @param color integer  Color to clear screen
 function draw.clear(color) end
@@ -163,10 +245,34 @@ function draw.filled_quad(x0, y0, x1, y1, x2, y2, x3, y3, color) end
 --- @param texture texture  Texture to map onto quad
 function draw.textured_quad(x0, y0, u0, v0, x1, y1, u1, v1, x2, y2, u2, v2, x3, y3, u3, v3, texture) end
 
+--- Draw open line through given points. Shared joints are drawn once.
+--- @param points number[]|floatarray  Interleaved x, y coordinates
+--- @param color integer  Line color
+function draw.polyline(points, color) end
+
+--- Draw closed polygon outline.
+--- @param points number[]|floatarray  Interleaved x, y vertex coordinates
+--- @param color integer  Line color
+function draw.polygon(points, color) end
+
+--- Draw filled polygon. Polygons can be concave and self-intersecting.
+--- @param points number[]|floatarray  Interleaved x, y vertex coordinates
+--- @param color integer  Fill color
+--- @param rule string?  Fill rule, "evenodd" or "nonzero" (default "evenodd")
+function draw.filled_polygon(points, color, rule) end
+
+--- Draw filled polygon using affine texture mapping. The mapping is the
+--- affine transform that best fits the vertices' texture coordinates.
+--- @param vertices number[]|floatarray  Interleaved x, y, u, v vertex values
+--- @param texture texture  Texture to map onto polygon
+--- @param rule string?  Fill rule, "evenodd" or "nonzero" (default "evenodd")
+function draw.textured_polygon(vertices, texture, rule) end
+
 --- Draw texture with affine transformation.
 --- @param texture texture  Texture to draw
 --- @param matrix matrix3  Affine transformation to use when drawing
-function draw.texture(texture, matrix) end
+--- @param wrap string?  How texels outside the texture are sampled. "border" draws only the texture, "clamp" repeats its edges and "repeat" tiles it. Clamp and repeat fill the clipping rectangle. (default "border")
+function draw.texture(texture, matrix, wrap) end
 
 --- Draw texture.
 --- @param texture texture  Texture to draw
@@ -176,6 +282,14 @@ function draw.texture(texture, matrix) end
 --- @param height integer?  Texture height
 function draw.texture(texture, x, y, width, height) end
 
+--- Draw compiled sprite.
+--- @param sprite sprite  Sprite to draw
+--- @param x integer  Sprite x-coordinate
+--- @param y integer  Sprite y-coordinate
+--- @param flip_x boolean?  Mirror sprite horizontally (default false)
+--- @param flip_y boolean?  Mirror sprite vertically (default false)
+function draw.sprite(sprite, x, y, flip_x, flip_y) end
+
 --- Set color for draw palette.
 --- @param index integer  Palette index to change.
 --- @param color integer  New color to set.
@@ -185,6 +299,17 @@ function draw.set_palette_color(index, color) end
 --- @param color integer  Color set set as transparent.
 function draw.set_transparent_color(color) end
 
+--- Sets how drawn pixels combine with the pixels already drawn. Colors are blended in RGB using the global palette and matched to the nearest palette color through a lookup table. Tables follow palette changes. Text is not blended and transparent pixels are still skipped.
+--- @param mode string|blend_table?  "translucent" for 50% translucency, "add", "multiply" or a table from draw.new_blend_table. Nil to stop blending.
+function draw.set_blend_mode(mode) end
+
+--- @class blend_table
+
+--- Creates a blend table for a custom operation. The function is called for every pair of global palette colors, so the table is built for the palette at the time of the call and does not follow later palette changes.
+--- @param func fun(r0: integer, g0: integer, b0: integer, r1: integer, g1: integer, b1: integer): integer, integer, integer  Called with source r, g, b and destination r, g, b values in [0, 255], returns blended r, g, b values
+--- @return blend_table
+function draw.new_blend_table(func) end
+
 --- Sets clipping rectangle which defines drawable area.
 --- @param x integer  Rect top left x-coordinate
 --- @param y integer  Rect top left y-coordinate
@@ -200,4 +325,159 @@ function draw.get_render_texture() end
 --- @param texture texture?  Texture to set as render texture. Calling with no param will reset drawing back to graphics render texture.
 function draw.set_render_texture(texture) end
 
+--- Set number of worker threads used to draw submitted batches. The result is the same as drawing on a single thread.
+--- @param count integer  Number of worker threads. Less than 2 draws batches on the calling thread.
+function draw.set_thread_count(count) end
+
+--- @class Batch
+draw.Batch = {}
+
+--- Creates an empty draw batch. Draw calls recorded into a batch run in a single call to Batch:submit and can be submitted again every frame without being recorded again.
+--- @return Batch
+function draw.Batch.new() end
+
+--- Removes all recorded commands.
+function draw.Batch:reset() end
+
+--- Executes all recorded commands in order, starting on the current render texture. Palette, transparency, blend mode, clipping and render texture changes recorded in the batch remain in effect afterwards. Drawing is split across worker threads if enabled with draw.set_thread_count.
+function draw.Batch:submit() end
+
+--- Record pixel. Same arguments as draw.pixel.
+function draw.Batch:pixel(x, y, color) end
+
+--- Record line. Same arguments as draw.line.
+function draw.Batch:line(x0, y0, x1, y1, color) end
+
+--- Record textured line. Same arguments as draw.textured_line.
+function draw.Batch:textured_line(x0, y0, u0, v0, x1, y1, u1, v1, texture) end
+
+--- Record bezier curve. Same arguments as draw.bezier.
+function draw.Batch:bezier(x0, y0, x1, y1, x2, y2, x3, y3, color) end
+
+--- Record quadratic bezier curve. Same arguments as draw.quadratic_bezier.
+function draw.Batch:quadratic_bezier(x0, y0, x1, y1, x2, y2, color) end
+
+--- Record list of bezier curves. Same arguments as draw.beziers.
+function draw.Batch:beziers(points, color) end
+
+--- Record list of quadratic bezier curves. Same arguments as draw.quadratic_beziers.
+function draw.Batch:quadratic_beziers(points, color) end
+
+--- Record rectangle. Same arguments as draw.rectangle.
+function draw.Batch:rectangle(x, y, width, height, color) end
+
+--- Record filled rectangle. Same arguments as draw.filled_rectangle.
+function draw.Batch:filled_rectangle(x, y, width, height, color) end
+
+--- Record rounded rectangle. Same arguments as draw.rounded_rectangle.
+function draw.Batch:rounded_rectangle(x, y, width, height, radius, color) end
+
+--- Record filled rounded rectangle. Same arguments as draw.filled_rounded_rectangle.
+function draw.Batch:filled_rounded_rectangle(x, y, width, height, radius, color) end
+
+--- Record flood fill. Same arguments as draw.flood_fill.
+function draw.Batch:flood_fill(x, y, color) end
+
+--- Record circle. Same arguments as draw.circle.
+function draw.Batch:circle(x, y, radius, color) end
+
+--- Record filled circle. Same arguments as draw.filled_circle.
+function draw.Batch:filled_circle(x, y, radius, color) end
+
+--- Record ellipse. Same arguments as draw.ellipse.
+function draw.Batch:ellipse(x, y, radius_x, radius_y, color) end
+
+--- Record filled ellipse. Same arguments as draw.filled_ellipse.
+function draw.Batch:filled_ellipse(x, y, radius_x, radius_y, color) end
+
+--- Record arc. Same arguments as draw.arc.
+function draw.Batch:arc(x, y, radius, start_angle, end_angle, color) end
+
+--- Record filled arc. Same arguments as draw.filled_arc.
+function draw.Batch:filled_arc(x, y, radius, start_angle, end_angle, color) end
+
+--- Record clear. Same arguments as draw.clear.
+function draw.Batch:clear(color) end
+
+--- Record text. Same arguments as draw.text.
+function draw.Batch:text(message, x, y, foreground, background) end
+
+--- Record triangle. Same arguments as draw.triangle.
+function draw.Batch:triangle(x0, y0, x1, y1, x2, y2, color) end
+
+--- Record filled triangle. Same arguments as draw.filled_triangle.
+function draw.Batch:filled_triangle(x0, y0, x1, y1, x2, y2, color) end
+
+--- Record textured triangle. Same arguments as draw.textured_triangle.
+function draw.Batch:textured_triangle(x0, y0, u0, v0, x1, y1, u1, v1, x2, y2, u2, v2, texture) end
+
+--- Record quad. Same arguments as draw.quad.
+function draw.Batch:quad(x0, y0, x1, y1, x2, y2, x3, y3, color) end
+
+--- Record filled quad. Same arguments as draw.filled_quad.
+function draw.Batch:filled_quad(x0, y0, x1, y1, x2, y2, x3, y3, color) end
+
+--- Record textured quad. Same arguments as draw.textured_quad.
+function draw.Batch:textured_quad(x0, y0, u0, v0, x1, y1, u1, v1, x2, y2, u2, v2, x3, y3, u3, v3, texture) end
+
+--- Record polyline. Same arguments as draw.polyline.
+function draw.Batch:polyline(points, color) end
+
+--- Record polygon. Same arguments as draw.polygon.
+function draw.Batch:polygon(points, color) end
+
+--- Record filled polygon. Same arguments as draw.filled_polygon.
+function draw.Batch:filled_polygon(points, color, rule) end
+
+--- Record textured polygon. Same arguments as draw.textured_polygon.
+function draw.Batch:textured_polygon(vertices, texture, rule) end
+
+--- Record texture. Same arguments as draw.texture.
+function draw.Batch:texture(texture, x, y, width, height) end
+
+--- Record sprite. Same arguments as draw.sprite.
+function draw.Batch:sprite(sprite, x, y, flip_x, flip_y) end
+
+--- Record palette color change. Same arguments as draw.set_palette_color.
+function draw.Batch:set_palette_color(index, color) end
+
+--- Record transparent color change. Same arguments as draw.set_transparent_color.
+function draw.Batch:set_transparent_color(color) end
+
+--- Record blend mode change. Same arguments as draw.set_blend_mode.
+function draw.Batch:set_blend_mode(mode) end
+
+--- Record clipping rectangle change. Same arguments as draw.set_clipping_rectangle.
+function draw.Batch:set_clipping_rectangle(x, y, width, height) end
+
+--- Record render texture change. Same arguments as draw.set_render_texture.
+function draw.Batch:set_render_texture(texture) end
+
+--- @class SpriteBatch
+draw.SpriteBatch = {}
+
+--- Creates an empty sprite batch. Sprites added to a batch are drawn in a single call to SpriteBatch:submit, sorted by depth.
+--- @return SpriteBatch
+function draw.SpriteBatch.new() end
+
+--- Adds a sprite. Sprites of equal depth are drawn in the order they were added.
+--- @param texture texture  Texture to draw from
+--- @param x integer  Sprite x-coordinate
+--- @param y integer  Sprite y-coordinate
+--- @param depth integer?  Sprites with greater depth are drawn on top (default 0)
+--- @param flip_x boolean?  Mirror sprite horizontally (default false)
+--- @param flip_y boolean?  Mirror sprite vertically (default false)
+--- @param palette_offset integer?  Added to sprite colors before the draw palette remaps them. The transparent color is left as is. (default 0)
+--- @param source_x integer?  Source region x-coordinate (default 0)
+--- @param source_y integer?  Source region y-coordinate (default 0)
+--- @param source_width integer?  Source region width (default texture width)
+--- @param source_height integer?  Source region height (default texture height)
+function draw.SpriteBatch:add(texture, x, y, depth, flip_x, flip_y, palette_offset, source_x, source_y, source_width, source_height) end
+
+--- Removes all sprites.
+function draw.SpriteBatch:reset() end
+
+--- Draws all sprites to the current render texture in depth order, using the current palette, transparency, blend mode and clipping rectangle.
+function draw.SpriteBatch:submit() end
+
 return draw
\ No newline at end of file
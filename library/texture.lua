@@ -9,6 +9,31 @@ local texture = {}
 --- @return texture
 function texture.new(width, height) end
 
+--- Create new 8x8 texture from a 1bpp bitmask. Useful as a dither pattern.
+--- @param bits integer  Bitmask rows. The first row is the most significant byte and the leftmost pixel of a row is its most significant bit.
+--- @param foreground integer  Color for set bits
+--- @param background integer  Color for clear bits
+--- @return texture
+function texture.new_bitmask(bits, foreground, background) end
+
+--- Get a texture for temporary use, such as an off-screen render target. Unlike new, the pixels are not cleared, so the texture must be cleared or drawn over entirely before use. Textures of the same size freed earlier are reused.
+--- @param width integer  Texture width
+--- @param height integer  Texture height
+--- @return texture
+function texture.acquire(width, height) end
+
+--- Mark a texture as no longer used. Using it afterwards raises an error. Batches, sprite batches, the render texture and subtextures may still draw with it, so its memory returns to the texture pool only once it's garbage collected.
+--- @param texture texture  Texture to release
+function texture.release(texture) end
+
+--- Get texture pool statistics. Hits and misses count every texture allocation since start.
+--- @return {hits: integer, misses: integer, count: integer, size: integer, capacity: integer} Table with fields hits, misses, count (textures held by the pool), size and capacity (in bytes)
+function texture.get_pool_stats() end
+
+--- Set number of bytes the texture pool may hold. Pooled textures over the new capacity are freed.
+--- @param capacity integer  Capacity in bytes, 0 to disable pooling
+function texture.set_pool_capacity(capacity) end
+
 --- @class texture
 --- @field pixels integer[]
 --- @field width integer
@@ -70,4 +95,39 @@ function texture.texture:blit(source, x, y, w, h) end
 --- @param dh integer  Destination height
 function texture.texture:blit(source, sx, sy, sw, sh, dx, dy, dw, dh) end
 
+--- Compile this texture into a sprite. Pixels matching the transparent color are dropped and the rest are stored as runs, so drawing the sprite skips transparent areas entirely. Later changes to this texture do not affect the sprite.
+--- @param transparent integer?  Color to drop (default current transparent color)
+--- @return sprite
+function texture.texture:compile(transparent) end
+
+--- Build mip chain for this texture, replacing any existing one. The raycaster and mode7 renderers sample distant surfaces from smaller levels of the chain, which reads less memory and shimmers less. Each level is half the size of the one before. Levels are not updated when the texture changes, so the chain must be rebuilt after.
+--- @param filter string?  "majority" picks the most common color of each 2x2 block, "nearest" the color nearest to the block's average color in the current palette (default "majority")
+function texture.texture:build_mipmaps(filter) end
+
+--- Free mip chain of this texture.
+function texture.texture:remove_mipmaps() end
+
+--- Take a read-only snapshot of this texture. Snapshots are stored in tiles, and tiles with the same pixels as the previous snapshot are shared with it, so a series of snapshots of a texture only stores what changed in between. Cheaper than copy for recording frames or undo history.
+--- @param previous snapshot?  Snapshot to share tiles with, usually the last one taken of this texture
+--- @return snapshot
+function texture.texture:snapshot(previous) end
+
+--- @class sprite
+--- @field width integer
+--- @field height integer
+texture.sprite = {}
+
+--- @class snapshot
+--- @field width integer
+--- @field height integer
+texture.snapshot = {}
+
+--- Returns a new texture with the pixels of this snapshot.
+--- @return texture
+function texture.snapshot:to_texture() end
+
+--- Copy pixels of this snapshot back to a texture of the same size.
+--- @param texture texture  Texture to copy to
+function texture.snapshot:restore(texture) end
+
 return texture
\ No newline at end of file
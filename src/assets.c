@@ -18,6 +18,10 @@ const int default_texture_asset_count = 1;
 
 static const int GIF_DELAY_50_FPS = 2;
 
+// Transparent color sprites are compiled with. Same as the default draw
+// transparent color.
+static const color_t SPRITE_TRANSPARENT_COLOR = 0;
+
 typedef struct {
     const char* name;
     void* asset;
@@ -41,12 +45,14 @@ static asset_entry_t assets_entry_new(const char* name, void* asset) {
 typedef struct {
     int frame_count;
     texture_t** frames;
+    sprite_t** sprites;
 } texture_asset_t;
 
 static texture_asset_t* texture_asset_new(int frame_count);
 static void texture_asset_free(texture_asset_t* asset);
 static size_t texture_asset_sizeof(texture_asset_t* asset);
 static texture_t* texture_asset_frame_get(texture_asset_t* asset, int index);
+static sprite_t* texture_asset_sprite_get(texture_asset_t* asset, int index);
 
 static asset_entry_t* texture_assets = NULL;
 static int texture_asset_count = 0;
@@ -614,6 +620,11 @@ texture_t* assets_texture_get(const char* filename, int frame) {
     return texture_asset_frame_get(asset, frame);
 }
 
+sprite_t* assets_sprite_get(const char* filename, int frame) {
+    texture_asset_t* asset = (texture_asset_t*)asset_get(texture_assets, texture_asset_count, filename);
+    return texture_asset_sprite_get(asset, frame);
+}
+
 const char* assets_script_get(const char* filename) {
     return(const char*)asset_get(script_assets, script_asset_count, filename);
 }
@@ -784,9 +795,11 @@ static texture_asset_t* texture_asset_new(int frame_count) {
 
     asset->frame_count = frame_count;
     asset->frames = (texture_t**)malloc(sizeof(texture_t*) * frame_count);
+    asset->sprites = (sprite_t**)malloc(sizeof(sprite_t*) * frame_count);
 
     for (size_t i=0; i < frame_count; i++) {
         asset->frames[i] = NULL;
+        asset->sprites[i] = NULL;
     }
 
     return asset;
@@ -800,11 +813,18 @@ static texture_asset_t* texture_asset_new(int frame_count) {
 static void texture_asset_free(texture_asset_t* asset) {
     for (size_t i=0; i < asset->frame_count; i++) {
         graphics_texture_free(asset->frames[i]);
+
+        if (asset->sprites[i]) {
+            graphics_sprite_free(asset->sprites[i]);
+        }
     }
 
     free(asset->frames);
     asset->frames = NULL;
 
+    free(asset->sprites);
+    asset->sprites = NULL;
+
     free(asset);
     asset = NULL;
 }
@@ -821,6 +841,10 @@ static size_t texture_asset_sizeof(texture_asset_t* asset) {
     for (size_t i = 0; i < asset->frame_count; i++) {
         texture_t* frame = asset->frames[i];
         size += graphics_texture_sizeof(frame);
+
+        if (asset->sprites[i]) {
+            size += graphics_sprite_sizeof(asset->sprites[i]);
+        }
     }
 
     return size;
@@ -841,6 +865,25 @@ static texture_t* texture_asset_frame_get(texture_asset_t* asset, int index) {
     return asset->frames[index];
 }
 
+/**
+ * Get sprite from given texture asset and frame. Sprites are compiled from
+ * the frame texture the first time they are requested.
+ *
+ * @param texture_asset_t
+ * @param int
+ * @return Sprite for given asset and frame is successful. NULL otherwise.
+ */
+static sprite_t* texture_asset_sprite_get(texture_asset_t* asset, int index) {
+    texture_t* frame = texture_asset_frame_get(asset, index);
+    if (!frame) return NULL;
+
+    if (!asset->sprites[index]) {
+        asset->sprites[index] = graphics_sprite_new(frame, SPRITE_TRANSPARENT_COLOR);
+    }
+
+    return asset->sprites[index];
+}
+
 /**
  * Load a GIF from a buffer of bytes.
  *
@@ -902,6 +945,26 @@ static void gif_free(gif_t* gif) {
     gif = NULL;
 }
 
+/**
+ * Copy texture pixels into a new buffer with rows packed width pixels apart.
+ *
+ * @param texture Texture to copy
+ * @return New buffer if successful, NULL otherwise
+ */
+static GifByteType* gif_raster_new(texture_t* texture) {
+    int width = graphics_texture_width_get(texture);
+    int height = graphics_texture_height_get(texture);
+
+    GifByteType* raster = malloc(sizeof(color_t) * width * height);
+    if (!raster) return NULL;
+
+    for (int y = 0; y < height; y++) {
+        memcpy(raster + y * width, texture->pixels + y * texture->stride, width * sizeof(color_t));
+    }
+
+    return raster;
+}
+
 void assets_gif_save(const char* filename, int frame_count, texture_t** frames) {
     int error;
     GifFileType* gif_file = EGifOpenFileName(filename, false, &error);
@@ -941,9 +1004,7 @@ void assets_gif_save(const char* filename, int frame_count, texture_t** frames)
     saved_image.ImageDesc.Interlace = false;
     saved_image.ImageDesc.ColorMap = NULL;
 
-    size_t size = sizeof(color_t) * graphics_texture_width_get(texture) * graphics_texture_height_get(texture);
-    saved_image.RasterBits = malloc(size);
-    memcpy(saved_image.RasterBits, graphics_texture_pixels_get(texture), size);
+    saved_image.RasterBits = gif_raster_new(texture);
 
     int extension_block_count = 0;
     ExtensionBlock* extension_blocks = NULL;
@@ -1012,9 +1073,7 @@ void assets_gif_save(const char* filename, int frame_count, texture_t** frames)
         saved_image.ImageDesc.Interlace = false;
         saved_image.ImageDesc.ColorMap = NULL;
 
-        size_t size = sizeof(color_t) * graphics_texture_width_get(texture) * graphics_texture_height_get(texture);
-        saved_image.RasterBits = malloc(size);
-        memcpy(saved_image.RasterBits, graphics_texture_pixels_get(texture), size);
+        saved_image.RasterBits = gif_raster_new(texture);
 
         // Graphics control block
         GraphicsControlBlock gcb;
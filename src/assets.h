@@ -36,6 +36,16 @@ void assets_reload(void);
  */
 texture_t* assets_texture_get(const char* filename, int frame_count);
 
+/**
+ * Get sprite compiled from texture for given filename. Sprites are compiled
+ * on first use with color 0 as the transparent color.
+ *
+ * @param filename Name to search for.
+ * @param frame Index of frame.
+ * @return sprite_t* sprite if found, NULL otherwise
+ */
+sprite_t* assets_sprite_get(const char* filename, int frame);
+
 /**
  * Get script for given filename.
  *
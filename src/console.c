@@ -420,6 +420,7 @@ void console_draw(void) {
     );
 
     graphics_draw_clipping_rectangle_set(&console_rect);
+    graphics_dirty_rectangle_add(render_texture, &console_rect);
 
     int line = 0;
     const int max_lines = (console_rect.height / 8) - 1;
@@ -2,14 +2,26 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "assets.h"
 #include "configuration.h"
 #include "event.h"
 #include "graphics.h"
+#include "graphics/blit.h"
 #include "log.h"
 
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
 static texture_t* render_texture = NULL;
 static uint32_t palette[256];
 
+// Changed whenever the palette is, so palette derived tables know when to
+// rebuild
+static uint32_t palette_version = 1;
+
+// Region of render texture changed since last present. Empty if width is 0.
+static rect_t dirty_rect = {0, 0, 0, 0};
+
 void graphics_init(void) {
     log_info("graphics init");
 
@@ -23,16 +35,41 @@ void graphics_init(void) {
         log_fatal("Failed to create frame buffer");
     }
 
+    texture_t* font = assets_texture_get("font.gif", 0);
+
+    if (!font) {
+        log_fatal("Missing font.gif asset");
+    }
+
+    graphics_draw_font_set(font);
     graphics_draw_palette_reset();
     graphics_draw_clipping_rectangle_set(NULL);
+    graphics_dirty_rectangle_add(render_texture, NULL);
 }
 
 void graphics_destroy(void) {
+    graphics_blend_destroy();
     graphics_texture_free(render_texture);
+    graphics_texture_pool_clear();
 }
 
 void graphics_reload(void) {
     graphics_draw_palette_reset();
+
+    // Tables made by scripts are freed with the script state
+    graphics_draw_blend_table_set(NULL);
+
+    // Assets were reloaded, so glyph masks are rebuilt from the new font
+    texture_t* font = assets_texture_get("font.gif", 0);
+
+    if (!font) {
+        log_fatal("Missing font.gif asset");
+    }
+
+    graphics_draw_font_set(font);
+
+    // Platforms may have recreated their frame buffers
+    graphics_dirty_rectangle_add(render_texture, NULL);
 }
 
 texture_t* graphics_render_texture_get(void) {
@@ -45,20 +82,101 @@ uint32_t* graphics_palette_get(void) {
 
 void graphics_palette_set(uint32_t* new_palette) {
     memmove(palette, new_palette, sizeof(palette));
+    palette_version++;
+
+    // Every pixel may change color
+    graphics_dirty_rectangle_add(render_texture, NULL);
+}
+
+void graphics_palette_color_set(int index, uint32_t color) {
+    palette[index & 0xFF] = color;
+    palette_version++;
+
+    graphics_dirty_rectangle_add(render_texture, NULL);
 }
 
 void graphics_palette_clear(void) {
     memset(palette, 0, sizeof(palette));
+    palette_version++;
+
+    graphics_dirty_rectangle_add(render_texture, NULL);
 }
 
-void graphics_pixel_set(int x, int y, color_t color) {
-    graphics_texture_pixel_set(render_texture, x, y, color);
+uint32_t graphics_palette_version_get(void) {
+    return palette_version;
+}
+
+void graphics_dirty_rectangle_add(texture_t* texture, rect_t* rect) {
+    if (!graphics_texture_overlaps(texture, render_texture)) return;
+
+    rect_t whole = {0, 0, texture->width, texture->height};
+    if (!rect) {
+        rect = &whole;
+    }
+
+    int64_t left = rect->x;
+    int64_t top = rect->y;
+    int64_t right = (int64_t)rect->x + rect->width;
+    int64_t bottom = (int64_t)rect->y + rect->height;
+
+    // Subtextures share the render texture's stride, so their offset gives
+    // their position. Anything else marks the whole render texture.
+    ptrdiff_t offset = texture->pixels - render_texture->pixels;
+
+    if (texture->stride == render_texture->stride && offset >= 0) {
+        int x = offset % render_texture->stride;
+        int y = offset / render_texture->stride;
+
+        left = MAX(left, 0) + x;
+        top = MAX(top, 0) + y;
+        right = MIN(right, texture->width) + x;
+        bottom = MIN(bottom, texture->height) + y;
+    }
+    else {
+        left = 0;
+        top = 0;
+        right = render_texture->width;
+        bottom = render_texture->height;
+    }
+
+    left = MAX(left, 0);
+    top = MAX(top, 0);
+    right = MIN(right, render_texture->width);
+    bottom = MIN(bottom, render_texture->height);
+
+    if (left >= right || top >= bottom) return;
+
+    // Merge with existing region
+    if (dirty_rect.width > 0) {
+        left = MIN(left, dirty_rect.x);
+        top = MIN(top, dirty_rect.y);
+        right = MAX(right, dirty_rect.x + dirty_rect.width);
+        bottom = MAX(bottom, dirty_rect.y + dirty_rect.height);
+    }
+
+    dirty_rect.x = left;
+    dirty_rect.y = top;
+    dirty_rect.width = right - left;
+    dirty_rect.height = bottom - top;
+}
+
+bool graphics_dirty_rectangle_get(rect_t* rect) {
+    if (dirty_rect.width <= 0) return false;
+
+    *rect = dirty_rect;
+
+    return true;
 }
 
-static void default_blit_func(texture_t* source_texture, texture_t* _, int sx, int sy, int dx, int dy) {
-    color_t pixel = graphics_texture_pixel_get(source_texture, sx, sy);
+void graphics_dirty_rectangle_clear(void) {
+    dirty_rect = (rect_t) {0, 0, 0, 0};
+}
 
-    graphics_pixel_set(dx, dy, pixel);
+void graphics_pixel_set(int x, int y, color_t color) {
+    graphics_texture_pixel_set(render_texture, x, y, color);
+
+    rect_t rect = {x, y, 1, 1};
+    graphics_dirty_rectangle_add(render_texture, &rect);
 }
 
 void graphics_blit(texture_t* source_texture, texture_t* destination_texture, rect_t* source_rect, rect_t* destination_rect, pixel_copy_func_t func) {
@@ -66,10 +184,6 @@ void graphics_blit(texture_t* source_texture, texture_t* destination_texture, re
         destination_texture = render_texture;
     }
 
-    if (!func) {
-        func = default_blit_func;
-    }
-
     rect_t default_source_rect = {
         0,
         0,
@@ -90,6 +204,20 @@ void graphics_blit(texture_t* source_texture, texture_t* destination_texture, re
         destination_rect = &default_destination_rect;
     }
 
+    graphics_dirty_rectangle_add(destination_texture, destination_rect);
+
+    // Plain copies don't need a call per pixel
+    if (!func) {
+        rect_t bounds = default_destination_rect;
+        blit_t blit = {
+            .mode = BLIT_COPY,
+            .transparent = graphics_draw_transparent_color_get()
+        };
+
+        graphics_blit_rect(destination_texture, &bounds, source_texture, source_rect, destination_rect, &blit);
+        return;
+    }
+
     float x_step = source_rect->width / (float)destination_rect->width;
     float y_step = source_rect->height / (float)destination_rect->height;
 
@@ -143,6 +271,9 @@ void graphics_resolution_set(int width, int height) {
         log_fatal("Failed to create frame buffer");
     }
 
+    graphics_dirty_rectangle_clear();
+    graphics_dirty_rectangle_add(render_texture, NULL);
+
     // Post event on successfully changing resolution
     event_t event;
     event.type = EVENT_GRAPHICSRESOLUTIONCHANGED;
@@ -9,7 +9,12 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "graphics/blend.h"
+#include "graphics/commands.h"
 #include "graphics/draw.h"
+#include "graphics/snapshot.h"
+#include "graphics/sprite.h"
+#include "graphics/sprite_batch.h"
 #include "graphics/texture.h"
 #include "graphics/types.h"
 
@@ -48,11 +53,52 @@ uint32_t* graphics_palette_get(void);
  */
 void graphics_palette_set(uint32_t* palette);
 
+/**
+ * Set a single palette color.
+ *
+ * @param index Index of color to set
+ * @param color Color in the palette's format
+ */
+void graphics_palette_color_set(int index, uint32_t color);
+
 /**
  * Reset all palette values.
  */
 void graphics_palette_clear(void);
 
+/**
+ * Get palette version. Changes whenever the palette is set through the
+ * functions above, so tables derived from the palette can tell when they
+ * are stale.
+ *
+ * @return Palette version
+ */
+uint32_t graphics_palette_version_get(void);
+
+/**
+ * Mark region of texture as changed. Only regions that overlap the render
+ * texture are tracked, so anything may be passed. Must be called from the
+ * main thread.
+ *
+ * @param texture Texture that was changed
+ * @param rect Changed region of texture. NULL for entire texture
+ */
+void graphics_dirty_rectangle_add(texture_t* texture, rect_t* rect);
+
+/**
+ * Get region of render texture changed since the dirty rectangle was last
+ * cleared.
+ *
+ * @param rect Changed region
+ * @return true if anything changed, false otherwise
+ */
+bool graphics_dirty_rectangle_get(rect_t* rect);
+
+/**
+ * Mark render texture as unchanged. Called once changes are presented.
+ */
+void graphics_dirty_rectangle_clear(void);
+
 /**
  * Set pixel color.
  *
@@ -75,13 +121,14 @@ typedef void(*pixel_copy_func_t)(
 );
 
 /**
- * Copy pixels from source texture to destination texture.
+ * Copy pixels from source texture to destination texture. Marks the
+ * destination rectangle as dirty.
  *
  * @param source_texture Texture to copy from
  * @param destination_texture Texture to copy to. NULL to copy to the render texture
  * @param source_rect Rect representing area to copy from. NULL to copy from everything
  * @param destination_rect Rect representing area to copy to. NULL to copy to everything
- * @param func Function used to set pixels. NULL to use default pixel copy function
+ * @param func Function used to set pixels. NULL to copy pixels as is, which avoids a call per pixel
  */
 void graphics_blit(
     texture_t* source_texture,
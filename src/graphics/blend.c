@@ -0,0 +1,249 @@
+#include <stdlib.h>
+
+#include "blend.h"
+#include "../graphics.h"
+#include "../log.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+// Number of recently matched colors remembered while building a table.
+// Must be a power of two.
+#define BLEND_MATCH_CACHE_SIZE 4096
+
+static blend_table_t* builtin_tables[BLEND_COUNT];
+
+/**
+ * Get channel of a palette color. Channel 0 is red, 1 green and 2 blue.
+ */
+static inline int channel_get(uint32_t color, int channel) {
+    return (color >> (channel * 8)) & 0xFF;
+}
+
+static uint32_t blend_translucent(uint32_t source, uint32_t destination, void* data) {
+    uint32_t color = 0xFF000000;
+
+    for (int i = 0; i < 3; i++) {
+        int value = (channel_get(source, i) + channel_get(destination, i) + 1) / 2;
+        color |= (uint32_t)value << (i * 8);
+    }
+
+    return color;
+}
+
+static uint32_t blend_add(uint32_t source, uint32_t destination, void* data) {
+    uint32_t color = 0xFF000000;
+
+    for (int i = 0; i < 3; i++) {
+        int value = MIN(channel_get(source, i) + channel_get(destination, i), 255);
+        color |= (uint32_t)value << (i * 8);
+    }
+
+    return color;
+}
+
+static uint32_t blend_multiply(uint32_t source, uint32_t destination, void* data) {
+    uint32_t color = 0xFF000000;
+
+    for (int i = 0; i < 3; i++) {
+        int value = (channel_get(source, i) * channel_get(destination, i) + 127) / 255;
+        color |= (uint32_t)value << (i * 8);
+    }
+
+    return color;
+}
+
+static const blend_func_t builtin_funcs[BLEND_COUNT] = {
+    [BLEND_TRANSLUCENT] = blend_translucent,
+    [BLEND_ADD] = blend_add,
+    [BLEND_MULTIPLY] = blend_multiply
+};
+
+/**
+ * Palette colors sorted by green, so nearest color searches can stop once
+ * the green difference alone is farther than the best match.
+ */
+typedef struct {
+    int colors[256][3];
+    int indices[256];
+} palette_order_t;
+
+static int compare_green(const void* a, const void* b) {
+    const int* x = a;
+    const int* y = b;
+
+    if (x[1] != y[1]) return x[1] - y[1];
+
+    // Lower palette index wins ties, matching a search in palette order
+    return x[3] - y[3];
+}
+
+static void palette_order_init(palette_order_t* order, uint32_t* palette) {
+    int entries[256][4];
+
+    for (int i = 0; i < 256; i++) {
+        entries[i][0] = channel_get(palette[i], 0);
+        entries[i][1] = channel_get(palette[i], 1);
+        entries[i][2] = channel_get(palette[i], 2);
+        entries[i][3] = i;
+    }
+
+    qsort(entries, 256, sizeof(entries[0]), compare_green);
+
+    for (int i = 0; i < 256; i++) {
+        order->colors[i][0] = entries[i][0];
+        order->colors[i][1] = entries[i][1];
+        order->colors[i][2] = entries[i][2];
+        order->indices[i] = entries[i][3];
+    }
+}
+
+/**
+ * Find palette color nearest to given color by squared distance in RGB.
+ * Ties go to the lowest palette index.
+ */
+static color_t nearest_color_get(palette_order_t* order, uint32_t color) {
+    int r = channel_get(color, 0);
+    int g = channel_get(color, 1);
+    int b = channel_get(color, 2);
+
+    // Start from the first color at or above green and walk both ways
+    int low = 0;
+    int high = 256;
+
+    while (low < high) {
+        int middle = (low + high) / 2;
+
+        if (order->colors[middle][1] < g) low = middle + 1;
+        else high = middle;
+    }
+
+    int nearest = 256;
+    int nearest_distance = INT32_MAX;
+
+    int up = low;
+    int down = low - 1;
+
+    while (up < 256 || down >= 0) {
+        if (up < 256) {
+            int* c = order->colors[up];
+            int dg = c[1] - g;
+
+            if (dg * dg > nearest_distance) {
+                up = 256;
+            }
+            else {
+                int dr = c[0] - r;
+                int db = c[2] - b;
+                int distance = dr * dr + dg * dg + db * db;
+
+                if (distance < nearest_distance || (distance == nearest_distance && order->indices[up] < nearest)) {
+                    nearest = order->indices[up];
+                    nearest_distance = distance;
+                }
+
+                up++;
+            }
+        }
+
+        if (down >= 0) {
+            int* c = order->colors[down];
+            int dg = c[1] - g;
+
+            if (dg * dg > nearest_distance) {
+                down = -1;
+            }
+            else {
+                int dr = c[0] - r;
+                int db = c[2] - b;
+                int distance = dr * dr + dg * dg + db * db;
+
+                if (distance < nearest_distance || (distance == nearest_distance && order->indices[down] < nearest)) {
+                    nearest = order->indices[down];
+                    nearest_distance = distance;
+                }
+
+                down--;
+            }
+        }
+    }
+
+    return nearest;
+}
+
+void graphics_blend_table_build(blend_table_t* table, uint32_t* palette, blend_func_t func, void* data) {
+    // Many pairs blend to the same color, so recent matches are remembered
+    // to skip most palette searches
+    uint32_t cached_colors[BLEND_MATCH_CACHE_SIZE];
+    color_t cached_matches[BLEND_MATCH_CACHE_SIZE];
+    bool cached[BLEND_MATCH_CACHE_SIZE] = {false};
+
+    palette_order_t order;
+    palette_order_init(&order, palette);
+
+    for (int source = 0; source < 256; source++) {
+        for (int destination = 0; destination < 256; destination++) {
+            uint32_t color = func(palette[source], palette[destination], data) & 0xFFFFFF;
+            uint32_t slot = (color ^ (color >> 12)) & (BLEND_MATCH_CACHE_SIZE - 1);
+
+            if (!cached[slot] || cached_colors[slot] != color) {
+                cached[slot] = true;
+                cached_colors[slot] = color;
+                cached_matches[slot] = nearest_color_get(&order, color);
+            }
+
+            table->colors[source][destination] = cached_matches[slot];
+        }
+    }
+}
+
+blend_table_t* graphics_blend_table_new(blend_func_t func, void* data) {
+    blend_table_t* table = (blend_table_t*)malloc(sizeof(blend_table_t));
+
+    if (!table) {
+        log_error("Failed to create blend table");
+        return NULL;
+    }
+
+    table->func = func;
+    table->data = data;
+    table->palette_version = graphics_palette_version_get();
+
+    graphics_blend_table_build(table, graphics_palette_get(), func, data);
+
+    return table;
+}
+
+void graphics_blend_table_free(blend_table_t* table) {
+    free(table);
+    table = NULL;
+}
+
+void graphics_blend_table_update(blend_table_t* table) {
+    if (!table->func) return;
+
+    uint32_t version = graphics_palette_version_get();
+    if (table->palette_version == version) return;
+
+    table->palette_version = version;
+    graphics_blend_table_build(table, graphics_palette_get(), table->func, table->data);
+}
+
+blend_table_t* graphics_blend_table_builtin_get(blend_op_t op) {
+    if (op < 0 || op >= BLEND_COUNT) return NULL;
+
+    if (!builtin_tables[op]) {
+        builtin_tables[op] = graphics_blend_table_new(builtin_funcs[op], NULL);
+        return builtin_tables[op];
+    }
+
+    graphics_blend_table_update(builtin_tables[op]);
+
+    return builtin_tables[op];
+}
+
+void graphics_blend_destroy(void) {
+    for (int i = 0; i < BLEND_COUNT; i++) {
+        graphics_blend_table_free(builtin_tables[i]);
+        builtin_tables[i] = NULL;
+    }
+}
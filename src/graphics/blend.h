@@ -0,0 +1,96 @@
+#ifndef GRAPHICS_BLEND_H
+#define GRAPHICS_BLEND_H
+
+#include <stdint.h>
+
+#include "../graphics/types.h"
+
+/**
+ * Builtin color operations. Channels are combined separately.
+ *
+ * BLEND_TRANSLUCENT averages source and destination, for 50% translucency.
+ * BLEND_ADD adds source to destination, saturating at full intensity.
+ * BLEND_MULTIPLY multiplies destination by source.
+ */
+typedef enum {
+    BLEND_TRANSLUCENT,
+    BLEND_ADD,
+    BLEND_MULTIPLY,
+    BLEND_COUNT
+} blend_op_t;
+
+/**
+ * Function combining two palette colors. Colors use the palette's format.
+ *
+ * @param source Color being drawn
+ * @param destination Color already in the destination
+ * @param data User data given when the table was created
+ * @return Combined color
+ */
+typedef uint32_t(*blend_func_t)(uint32_t source, uint32_t destination, void* data);
+
+/**
+ * Lookup table giving the palette color closest to the blend of a source
+ * and a destination color, as colors[source][destination]. Tables remember
+ * the palette they were built for, and tables with a function are rebuilt
+ * by graphics_blend_table_update once the palette changes.
+ */
+typedef struct {
+    blend_func_t func;
+    void* data;
+    uint32_t palette_version;
+    color_t colors[256][256];
+} blend_table_t;
+
+/**
+ * Fill table for given palette. Each blended color is matched to the
+ * nearest palette color by distance in RGB.
+ *
+ * @param table Table to fill
+ * @param palette 256 color array
+ * @param func Function combining colors
+ * @param data User data passed to function
+ */
+void graphics_blend_table_build(blend_table_t* table, uint32_t* palette, blend_func_t func, void* data);
+
+/**
+ * Create table for the current palette using given function.
+ *
+ * @param func Function combining colors
+ * @param data User data passed to function. Must live as long as the table.
+ * @return New table if successful, NULL otherwise
+ */
+blend_table_t* graphics_blend_table_new(blend_func_t func, void* data);
+
+/**
+ * Frees a table.
+ *
+ * @param table Table to free
+ */
+void graphics_blend_table_free(blend_table_t* table);
+
+/**
+ * Rebuild table if the palette changed since it was built. Tables without a
+ * function are left as is. Must be called from the main thread while the
+ * table isn't being drawn with.
+ *
+ * @param table Table to update
+ */
+void graphics_blend_table_update(blend_table_t* table);
+
+/**
+ * Get table for a builtin operation. Tables are built on first use and
+ * cached, and rebuilt on use after the palette changes. Must be called from
+ * the main thread.
+ *
+ * @param op Builtin operation
+ * @return Table for current palette, NULL if it couldn't be created
+ */
+blend_table_t* graphics_blend_table_builtin_get(blend_op_t op);
+
+/**
+ * Free cached builtin tables.
+ */
+void graphics_blend_destroy(void);
+
+#endif
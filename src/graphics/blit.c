@@ -0,0 +1,295 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "blit.h"
+#include "texture.h"
+
+// Kernels are built by inlining the templates below with a constant mode.
+// Force it so compilers don't share one copy that tests the mode per pixel.
+#if defined(__GNUC__)
+#define KERNEL_INLINE static inline __attribute__((always_inline))
+#else
+#define KERNEL_INLINE static inline
+#endif
+
+// Number of destination columns looked up at once by scaled blits
+#define BLIT_COLUMN_CHUNK 256
+
+/**
+ * Get source offset sampled by a destination pixel when scaling source_size
+ * pixels to destination_size pixels. Pixel centers are sampled using integer
+ * math, so the result only depends on the destination offset.
+ *
+ * @param offset Destination pixel offset from start of destination
+ * @param source_size Source size in pixels. Negative to flip.
+ * @param destination_size Destination size in pixels. Must be positive.
+ * @return Source pixel offset from start of source
+ */
+static inline int scaled_sample_get(int offset, int source_size, int destination_size) {
+    int64_t numerator = (2 * (int64_t)offset + 1) * source_size;
+    int64_t denominator = 2 * (int64_t)destination_size;
+    int64_t sample = numerator / denominator;
+
+    // Round towards negative infinity
+    if (numerator % denominator != 0 && numerator < 0) sample--;
+
+    return (int)sample;
+}
+
+/**
+ * Copy a row of pixels, skipping pixels that match the transparent color.
+ * Uses SSE2 or AVX2 when available to handle 16 or 32 pixels at a time.
+ */
+static void row_keyed(color_t* destination, const color_t* source, int count, color_t transparent) {
+    int i = 0;
+
+#if defined(__AVX2__)
+    __m256i key = _mm256_set1_epi8((char)transparent);
+
+    for (; i + 32 <= count; i += 32) {
+        __m256i pixels = _mm256_loadu_si256((const __m256i*)(source + i));
+        __m256i skip = _mm256_cmpeq_epi8(pixels, key);
+        int mask = _mm256_movemask_epi8(skip);
+
+        // Leave fully transparent runs untouched
+        if (mask == -1) continue;
+
+        if (mask != 0) {
+            __m256i background = _mm256_loadu_si256((const __m256i*)(destination + i));
+            pixels = _mm256_blendv_epi8(pixels, background, skip);
+        }
+
+        _mm256_storeu_si256((__m256i*)(destination + i), pixels);
+    }
+#elif defined(__SSE2__)
+    __m128i key = _mm_set1_epi8((char)transparent);
+
+    for (; i + 16 <= count; i += 16) {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(source + i));
+        __m128i skip = _mm_cmpeq_epi8(pixels, key);
+        int mask = _mm_movemask_epi8(skip);
+
+        // Leave fully transparent runs untouched
+        if (mask == 0xFFFF) continue;
+
+        if (mask != 0) {
+            __m128i background = _mm_loadu_si128((const __m128i*)(destination + i));
+            pixels = _mm_or_si128(_mm_and_si128(skip, background), _mm_andnot_si128(skip, pixels));
+        }
+
+        _mm_storeu_si128((__m128i*)(destination + i), pixels);
+    }
+#endif
+
+    for (; i < count; i++) {
+        color_t pixel = source[i];
+        if (pixel == transparent) continue;
+
+        destination[i] = pixel;
+    }
+}
+
+/**
+ * Write a single pixel for given mode. Mode is a constant wherever this is
+ * inlined, so each kernel only keeps its own case.
+ *
+ * @param blit Blit operation
+ * @param mode Blit mode
+ * @param destination Pixel to write
+ * @param depth Depth buffer value for pixel. Only used for depth modes.
+ * @param pixel Source pixel
+ */
+KERNEL_INLINE void blit_pixel(blit_t* blit, blit_mode_t mode, color_t* destination, float* depth, color_t pixel) {
+    switch (mode) {
+        case BLIT_COPY:
+            *destination = pixel;
+            break;
+
+        case BLIT_KEYED:
+            if (pixel != blit->transparent) *destination = pixel;
+            break;
+
+        case BLIT_REMAPPED:
+            pixel = blit->palette[pixel];
+            if (pixel != blit->transparent) *destination = pixel;
+            break;
+
+        case BLIT_DEPTH_SHADED:
+            if (*depth <= blit->depth) break;
+            if (pixel == blit->transparent) break;
+
+            *depth = blit->depth;
+            *destination = blit->palette[pixel];
+            break;
+
+        case BLIT_BLENDED:
+            pixel = blit->palette[pixel];
+            if (pixel != blit->transparent) *destination = blit->blend->colors[pixel][*destination];
+            break;
+    }
+}
+
+/**
+ * Copy a row of pixels with no scaling.
+ */
+KERNEL_INLINE void blit_row_unscaled(blit_t* blit, blit_mode_t mode, color_t* destination, float* depth, const color_t* source, int count) {
+    switch (mode) {
+        case BLIT_COPY:
+            memcpy(destination, source, count);
+            break;
+
+        case BLIT_KEYED:
+            row_keyed(destination, source, count, blit->transparent);
+            break;
+
+        default:
+            for (int i = 0; i < count; i++) {
+                blit_pixel(blit, mode, destination + i, depth ? depth + i : NULL, source[i]);
+            }
+            break;
+    }
+}
+
+/**
+ * Copy source rectangle to destination rectangle of the same size. Rows are
+ * clipped once. The source rectangle must be inside the source texture.
+ */
+KERNEL_INLINE void blit_rect_unscaled(texture_t* destination, rect_t* bounds, texture_t* source, rect_t* source_rect, rect_t* dest_rect, blit_t* blit, blit_mode_t mode) {
+    int x = dest_rect->x;
+    int y = dest_rect->y;
+
+    int left = x > bounds->x ? x : bounds->x;
+    int top = y > bounds->y ? y : bounds->y;
+    int right = x + dest_rect->width;
+    int bottom = y + dest_rect->height;
+
+    if (right > bounds->x + bounds->width) right = bounds->x + bounds->width;
+    if (bottom > bounds->y + bounds->height) bottom = bounds->y + bounds->height;
+    if (left >= right || top >= bottom) return;
+
+    for (int dy = top; dy < bottom; dy++) {
+        color_t* row = destination->pixels + dy * destination->stride + left;
+        color_t* source_row = source->pixels + (source_rect->y + dy - y) * source->stride + source_rect->x + left - x;
+        float* depth_row = blit->depth_buffer ? blit->depth_buffer + dy * blit->depth_stride + left : NULL;
+
+        blit_row_unscaled(blit, mode, row, depth_row, source_row, right - left);
+    }
+}
+
+/**
+ * Copy source rectangle to destination rectangle using given mode. This is
+ * the template every kernel is built from.
+ */
+KERNEL_INLINE void blit_rect(texture_t* destination, rect_t* bounds, texture_t* source, rect_t* source_rect, rect_t* dest_rect, blit_t* blit, blit_mode_t mode) {
+    if (dest_rect->width <= 0 || dest_rect->height <= 0) return;
+
+    // Unscaled copies from inside the source sample every pixel exactly once
+    bool unscaled = source_rect->width == dest_rect->width && source_rect->height == dest_rect->height;
+    bool inside = source_rect->x >= 0 && source_rect->y >= 0 &&
+                  source_rect->x + source_rect->width <= source->width &&
+                  source_rect->y + source_rect->height <= source->height;
+
+    if (unscaled && inside && !graphics_texture_overlaps(destination, source)) {
+        blit_rect_unscaled(destination, bounds, source, source_rect, dest_rect, blit, mode);
+        return;
+    }
+
+    int left = dest_rect->x > bounds->x ? dest_rect->x : bounds->x;
+    int top = dest_rect->y > bounds->y ? dest_rect->y : bounds->y;
+    int right = dest_rect->x + dest_rect->width;
+    int bottom = dest_rect->y + dest_rect->height;
+
+    if (right > bounds->x + bounds->width) right = bounds->x + bounds->width;
+    if (bottom > bounds->y + bounds->height) bottom = bounds->y + bounds->height;
+    if (left >= right || top >= bottom) return;
+
+    int columns[BLIT_COLUMN_CHUNK];
+
+    // Column lookup is built for a chunk of columns at a time, and every row
+    // then gathers from the same source columns
+    for (int chunk = left; chunk < right; chunk += BLIT_COLUMN_CHUNK) {
+        int count = right - chunk < BLIT_COLUMN_CHUNK ? right - chunk : BLIT_COLUMN_CHUNK;
+        bool columns_inside = true;
+
+        for (int i = 0; i < count; i++) {
+            int source_x = source_rect->x + scaled_sample_get(chunk + i - dest_rect->x, source_rect->width, dest_rect->width);
+            columns[i] = source_x;
+
+            if ((unsigned)source_x >= (unsigned)source->width) columns_inside = false;
+        }
+
+        for (int dy = top; dy < bottom; dy++) {
+            color_t* row = destination->pixels + dy * destination->stride + chunk;
+            float* depth_row = blit->depth_buffer ? blit->depth_buffer + dy * blit->depth_stride + chunk : NULL;
+            int source_y = source_rect->y + scaled_sample_get(dy - dest_rect->y, source_rect->height, dest_rect->height);
+
+            // Source rows outside the source read as transparent
+            if ((unsigned)source_y >= (unsigned)source->height) {
+                for (int i = 0; i < count; i++) {
+                    blit_pixel(blit, mode, row + i, depth_row ? depth_row + i : NULL, blit->transparent);
+                }
+
+                continue;
+            }
+
+            const color_t* source_row = source->pixels + source_y * source->stride;
+
+            if (columns_inside) {
+                for (int i = 0; i < count; i++) {
+                    blit_pixel(blit, mode, row + i, depth_row ? depth_row + i : NULL, source_row[columns[i]]);
+                }
+
+                continue;
+            }
+
+            for (int i = 0; i < count; i++) {
+                int source_x = columns[i];
+                color_t pixel = (unsigned)source_x < (unsigned)source->width ? source_row[source_x] : blit->transparent;
+
+                blit_pixel(blit, mode, row + i, depth_row ? depth_row + i : NULL, pixel);
+            }
+        }
+    }
+}
+
+void graphics_blit_rect(texture_t* destination, rect_t* bounds, texture_t* source, rect_t* source_rect, rect_t* destination_rect, blit_t* blit) {
+    rect_t default_source_rect = {0, 0, source->width, source->height};
+    if (!source_rect) {
+        source_rect = &default_source_rect;
+    }
+
+    rect_t default_destination_rect = {0, 0, destination->width, destination->height};
+    if (!destination_rect) {
+        destination_rect = &default_destination_rect;
+    }
+
+    // Select kernel once per blit
+    switch (blit->mode) {
+        case BLIT_COPY:
+            blit_rect(destination, bounds, source, source_rect, destination_rect, blit, BLIT_COPY);
+            break;
+
+        case BLIT_KEYED:
+            blit_rect(destination, bounds, source, source_rect, destination_rect, blit, BLIT_KEYED);
+            break;
+
+        case BLIT_REMAPPED:
+            blit_rect(destination, bounds, source, source_rect, destination_rect, blit, BLIT_REMAPPED);
+            break;
+
+        case BLIT_DEPTH_SHADED:
+            blit_rect(destination, bounds, source, source_rect, destination_rect, blit, BLIT_DEPTH_SHADED);
+            break;
+
+        case BLIT_BLENDED:
+            blit_rect(destination, bounds, source, source_rect, destination_rect, blit, BLIT_BLENDED);
+            break;
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef GRAPHICS_BLIT_H
+#define GRAPHICS_BLIT_H
+
+#include "../graphics/blend.h"
+#include "../graphics/types.h"
+
+/**
+ * How blitted pixels are written to the destination.
+ *
+ * BLIT_COPY copies every pixel as is.
+ * BLIT_KEYED skips pixels that match the transparent color.
+ * BLIT_REMAPPED remaps pixels through the palette, then skips remapped pixels
+ * that match the transparent color.
+ * BLIT_DEPTH_SHADED skips pixels behind the depth buffer or that match the
+ * transparent color. Other pixels are remapped through the palette, which is
+ * usually a shade table row, and write their depth.
+ * BLIT_BLENDED remaps pixels through the palette and skips remapped pixels
+ * that match the transparent color like BLIT_REMAPPED, then combines the
+ * rest with the destination through the blend table.
+ */
+typedef enum {
+    BLIT_COPY,
+    BLIT_KEYED,
+    BLIT_REMAPPED,
+    BLIT_DEPTH_SHADED,
+    BLIT_BLENDED
+} blit_mode_t;
+
+/**
+ * Blit operation. Only the fields used by the mode need to be set.
+ */
+typedef struct {
+    blit_mode_t mode;
+    color_t transparent;
+    const color_t* palette;
+    float* depth_buffer;
+    int depth_stride;
+    float depth;
+    const blend_table_t* blend;
+} blit_t;
+
+/**
+ * Copy source rectangle to destination rectangle. The source is scaled to
+ * fit, sampling pixel centers with integer math so the sampled pixels only
+ * depend on the rectangles and not on clipping. Source pixels outside of
+ * the source texture read as the transparent color. The kernel for the
+ * blit's mode is selected once, and unscaled copies from inside the source
+ * are copied a row at a time, using SSE2 or AVX2 when available.
+ *
+ * @param destination Texture to copy to
+ * @param bounds Region of destination that may be written
+ * @param source Texture to copy from
+ * @param source_rect Region of source to copy. NULL for entire source
+ * @param destination_rect Region of destination to copy to. NULL for entire destination
+ * @param blit Blit operation
+ */
+void graphics_blit_rect(texture_t* destination, rect_t* bounds, texture_t* source, rect_t* source_rect, rect_t* destination_rect, blit_t* blit);
+
+#endif
@@ -0,0 +1,1199 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mathc/mathc.h>
+
+#include "commands.h"
+#include "../graphics.h"
+#include "../log.h"
+
+#define NO_TEXTURE UINT32_MAX
+#define NO_SPRITE UINT32_MAX
+#define NO_BLEND_TABLE UINT32_MAX
+#define NO_COORDINATES UINT32_MAX
+#define TILE_SIZE 64
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+/**
+ * Number and kind of arguments stored for each command.
+ */
+typedef struct {
+    int ints;
+    int floats;
+    bool texture;
+    bool string;
+    bool sprite;
+    bool points;
+    bool coordinates;
+    bool blend_table;
+} command_layout_t;
+
+static texture_t* command_execute(command_t* command, texture_t* destination);
+static void command_dirty_mark(command_t* command, texture_t* target);
+
+static const command_layout_t command_layouts[COMMAND_COUNT] = {
+    [COMMAND_PIXEL] = {3, 0, false, false},
+    [COMMAND_LINE] = {5, 0, false, false},
+    [COMMAND_PATTERN_LINE] = {6, 0, true, false},
+    [COMMAND_TEXTURED_LINE] = {4, 4, true, false},
+    [COMMAND_BEZIER] = {9, 0, false, false},
+    [COMMAND_PATTERN_BEZIER] = {10, 0, true, false},
+    [COMMAND_QUADRATIC_BEZIER] = {7, 0, false, false},
+    [COMMAND_PATTERN_QUADRATIC_BEZIER] = {8, 0, true, false},
+    [COMMAND_BEZIERS] = {1, 0, false, false, false, true, false},
+    [COMMAND_PATTERN_BEZIERS] = {2, 0, true, false, false, true, false},
+    [COMMAND_QUADRATIC_BEZIERS] = {1, 0, false, false, false, true, false},
+    [COMMAND_PATTERN_QUADRATIC_BEZIERS] = {2, 0, true, false, false, true, false},
+    [COMMAND_RECTANGLE] = {5, 0, false, false},
+    [COMMAND_PATTERN_RECTANGLE] = {6, 0, true, false},
+    [COMMAND_FILLED_RECTANGLE] = {5, 0, false, false},
+    [COMMAND_FILLED_PATTERN_RECTANGLE] = {6, 0, true, false},
+    [COMMAND_ROUNDED_RECTANGLE] = {6, 0, false, false},
+    [COMMAND_PATTERN_ROUNDED_RECTANGLE] = {7, 0, true, false},
+    [COMMAND_FILLED_ROUNDED_RECTANGLE] = {6, 0, false, false},
+    [COMMAND_FILLED_PATTERN_ROUNDED_RECTANGLE] = {7, 0, true, false},
+    [COMMAND_FLOOD_FILL] = {3, 0, false, false},
+    [COMMAND_PATTERN_FLOOD_FILL] = {4, 0, true, false},
+    [COMMAND_CIRCLE] = {4, 0, false, false},
+    [COMMAND_PATTERN_CIRCLE] = {5, 0, true, false},
+    [COMMAND_FILLED_CIRCLE] = {4, 0, false, false},
+    [COMMAND_FILLED_PATTERN_CIRCLE] = {5, 0, true, false},
+    [COMMAND_ELLIPSE] = {5, 0, false, false},
+    [COMMAND_PATTERN_ELLIPSE] = {6, 0, true, false},
+    [COMMAND_FILLED_ELLIPSE] = {5, 0, false, false},
+    [COMMAND_FILLED_PATTERN_ELLIPSE] = {6, 0, true, false},
+    [COMMAND_ARC] = {4, 2, false, false},
+    [COMMAND_PATTERN_ARC] = {5, 2, true, false},
+    [COMMAND_FILLED_ARC] = {4, 2, false, false},
+    [COMMAND_FILLED_PATTERN_ARC] = {5, 2, true, false},
+    [COMMAND_TEXT] = {4, 0, false, true},
+    [COMMAND_TRIANGLE] = {7, 0, false, false},
+    [COMMAND_PATTERN_TRIANGLE] = {8, 0, true, false},
+    [COMMAND_FILLED_TRIANGLE] = {7, 0, false, false},
+    [COMMAND_FILLED_PATTERN_TRIANGLE] = {8, 0, true, false},
+    [COMMAND_TEXTURED_TRIANGLE] = {6, 6, true, false},
+    [COMMAND_QUAD] = {9, 0, false, false},
+    [COMMAND_PATTERN_QUAD] = {10, 0, true, false},
+    [COMMAND_FILLED_QUAD] = {9, 0, false, false},
+    [COMMAND_FILLED_PATTERN_QUAD] = {10, 0, true, false},
+    [COMMAND_TEXTURED_QUAD] = {8, 8, true, false},
+    [COMMAND_POLYLINE] = {1, 0, false, false, false, true, false},
+    [COMMAND_PATTERN_POLYLINE] = {2, 0, true, false, false, true, false},
+    [COMMAND_POLYGON] = {1, 0, false, false, false, true, false},
+    [COMMAND_PATTERN_POLYGON] = {2, 0, true, false, false, true, false},
+    [COMMAND_FILLED_POLYGON] = {2, 0, false, false, false, true, false},
+    [COMMAND_FILLED_PATTERN_POLYGON] = {3, 0, true, false, false, true, false},
+    [COMMAND_TEXTURED_POLYGON] = {1, 0, true, false, false, true, true},
+    [COMMAND_TEXTURE] = {4, 0, true, false},
+    [COMMAND_AFFINE_TEXTURE] = {1, 9, true, false},
+    [COMMAND_SPRITE] = {4, 0, false, false, true},
+    [COMMAND_CLEAR] = {1, 0, false, false},
+    [COMMAND_PALETTE_COLOR] = {2, 0, false, false},
+    [COMMAND_TRANSPARENT_COLOR] = {1, 0, false, false},
+    [COMMAND_BLEND_TABLE] = {0, 0, false, false, false, false, false, true},
+    [COMMAND_CLIPPING_RECTANGLE] = {4, 0, false, false},
+    [COMMAND_CLIPPING_RECTANGLE_RESET] = {0, 0, false, false},
+    [COMMAND_RENDER_TEXTURE] = {0, 0, true, false}
+};
+
+command_buffer_t* graphics_command_buffer_new(void) {
+    command_buffer_t* buffer = (command_buffer_t*)calloc(1, sizeof(command_buffer_t));
+
+    if (!buffer) {
+        log_error("Failed to create command buffer");
+        return NULL;
+    }
+
+    return buffer;
+}
+
+void graphics_command_buffer_free(command_buffer_t* buffer) {
+    free(buffer->words);
+    free(buffer->textures);
+    free(buffer->sprites);
+    free(buffer->blend_tables);
+    free(buffer->strings);
+    free(buffer->points);
+    free(buffer->coordinates);
+    free(buffer);
+    buffer = NULL;
+}
+
+void graphics_command_buffer_clear(command_buffer_t* buffer) {
+    buffer->word_count = 0;
+    buffer->texture_count = 0;
+    buffer->sprite_count = 0;
+    buffer->blend_table_count = 0;
+    buffer->string_size = 0;
+    buffer->point_size = 0;
+    buffer->coordinate_size = 0;
+    buffer->count = 0;
+}
+
+/**
+ * Grow array so it can hold at least given number of elements.
+ *
+ * @param array Pointer to array to grow
+ * @param capacity Pointer to current capacity in elements
+ * @param required Number of elements needed
+ * @param element_size Size of one element in bytes
+ * @return true if successful, false otherwise
+ */
+static bool reserve(void** array, size_t* capacity, size_t required, size_t element_size) {
+    if (required <= *capacity) return true;
+
+    size_t new_capacity = *capacity ? *capacity : 64;
+    while (new_capacity < required) {
+        new_capacity *= 2;
+    }
+
+    void* a = realloc(*array, new_capacity * element_size);
+    if (!a) return false;
+
+    *array = a;
+    *capacity = new_capacity;
+
+    return true;
+}
+
+bool graphics_command_buffer_add(command_buffer_t* buffer, command_t* command) {
+    if (command->op < 0 || command->op >= COMMAND_COUNT) {
+        log_error("Invalid draw command");
+        return false;
+    }
+
+    const command_layout_t* layout = &command_layouts[command->op];
+
+    // Op, ints, floats, then texture index, string offset, sprite index,
+    // vertex count with point offset, coordinate offset and blend table index
+    size_t size = 1 + layout->ints + layout->floats + layout->texture + layout->string + layout->sprite + 2 * layout->points + layout->coordinates + layout->blend_table;
+
+    if (!reserve((void**)&buffer->words, &buffer->word_capacity, buffer->word_count + size, sizeof(uint32_t))) {
+        log_error("Failed to add draw command");
+        return false;
+    }
+
+    uint32_t texture_index = NO_TEXTURE;
+    if (layout->texture && command->texture) {
+        if (!reserve((void**)&buffer->textures, &buffer->texture_capacity, buffer->texture_count + 1, sizeof(texture_t*))) {
+            log_error("Failed to add draw command");
+            return false;
+        }
+
+        texture_index = buffer->texture_count;
+        buffer->textures[buffer->texture_count++] = command->texture;
+    }
+
+    uint32_t sprite_index = NO_SPRITE;
+    if (layout->sprite && command->sprite) {
+        if (!reserve((void**)&buffer->sprites, &buffer->sprite_capacity, buffer->sprite_count + 1, sizeof(sprite_t*))) {
+            log_error("Failed to add draw command");
+            return false;
+        }
+
+        sprite_index = buffer->sprite_count;
+        buffer->sprites[buffer->sprite_count++] = command->sprite;
+    }
+
+    uint32_t blend_table_index = NO_BLEND_TABLE;
+    if (layout->blend_table && command->blend_table) {
+        if (!reserve((void**)&buffer->blend_tables, &buffer->blend_table_capacity, buffer->blend_table_count + 1, sizeof(blend_table_t*))) {
+            log_error("Failed to add draw command");
+            return false;
+        }
+
+        blend_table_index = buffer->blend_table_count;
+        buffer->blend_tables[buffer->blend_table_count++] = command->blend_table;
+    }
+
+    uint32_t string_offset = 0;
+    if (layout->string) {
+        const char* string = command->string ? command->string : "";
+        size_t length = strlen(string) + 1;
+
+        if (!reserve((void**)&buffer->strings, &buffer->string_capacity, buffer->string_size + length, sizeof(char))) {
+            log_error("Failed to add draw command");
+            return false;
+        }
+
+        string_offset = buffer->string_size;
+        memcpy(buffer->strings + buffer->string_size, string, length);
+        buffer->string_size += length;
+    }
+
+    int point_count = command->points && command->point_count > 0 ? command->point_count : 0;
+
+    uint32_t point_offset = 0;
+    if (layout->points) {
+        size_t length = point_count * 2;
+
+        if (!reserve((void**)&buffer->points, &buffer->point_capacity, buffer->point_size + length, sizeof(int))) {
+            log_error("Failed to add draw command");
+            return false;
+        }
+
+        point_offset = buffer->point_size;
+        if (length > 0) memcpy(buffer->points + buffer->point_size, command->points, length * sizeof(int));
+        buffer->point_size += length;
+    }
+
+    uint32_t coordinate_offset = 0;
+    if (layout->coordinates) {
+        size_t length = command->coordinates ? point_count * 2 : 0;
+
+        if (!reserve((void**)&buffer->coordinates, &buffer->coordinate_capacity, buffer->coordinate_size + length, sizeof(float))) {
+            log_error("Failed to add draw command");
+            return false;
+        }
+
+        coordinate_offset = command->coordinates ? buffer->coordinate_size : NO_COORDINATES;
+        if (length > 0) memcpy(buffer->coordinates + buffer->coordinate_size, command->coordinates, length * sizeof(float));
+        buffer->coordinate_size += length;
+    }
+
+    uint32_t* words = buffer->words + buffer->word_count;
+    *words++ = command->op;
+
+    for (int i = 0; i < layout->ints; i++) {
+        *words++ = (uint32_t)command->ints[i];
+    }
+
+    for (int i = 0; i < layout->floats; i++) {
+        memcpy(words++, &command->floats[i], sizeof(float));
+    }
+
+    if (layout->texture) *words++ = texture_index;
+    if (layout->string) *words++ = string_offset;
+    if (layout->sprite) *words++ = sprite_index;
+
+    if (layout->points) {
+        *words++ = point_count;
+        *words++ = point_offset;
+    }
+
+    if (layout->coordinates) *words++ = coordinate_offset;
+    if (layout->blend_table) *words++ = blend_table_index;
+
+    buffer->word_count += size;
+    buffer->count++;
+
+    return true;
+}
+
+bool graphics_command_buffer_next(command_buffer_t* buffer, size_t* offset, command_t* command) {
+    if (*offset >= buffer->word_count) return false;
+
+    uint32_t* words = buffer->words + *offset;
+    command->op = (command_op_t)*words++;
+
+    const command_layout_t* layout = &command_layouts[command->op];
+
+    for (int i = 0; i < layout->ints; i++) {
+        command->ints[i] = (int32_t)*words++;
+    }
+
+    for (int i = 0; i < layout->floats; i++) {
+        memcpy(&command->floats[i], words++, sizeof(float));
+    }
+
+    command->texture = NULL;
+    if (layout->texture) {
+        uint32_t index = *words++;
+        command->texture = index == NO_TEXTURE ? NULL : buffer->textures[index];
+    }
+
+    command->string = NULL;
+    if (layout->string) {
+        command->string = buffer->strings + *words++;
+    }
+
+    command->sprite = NULL;
+    if (layout->sprite) {
+        uint32_t index = *words++;
+        command->sprite = index == NO_SPRITE ? NULL : buffer->sprites[index];
+    }
+
+    command->points = NULL;
+    command->point_count = 0;
+    if (layout->points) {
+        command->point_count = *words++;
+        command->points = buffer->points + *words++;
+    }
+
+    command->coordinates = NULL;
+    if (layout->coordinates) {
+        uint32_t coordinate_offset = *words++;
+        command->coordinates = coordinate_offset == NO_COORDINATES ? NULL : buffer->coordinates + coordinate_offset;
+    }
+
+    command->blend_table = NULL;
+    if (layout->blend_table) {
+        uint32_t index = *words++;
+        command->blend_table = index == NO_BLEND_TABLE ? NULL : buffer->blend_tables[index];
+    }
+
+    *offset = words - buffer->words;
+
+    return true;
+}
+
+texture_t* graphics_command_buffer_execute(command_buffer_t* buffer, texture_t* destination) {
+    command_t command;
+    size_t offset = 0;
+
+    while (graphics_command_buffer_next(buffer, &offset, &command)) {
+        destination = graphics_command_execute(&command, destination);
+    }
+
+    return destination;
+}
+
+/**
+ * Draw state at the start of a run of binned commands. Workers start from
+ * it so every tile sees the same state changes in the same order.
+ */
+typedef struct {
+    color_t palette[256];
+    int transparent_color;
+    blend_table_t* blend_table;
+    rect_t clip_rect;
+} draw_state_t;
+
+typedef struct tile_grid tile_grid_t;
+
+/**
+ * Region of the destination drawn by a single worker.
+ */
+typedef struct {
+    tile_grid_t* grid;
+    rect_t rect;
+    size_t* offsets;
+    size_t offset_count;
+    size_t offset_capacity;
+} tile_t;
+
+struct tile_grid {
+    command_buffer_t* buffer;
+    texture_t* target;
+    draw_state_t state;
+    tile_t* tiles;
+    size_t tile_count;
+    size_t tile_capacity;
+    int columns;
+    int rows;
+    bool failed;
+};
+
+/**
+ * Split target into tiles and capture the current draw state.
+ */
+static bool tile_grid_begin(tile_grid_t* grid, texture_t* target) {
+    grid->target = target;
+    grid->columns = (target->width + TILE_SIZE - 1) / TILE_SIZE;
+    grid->rows = (target->height + TILE_SIZE - 1) / TILE_SIZE;
+
+    size_t count = (size_t)grid->columns * grid->rows;
+    size_t old_capacity = grid->tile_capacity;
+
+    if (!reserve((void**)&grid->tiles, &grid->tile_capacity, count, sizeof(tile_t))) {
+        return false;
+    }
+
+    memset(grid->tiles + old_capacity, 0, (grid->tile_capacity - old_capacity) * sizeof(tile_t));
+    grid->tile_count = count;
+
+    for (size_t i = 0; i < count; i++) {
+        tile_t* tile = &grid->tiles[i];
+        int x = i % grid->columns * TILE_SIZE;
+        int y = i / grid->columns * TILE_SIZE;
+
+        tile->grid = grid;
+        tile->rect.x = x;
+        tile->rect.y = y;
+        tile->rect.width = MIN(TILE_SIZE, target->width - x);
+        tile->rect.height = MIN(TILE_SIZE, target->height - y);
+        tile->offset_count = 0;
+    }
+
+    memcpy(grid->state.palette, graphics_draw_palette_get(), sizeof(grid->state.palette));
+    grid->state.transparent_color = graphics_draw_transparent_color_get();
+    grid->state.blend_table = graphics_draw_blend_table_get();
+
+    if (grid->state.blend_table) {
+        graphics_blend_table_update(grid->state.blend_table);
+    }
+    grid->state.clip_rect = *graphics_draw_clipping_rectangle_get();
+
+    return true;
+}
+
+static void tile_grid_free(tile_grid_t* grid) {
+    for (size_t i = 0; i < grid->tile_capacity; i++) {
+        free(grid->tiles[i].offsets);
+    }
+
+    free(grid->tiles);
+}
+
+/**
+ * Get conservative bounds of pixels a command may draw.
+ *
+ * @return true if bounds found, false if command may affect every tile
+ */
+static bool command_bounds_get(command_t* command, texture_t* target, int64_t* bounds) {
+    int* i = command->ints;
+    int64_t points[8];
+    int count = 0;
+
+    // Vertex commands store their points first
+    bool vertices = true;
+
+    switch (command->op) {
+        case COMMAND_PIXEL:
+            count = 1;
+            break;
+
+        case COMMAND_LINE:
+        case COMMAND_PATTERN_LINE:
+        case COMMAND_TEXTURED_LINE:
+            count = 2;
+            break;
+
+        case COMMAND_QUADRATIC_BEZIER:
+        case COMMAND_PATTERN_QUADRATIC_BEZIER:
+        case COMMAND_TRIANGLE:
+        case COMMAND_PATTERN_TRIANGLE:
+        case COMMAND_FILLED_TRIANGLE:
+        case COMMAND_FILLED_PATTERN_TRIANGLE:
+        case COMMAND_TEXTURED_TRIANGLE:
+            count = 3;
+            break;
+
+        case COMMAND_BEZIER:
+        case COMMAND_PATTERN_BEZIER:
+        case COMMAND_QUAD:
+        case COMMAND_PATTERN_QUAD:
+        case COMMAND_FILLED_QUAD:
+        case COMMAND_FILLED_PATTERN_QUAD:
+        case COMMAND_TEXTURED_QUAD:
+            count = 4;
+            break;
+
+        case COMMAND_BEZIERS:
+        case COMMAND_PATTERN_BEZIERS:
+        case COMMAND_QUADRATIC_BEZIERS:
+        case COMMAND_PATTERN_QUADRATIC_BEZIERS:
+        case COMMAND_POLYLINE:
+        case COMMAND_PATTERN_POLYLINE:
+        case COMMAND_POLYGON:
+        case COMMAND_PATTERN_POLYGON:
+        case COMMAND_FILLED_POLYGON:
+        case COMMAND_FILLED_PATTERN_POLYGON:
+        case COMMAND_TEXTURED_POLYGON:
+            // Empty polygons draw nothing, so their bounds are empty. Curves
+            // lie inside the bounds of their control points.
+            if (!command->points || command->point_count <= 0) {
+                bounds[0] = bounds[1] = 0;
+                bounds[2] = bounds[3] = -1;
+                return true;
+            }
+
+            bounds[0] = bounds[2] = command->points[0];
+            bounds[1] = bounds[3] = command->points[1];
+
+            for (int p = 1; p < command->point_count; p++) {
+                bounds[0] = MIN(bounds[0], command->points[p * 2]);
+                bounds[1] = MIN(bounds[1], command->points[p * 2 + 1]);
+                bounds[2] = MAX(bounds[2], command->points[p * 2]);
+                bounds[3] = MAX(bounds[3], command->points[p * 2 + 1]);
+            }
+
+            bounds[0] -= 1;
+            bounds[1] -= 1;
+            bounds[2] += 1;
+            bounds[3] += 1;
+
+            return true;
+
+        case COMMAND_RECTANGLE:
+        case COMMAND_PATTERN_RECTANGLE:
+        case COMMAND_FILLED_RECTANGLE:
+        case COMMAND_FILLED_PATTERN_RECTANGLE:
+        case COMMAND_ROUNDED_RECTANGLE:
+        case COMMAND_PATTERN_ROUNDED_RECTANGLE:
+        case COMMAND_FILLED_ROUNDED_RECTANGLE:
+        case COMMAND_FILLED_PATTERN_ROUNDED_RECTANGLE:
+        case COMMAND_TEXTURE:
+            points[0] = i[0];
+            points[1] = i[1];
+            points[2] = (int64_t)i[0] + i[2];
+            points[3] = (int64_t)i[1] + i[3];
+            count = 2;
+            vertices = false;
+            break;
+
+        case COMMAND_SPRITE:
+            if (!command->sprite) return false;
+
+            points[0] = i[0];
+            points[1] = i[1];
+            points[2] = (int64_t)i[0] + command->sprite->width;
+            points[3] = (int64_t)i[1] + command->sprite->height;
+            count = 2;
+            vertices = false;
+            break;
+
+        case COMMAND_CIRCLE:
+        case COMMAND_PATTERN_CIRCLE:
+        case COMMAND_FILLED_CIRCLE:
+        case COMMAND_FILLED_PATTERN_CIRCLE:
+        case COMMAND_ARC:
+        case COMMAND_PATTERN_ARC:
+        case COMMAND_FILLED_ARC:
+        case COMMAND_FILLED_PATTERN_ARC: {
+            int64_t radius = i[2] < 0 ? -(int64_t)i[2] : i[2];
+            points[0] = i[0] - radius;
+            points[1] = i[1] - radius;
+            points[2] = i[0] + radius;
+            points[3] = i[1] + radius;
+            count = 2;
+            vertices = false;
+            break;
+        }
+
+        case COMMAND_ELLIPSE:
+        case COMMAND_PATTERN_ELLIPSE:
+        case COMMAND_FILLED_ELLIPSE:
+        case COMMAND_FILLED_PATTERN_ELLIPSE: {
+            int64_t radius_x = i[2] < 0 ? -(int64_t)i[2] : i[2];
+            int64_t radius_y = i[3] < 0 ? -(int64_t)i[3] : i[3];
+            points[0] = i[0] - radius_x;
+            points[1] = i[1] - radius_y;
+            points[2] = i[0] + radius_x;
+            points[3] = i[1] + radius_y;
+            count = 2;
+            vertices = false;
+            break;
+        }
+
+        case COMMAND_TEXT: {
+            // Glyphs are 8x8 and laid out the same way graphics_draw_text
+            // steps through the message
+            int64_t x = 0;
+            int64_t width = 0;
+            int64_t height = 8;
+
+            for (const char* c = command->string; *c != '\0'; c++) {
+                if (*c == '\n') {
+                    x = 0;
+                    height += 8;
+                }
+                else {
+                    x += *c == '\t' ? 16 : 8;
+                    width = MAX(width, x);
+                }
+            }
+
+            points[0] = i[0];
+            points[1] = i[1];
+            points[2] = i[0] + width;
+            points[3] = i[1] + height;
+            count = 2;
+            vertices = false;
+            break;
+        }
+
+        case COMMAND_AFFINE_TEXTURE: {
+            // Clamped and repeated textures fill the drawable region
+            if (i[0] != TEXTURE_WRAP_BORDER) return false;
+
+            mfloat_t corners[4][VEC3_SIZE] = {
+                {0, 0, 1},
+                {0, 1, 1},
+                {1, 1, 1},
+                {1, 0, 1}
+            };
+
+            for (int c = 0; c < 4; c++) {
+                vec3_multiply_mat3(corners[c], corners[c], command->floats);
+
+                // Transformed corners can be anywhere, give up on huge ones
+                if (!(fabsf(corners[c][0]) < INT32_MAX && fabsf(corners[c][1]) < INT32_MAX)) return false;
+
+                points[c * 2] = floorf(corners[c][0]);
+                points[c * 2 + 1] = floorf(corners[c][1]);
+            }
+
+            count = 4;
+            vertices = false;
+            break;
+        }
+
+        default:
+            return false;
+    }
+
+    if (vertices) {
+        for (int p = 0; p < count * 2; p++) {
+            points[p] = i[p];
+        }
+    }
+
+    bounds[0] = bounds[2] = points[0];
+    bounds[1] = bounds[3] = points[1];
+
+    for (int p = 1; p < count; p++) {
+        bounds[0] = MIN(bounds[0], points[p * 2]);
+        bounds[1] = MIN(bounds[1], points[p * 2 + 1]);
+        bounds[2] = MAX(bounds[2], points[p * 2]);
+        bounds[3] = MAX(bounds[3], points[p * 2 + 1]);
+    }
+
+    // Allow for rounding when rasterizing
+    bounds[0] -= 1;
+    bounds[1] -= 1;
+    bounds[2] += 1;
+    bounds[3] += 1;
+
+    return true;
+}
+
+/**
+ * Restrict command bounds to the current clipping rectangle and target.
+ *
+ * @return true if any pixels remain, false otherwise
+ */
+static bool command_bounds_clip(int64_t* bounds, texture_t* target) {
+    rect_t* clip = graphics_draw_clipping_rectangle_get();
+
+    bounds[0] = MAX(bounds[0], MAX(clip->x, 0));
+    bounds[1] = MAX(bounds[1], MAX(clip->y, 0));
+    bounds[2] = MIN(bounds[2], MIN((int64_t)clip->x + clip->width, target->width) - 1);
+    bounds[3] = MIN(bounds[3], MIN((int64_t)clip->y + clip->height, target->height) - 1);
+
+    return bounds[0] <= bounds[2] && bounds[1] <= bounds[3];
+}
+
+/**
+ * Mark region of target a command may draw to as dirty. Commands that only
+ * change draw state mark nothing.
+ */
+static void command_dirty_mark(command_t* command, texture_t* target) {
+    switch (command->op) {
+        case COMMAND_PALETTE_COLOR:
+        case COMMAND_TRANSPARENT_COLOR:
+        case COMMAND_BLEND_TABLE:
+        case COMMAND_CLIPPING_RECTANGLE:
+        case COMMAND_CLIPPING_RECTANGLE_RESET:
+        case COMMAND_RENDER_TEXTURE:
+            return;
+
+        case COMMAND_CLEAR:
+            // Clearing ignores the clipping rectangle
+            graphics_dirty_rectangle_add(target, NULL);
+            return;
+
+        default:
+            break;
+    }
+
+    int64_t bounds[4];
+
+    if (!command_bounds_get(command, target, bounds)) {
+        bounds[0] = 0;
+        bounds[1] = 0;
+        bounds[2] = target->width - 1;
+        bounds[3] = target->height - 1;
+    }
+
+    if (!command_bounds_clip(bounds, target)) return;
+
+    rect_t rect = {
+        bounds[0],
+        bounds[1],
+        bounds[2] - bounds[0] + 1,
+        bounds[3] - bounds[1] + 1
+    };
+
+    graphics_dirty_rectangle_add(target, &rect);
+}
+
+/**
+ * Add command at given offset to every tile it may draw to. The command is
+ * tested against the current clipping rectangle so fully clipped commands
+ * aren't binned.
+ */
+static void tile_grid_add(tile_grid_t* grid, size_t offset, command_t* command) {
+    int64_t bounds[4] = {
+        0,
+        0,
+        grid->target->width - 1,
+        grid->target->height - 1
+    };
+
+    bool state_change = !command_bounds_get(command, grid->target, bounds);
+
+    if (!state_change && !command_bounds_clip(bounds, grid->target)) return;
+
+    int left = bounds[0] / TILE_SIZE;
+    int top = bounds[1] / TILE_SIZE;
+    int right = bounds[2] / TILE_SIZE;
+    int bottom = bounds[3] / TILE_SIZE;
+
+    // Space is reserved in every tile first so a failure leaves no tile
+    // with the command. Blended commands can't be drawn twice.
+    for (int y = top; y <= bottom; y++) {
+        for (int x = left; x <= right; x++) {
+            tile_t* tile = &grid->tiles[y * grid->columns + x];
+
+            if (!reserve((void**)&tile->offsets, &tile->offset_capacity, tile->offset_count + 1, sizeof(size_t))) {
+                grid->failed = true;
+                return;
+            }
+        }
+    }
+
+    for (int y = top; y <= bottom; y++) {
+        for (int x = left; x <= right; x++) {
+            tile_t* tile = &grid->tiles[y * grid->columns + x];
+            tile->offsets[tile->offset_count++] = offset;
+        }
+    }
+}
+
+/**
+ * Restrict clipping rectangle to given tile.
+ */
+static void tile_clip_set(tile_t* tile, rect_t* clip) {
+    int left = MAX(clip->x, tile->rect.x);
+    int top = MAX(clip->y, tile->rect.y);
+    int right = MIN((int64_t)clip->x + clip->width, tile->rect.x + tile->rect.width);
+    int bottom = MIN((int64_t)clip->y + clip->height, tile->rect.y + tile->rect.height);
+
+    rect_t rect = {
+        left,
+        top,
+        MAX(right - left, 0),
+        MAX(bottom - top, 0)
+    };
+
+    graphics_draw_clipping_rectangle_set(&rect);
+}
+
+/**
+ * Worker entry point. Draws all commands binned to a tile.
+ */
+static void tile_draw(void* arg) {
+    tile_t* tile = (tile_t*)arg;
+    tile_grid_t* grid = tile->grid;
+    texture_t* target = grid->target;
+
+    memcpy(graphics_draw_palette_get(), grid->state.palette, sizeof(grid->state.palette));
+    graphics_draw_transparent_color_set(grid->state.transparent_color);
+    graphics_draw_blend_table_set(grid->state.blend_table);
+    tile_clip_set(tile, &grid->state.clip_rect);
+
+    command_t command;
+
+    for (size_t i = 0; i < tile->offset_count; i++) {
+        size_t offset = tile->offsets[i];
+        graphics_command_buffer_next(grid->buffer, &offset, &command);
+
+        switch (command.op) {
+            case COMMAND_CLEAR:
+                // Clearing ignores the clipping rectangle
+                for (int y = tile->rect.y; y < tile->rect.y + tile->rect.height; y++) {
+                    memset(target->pixels + y * target->stride + tile->rect.x, command.ints[0], tile->rect.width);
+                }
+                break;
+
+            case COMMAND_CLIPPING_RECTANGLE:
+            case COMMAND_CLIPPING_RECTANGLE_RESET:
+                command_execute(&command, target);
+                tile_clip_set(tile, graphics_draw_clipping_rectangle_get());
+                break;
+
+            default:
+                // Dirty regions are marked when binning
+                command_execute(&command, target);
+                break;
+        }
+    }
+}
+
+/**
+ * Draw all binned commands and wait for them to finish.
+ */
+static void tile_grid_flush(tile_grid_t* grid, thread_pool_t* pool) {
+    for (size_t i = 0; i < grid->tile_count; i++) {
+        tile_t* tile = &grid->tiles[i];
+        if (tile->offset_count == 0) continue;
+
+        threads_thread_pool_add_work(pool, tile_draw, tile);
+    }
+
+    threads_thread_pool_wait(pool);
+
+    for (size_t i = 0; i < grid->tile_count; i++) {
+        grid->tiles[i].offset_count = 0;
+    }
+}
+
+texture_t* graphics_command_buffer_execute_parallel(command_buffer_t* buffer, texture_t* destination, thread_pool_t* pool) {
+    if (!pool) {
+        return graphics_command_buffer_execute(buffer, destination);
+    }
+
+    tile_grid_t grid = {0};
+    grid.buffer = buffer;
+
+    texture_t* target = destination ? destination : graphics_render_texture_get();
+    bool binning = tile_grid_begin(&grid, target);
+
+    command_t command;
+    size_t offset = 0;
+    size_t command_offset = 0;
+
+    while (graphics_command_buffer_next(buffer, &offset, &command)) {
+        // Render texture changes and commands reading from the target are
+        // drawn on this thread between binned runs. Flood fills read the
+        // target past any tile.
+        bool serial = !binning || command.op == COMMAND_RENDER_TEXTURE || command.op == COMMAND_FLOOD_FILL || command.op == COMMAND_PATTERN_FLOOD_FILL || graphics_texture_overlaps(command.texture, target);
+
+        if (!serial) {
+            command_dirty_mark(&command, target);
+            tile_grid_add(&grid, command_offset, &command);
+
+            // Commands that failed to bin are drawn on this thread instead
+            serial = grid.failed;
+        }
+
+        if (serial) {
+            tile_grid_flush(&grid, pool);
+
+            destination = graphics_command_execute(&command, destination);
+            target = destination ? destination : graphics_render_texture_get();
+
+            grid.failed = false;
+            binning = tile_grid_begin(&grid, target);
+        }
+        else {
+            // Keep this thread's state in step for binning and for the
+            // caller once all commands are done
+            switch (command.op) {
+                case COMMAND_PALETTE_COLOR:
+                case COMMAND_TRANSPARENT_COLOR:
+                case COMMAND_BLEND_TABLE:
+                case COMMAND_CLIPPING_RECTANGLE:
+                case COMMAND_CLIPPING_RECTANGLE_RESET:
+                    graphics_command_execute(&command, destination);
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        command_offset = offset;
+    }
+
+    tile_grid_flush(&grid, pool);
+    tile_grid_free(&grid);
+
+    return destination;
+}
+
+texture_t* graphics_command_execute(command_t* command, texture_t* destination) {
+    texture_t* target = destination ? destination : graphics_render_texture_get();
+    command_dirty_mark(command, target);
+
+    // Tables are only rebuilt here on the main thread, so draw threads just
+    // read them. The current table is checked before every command, so it
+    // follows palette changes made since it was selected.
+    blend_table_t* table = command->op == COMMAND_BLEND_TABLE ? command->blend_table : graphics_draw_blend_table_get();
+
+    if (table) {
+        graphics_blend_table_update(table);
+    }
+
+    return command_execute(command, destination);
+}
+
+/**
+ * Execute a single command. Used by draw threads, so dirty regions are left
+ * for the caller to mark.
+ */
+static texture_t* command_execute(command_t* command, texture_t* destination) {
+    texture_t* target = destination ? destination : graphics_render_texture_get();
+    int* i = command->ints;
+    float* f = command->floats;
+    texture_t* texture = command->texture;
+
+    switch (command->op) {
+        case COMMAND_PIXEL:
+            graphics_draw_pixel(target, i[0], i[1], i[2]);
+            break;
+
+        case COMMAND_LINE:
+            graphics_draw_line(target, i[0], i[1], i[2], i[3], i[4]);
+            break;
+
+        case COMMAND_PATTERN_LINE:
+            graphics_draw_pattern_line(target, i[0], i[1], i[2], i[3], texture, i[4], i[5]);
+            break;
+
+        case COMMAND_TEXTURED_LINE:
+            graphics_draw_textured_line(target, i[0], i[1], f[0], f[1], i[2], i[3], f[2], f[3], texture);
+            break;
+
+        case COMMAND_BEZIER:
+            graphics_draw_bezier(target, i[0], i[1], i[2], i[3], i[4], i[5], i[6], i[7], i[8]);
+            break;
+
+        case COMMAND_PATTERN_BEZIER:
+            graphics_draw_pattern_bezier(target, i[0], i[1], i[2], i[3], i[4], i[5], i[6], i[7], texture, i[8], i[9]);
+            break;
+
+        case COMMAND_QUADRATIC_BEZIER:
+            graphics_draw_quadratic_bezier(target, i[0], i[1], i[2], i[3], i[4], i[5], i[6]);
+            break;
+
+        case COMMAND_PATTERN_QUADRATIC_BEZIER:
+            graphics_draw_pattern_quadratic_bezier(target, i[0], i[1], i[2], i[3], i[4], i[5], texture, i[6], i[7]);
+            break;
+
+        case COMMAND_BEZIERS:
+            graphics_draw_beziers(target, command->points, command->point_count, i[0]);
+            break;
+
+        case COMMAND_PATTERN_BEZIERS:
+            graphics_draw_pattern_beziers(target, command->points, command->point_count, texture, i[0], i[1]);
+            break;
+
+        case COMMAND_QUADRATIC_BEZIERS:
+            graphics_draw_quadratic_beziers(target, command->points, command->point_count, i[0]);
+            break;
+
+        case COMMAND_PATTERN_QUADRATIC_BEZIERS:
+            graphics_draw_pattern_quadratic_beziers(target, command->points, command->point_count, texture, i[0], i[1]);
+            break;
+
+        case COMMAND_RECTANGLE:
+            graphics_draw_rectangle(target, i[0], i[1], i[2], i[3], i[4]);
+            break;
+
+        case COMMAND_PATTERN_RECTANGLE:
+            graphics_draw_pattern_rectangle(target, i[0], i[1], i[2], i[3], texture, i[4], i[5]);
+            break;
+
+        case COMMAND_FILLED_RECTANGLE:
+            graphics_draw_filled_rectangle(target, i[0], i[1], i[2], i[3], i[4]);
+            break;
+
+        case COMMAND_FILLED_PATTERN_RECTANGLE:
+            graphics_draw_filled_pattern_rectangle(target, i[0], i[1], i[2], i[3], texture, i[4], i[5]);
+            break;
+
+        case COMMAND_ROUNDED_RECTANGLE:
+            graphics_draw_rounded_rectangle(target, i[0], i[1], i[2], i[3], i[4], i[5]);
+            break;
+
+        case COMMAND_PATTERN_ROUNDED_RECTANGLE:
+            graphics_draw_pattern_rounded_rectangle(target, i[0], i[1], i[2], i[3], i[4], texture, i[5], i[6]);
+            break;
+
+        case COMMAND_FILLED_ROUNDED_RECTANGLE:
+            graphics_draw_filled_rounded_rectangle(target, i[0], i[1], i[2], i[3], i[4], i[5]);
+            break;
+
+        case COMMAND_FILLED_PATTERN_ROUNDED_RECTANGLE:
+            graphics_draw_filled_pattern_rounded_rectangle(target, i[0], i[1], i[2], i[3], i[4], texture, i[5], i[6]);
+            break;
+
+        case COMMAND_FLOOD_FILL:
+            graphics_draw_flood_fill(target, i[0], i[1], i[2]);
+            break;
+
+        case COMMAND_PATTERN_FLOOD_FILL:
+            graphics_draw_pattern_flood_fill(target, i[0], i[1], texture, i[2], i[3]);
+            break;
+
+        case COMMAND_CIRCLE:
+            graphics_draw_circle(target, i[0], i[1], i[2], i[3]);
+            break;
+
+        case COMMAND_PATTERN_CIRCLE:
+            graphics_draw_pattern_circle(target, i[0], i[1], i[2], texture, i[3], i[4]);
+            break;
+
+        case COMMAND_FILLED_CIRCLE:
+            graphics_draw_filled_circle(target, i[0], i[1], i[2], i[3]);
+            break;
+
+        case COMMAND_FILLED_PATTERN_CIRCLE:
+            graphics_draw_filled_pattern_circle(target, i[0], i[1], i[2], texture, i[3], i[4]);
+            break;
+
+        case COMMAND_ELLIPSE:
+            graphics_draw_ellipse(target, i[0], i[1], i[2], i[3], i[4]);
+            break;
+
+        case COMMAND_PATTERN_ELLIPSE:
+            graphics_draw_pattern_ellipse(target, i[0], i[1], i[2], i[3], texture, i[4], i[5]);
+            break;
+
+        case COMMAND_FILLED_ELLIPSE:
+            graphics_draw_filled_ellipse(target, i[0], i[1], i[2], i[3], i[4]);
+            break;
+
+        case COMMAND_FILLED_PATTERN_ELLIPSE:
+            graphics_draw_filled_pattern_ellipse(target, i[0], i[1], i[2], i[3], texture, i[4], i[5]);
+            break;
+
+        case COMMAND_ARC:
+            graphics_draw_arc(target, i[0], i[1], i[2], f[0], f[1], i[3]);
+            break;
+
+        case COMMAND_PATTERN_ARC:
+            graphics_draw_pattern_arc(target, i[0], i[1], i[2], f[0], f[1], texture, i[3], i[4]);
+            break;
+
+        case COMMAND_FILLED_ARC:
+            graphics_draw_filled_arc(target, i[0], i[1], i[2], f[0], f[1], i[3]);
+            break;
+
+        case COMMAND_FILLED_PATTERN_ARC:
+            graphics_draw_filled_pattern_arc(target, i[0], i[1], i[2], f[0], f[1], texture, i[3], i[4]);
+            break;
+
+        case COMMAND_TEXT: {
+            // Negative colors use the draw palette
+            color_t* palette = graphics_draw_palette_get();
+            color_t foreground = i[2] >= 0 ? i[2] : palette[1];
+            color_t background = i[3] >= 0 ? i[3] : palette[0];
+
+            graphics_draw_colored_text(target, command->string, i[0], i[1], foreground, background);
+            break;
+        }
+
+        case COMMAND_TRIANGLE:
+            graphics_draw_triangle(target, i[0], i[1], i[2], i[3], i[4], i[5], i[6]);
+            break;
+
+        case COMMAND_PATTERN_TRIANGLE:
+            graphics_draw_pattern_triangle(target, i[0], i[1], i[2], i[3], i[4], i[5], texture, i[6], i[7]);
+            break;
+
+        case COMMAND_FILLED_TRIANGLE:
+            graphics_draw_filled_triangle(target, i[0], i[1], i[2], i[3], i[4], i[5], i[6]);
+            break;
+
+        case COMMAND_FILLED_PATTERN_TRIANGLE:
+            graphics_draw_filled_pattern_triangle(target, i[0], i[1], i[2], i[3], i[4], i[5], texture, i[6], i[7]);
+            break;
+
+        case COMMAND_TEXTURED_TRIANGLE:
+            graphics_draw_textured_triangle(target, i[0], i[1], f[0], f[1], i[2], i[3], f[2], f[3], i[4], i[5], f[4], f[5], texture);
+            break;
+
+        case COMMAND_QUAD:
+            graphics_draw_quad(target, i[0], i[1], i[2], i[3], i[4], i[5], i[6], i[7], i[8]);
+            break;
+
+        case COMMAND_PATTERN_QUAD:
+            graphics_draw_pattern_quad(target, i[0], i[1], i[2], i[3], i[4], i[5], i[6], i[7], texture, i[8], i[9]);
+            break;
+
+        case COMMAND_FILLED_QUAD:
+            graphics_draw_filled_quad(target, i[0], i[1], i[2], i[3], i[4], i[5], i[6], i[7], i[8]);
+            break;
+
+        case COMMAND_FILLED_PATTERN_QUAD:
+            graphics_draw_filled_pattern_quad(target, i[0], i[1], i[2], i[3], i[4], i[5], i[6], i[7], texture, i[8], i[9]);
+            break;
+
+        case COMMAND_TEXTURED_QUAD:
+            graphics_draw_textured_quad(target, i[0], i[1], f[0], f[1], i[2], i[3], f[2], f[3], i[4], i[5], f[4], f[5], i[6], i[7], f[6], f[7], texture);
+            break;
+
+        case COMMAND_POLYLINE:
+            graphics_draw_polyline(target, command->points, command->point_count, i[0]);
+            break;
+
+        case COMMAND_PATTERN_POLYLINE:
+            graphics_draw_pattern_polyline(target, command->points, command->point_count, texture, i[0], i[1]);
+            break;
+
+        case COMMAND_POLYGON:
+            graphics_draw_polygon(target, command->points, command->point_count, i[0]);
+            break;
+
+        case COMMAND_PATTERN_POLYGON:
+            graphics_draw_pattern_polygon(target, command->points, command->point_count, texture, i[0], i[1]);
+            break;
+
+        case COMMAND_FILLED_POLYGON:
+            graphics_draw_filled_polygon(target, command->points, command->point_count, i[0], i[1]);
+            break;
+
+        case COMMAND_FILLED_PATTERN_POLYGON:
+            graphics_draw_filled_pattern_polygon(target, command->points, command->point_count, texture, i[0], i[1], i[2]);
+            break;
+
+        case COMMAND_TEXTURED_POLYGON:
+            graphics_draw_textured_polygon(target, command->points, command->coordinates, command->point_count, texture, i[0]);
+            break;
+
+        case COMMAND_TEXTURE:
+            graphics_draw_texture(target, texture, i[0], i[1], i[2], i[3]);
+            break;
+
+        case COMMAND_AFFINE_TEXTURE:
+            graphics_draw_affine_texture(target, texture, f, i[0]);
+            break;
+
+        case COMMAND_SPRITE:
+            graphics_draw_sprite(target, command->sprite, i[0], i[1], i[2], i[3]);
+            break;
+
+        case COMMAND_CLEAR:
+            graphics_texture_clear(target, i[0]);
+            break;
+
+        case COMMAND_PALETTE_COLOR:
+            graphics_draw_palette_get()[i[0] & 0xFF] = i[1];
+            break;
+
+        case COMMAND_TRANSPARENT_COLOR:
+            graphics_draw_transparent_color_set(i[0]);
+            break;
+
+        case COMMAND_BLEND_TABLE:
+            graphics_draw_blend_table_set(command->blend_table);
+            break;
+
+        case COMMAND_CLIPPING_RECTANGLE: {
+            rect_t clip_rect = {i[0], i[1], i[2], i[3]};
+            graphics_draw_clipping_rectangle_set(&clip_rect);
+            break;
+        }
+
+        case COMMAND_CLIPPING_RECTANGLE_RESET:
+            graphics_draw_clipping_rectangle_set(NULL);
+            break;
+
+        case COMMAND_RENDER_TEXTURE:
+            destination = texture;
+            break;
+
+        default:
+            log_error("Invalid draw command");
+            break;
+    }
+
+    return destination;
+}
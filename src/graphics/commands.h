@@ -0,0 +1,212 @@
+#ifndef GRAPHICS_COMMANDS_H
+#define GRAPHICS_COMMANDS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../graphics/blend.h"
+#include "../graphics/types.h"
+#include "../threads.h"
+
+typedef enum {
+    COMMAND_PIXEL,
+    COMMAND_LINE,
+    COMMAND_PATTERN_LINE,
+    COMMAND_TEXTURED_LINE,
+    COMMAND_BEZIER,
+    COMMAND_PATTERN_BEZIER,
+    COMMAND_QUADRATIC_BEZIER,
+    COMMAND_PATTERN_QUADRATIC_BEZIER,
+    COMMAND_BEZIERS,
+    COMMAND_PATTERN_BEZIERS,
+    COMMAND_QUADRATIC_BEZIERS,
+    COMMAND_PATTERN_QUADRATIC_BEZIERS,
+    COMMAND_RECTANGLE,
+    COMMAND_PATTERN_RECTANGLE,
+    COMMAND_FILLED_RECTANGLE,
+    COMMAND_FILLED_PATTERN_RECTANGLE,
+    COMMAND_ROUNDED_RECTANGLE,
+    COMMAND_PATTERN_ROUNDED_RECTANGLE,
+    COMMAND_FILLED_ROUNDED_RECTANGLE,
+    COMMAND_FILLED_PATTERN_ROUNDED_RECTANGLE,
+    COMMAND_FLOOD_FILL,
+    COMMAND_PATTERN_FLOOD_FILL,
+    COMMAND_CIRCLE,
+    COMMAND_PATTERN_CIRCLE,
+    COMMAND_FILLED_CIRCLE,
+    COMMAND_FILLED_PATTERN_CIRCLE,
+    COMMAND_ELLIPSE,
+    COMMAND_PATTERN_ELLIPSE,
+    COMMAND_FILLED_ELLIPSE,
+    COMMAND_FILLED_PATTERN_ELLIPSE,
+    COMMAND_ARC,
+    COMMAND_PATTERN_ARC,
+    COMMAND_FILLED_ARC,
+    COMMAND_FILLED_PATTERN_ARC,
+    COMMAND_TEXT,
+    COMMAND_TRIANGLE,
+    COMMAND_PATTERN_TRIANGLE,
+    COMMAND_FILLED_TRIANGLE,
+    COMMAND_FILLED_PATTERN_TRIANGLE,
+    COMMAND_TEXTURED_TRIANGLE,
+    COMMAND_QUAD,
+    COMMAND_PATTERN_QUAD,
+    COMMAND_FILLED_QUAD,
+    COMMAND_FILLED_PATTERN_QUAD,
+    COMMAND_TEXTURED_QUAD,
+    COMMAND_POLYLINE,
+    COMMAND_PATTERN_POLYLINE,
+    COMMAND_POLYGON,
+    COMMAND_PATTERN_POLYGON,
+    COMMAND_FILLED_POLYGON,
+    COMMAND_FILLED_PATTERN_POLYGON,
+    COMMAND_TEXTURED_POLYGON,
+    COMMAND_TEXTURE,
+    COMMAND_AFFINE_TEXTURE,
+    COMMAND_SPRITE,
+    COMMAND_CLEAR,
+    COMMAND_PALETTE_COLOR,
+    COMMAND_TRANSPARENT_COLOR,
+    COMMAND_BLEND_TABLE,
+    COMMAND_CLIPPING_RECTANGLE,
+    COMMAND_CLIPPING_RECTANGLE_RESET,
+    COMMAND_RENDER_TEXTURE,
+    COMMAND_COUNT
+} command_op_t;
+
+#define COMMAND_MAX_INTS 10
+#define COMMAND_MAX_FLOATS 9
+
+/**
+ * A single decoded draw command. Integer arguments hold coordinates, sizes,
+ * colors and pattern offsets in the same order as the corresponding
+ * graphics_draw_* function. Float arguments hold UV coordinates, arc angles
+ * or a 3x3 matrix. Polygons, polylines and curve lists keep their vertices in points
+ * and coordinates, which only have to stay valid until the command is added
+ * or executed. Blend
+ * tables are referenced like textures and must outlive the buffer.
+ */
+typedef struct {
+    command_op_t op;
+    int ints[COMMAND_MAX_INTS];
+    float floats[COMMAND_MAX_FLOATS];
+    texture_t* texture;
+    sprite_t* sprite;
+    const char* string;
+    const int* points;
+    const float* coordinates;
+    int point_count;
+    blend_table_t* blend_table;
+} command_t;
+
+/**
+ * Compact list of recorded draw commands. Only the arguments a command uses
+ * are stored.
+ */
+typedef struct {
+    uint32_t* words;
+    size_t word_count;
+    size_t word_capacity;
+
+    texture_t** textures;
+    size_t texture_count;
+    size_t texture_capacity;
+
+    sprite_t** sprites;
+    size_t sprite_count;
+    size_t sprite_capacity;
+
+    blend_table_t** blend_tables;
+    size_t blend_table_count;
+    size_t blend_table_capacity;
+
+    char* strings;
+    size_t string_size;
+    size_t string_capacity;
+
+    int* points;
+    size_t point_size;
+    size_t point_capacity;
+
+    float* coordinates;
+    size_t coordinate_size;
+    size_t coordinate_capacity;
+
+    size_t count;
+} command_buffer_t;
+
+/**
+ * Create a new empty command buffer.
+ *
+ * @return New command buffer if successful, NULL otherwise
+ */
+command_buffer_t* graphics_command_buffer_new(void);
+
+/**
+ * Frees a command buffer.
+ *
+ * @param buffer Command buffer to free
+ */
+void graphics_command_buffer_free(command_buffer_t* buffer);
+
+/**
+ * Remove all commands from buffer. Allocated storage is kept for reuse.
+ *
+ * @param buffer Command buffer to clear
+ */
+void graphics_command_buffer_clear(command_buffer_t* buffer);
+
+/**
+ * Append command to end of buffer. Strings and polygon vertices are copied
+ * into the buffer.
+ *
+ * @param buffer Command buffer to append to
+ * @param command Command to append
+ * @return true if successful, false otherwise
+ */
+bool graphics_command_buffer_add(command_buffer_t* buffer, command_t* command);
+
+/**
+ * Decode command at given offset.
+ *
+ * @param buffer Command buffer to read from
+ * @param offset Word offset of command. Advanced to the next command.
+ * @param command Decoded command
+ * @return true if a command was decoded, false at end of buffer
+ */
+bool graphics_command_buffer_next(command_buffer_t* buffer, size_t* offset, command_t* command);
+
+/**
+ * Execute all commands in buffer in order.
+ *
+ * @param buffer Command buffer to execute
+ * @param destination Texture to draw to. NULL to draw to the render texture.
+ * @return Texture drawn to after the last command. NULL if render texture.
+ */
+texture_t* graphics_command_buffer_execute(command_buffer_t* buffer, texture_t* destination);
+
+/**
+ * Execute all commands in buffer using worker threads. Each destination is
+ * split into tiles, commands are binned by the tiles they touch, and every
+ * tile draws its commands in order on a worker. The result is identical to
+ * graphics_command_buffer_execute.
+ *
+ * @param buffer Command buffer to execute
+ * @param destination Texture to draw to. NULL to draw to the render texture.
+ * @param pool Thread pool to draw tiles on. NULL to execute on this thread.
+ * @return Texture drawn to after the last command. NULL if render texture.
+ */
+texture_t* graphics_command_buffer_execute_parallel(command_buffer_t* buffer, texture_t* destination, thread_pool_t* pool);
+
+/**
+ * Execute a single command. Marks the region the command may draw to as
+ * dirty, so it must be called from the main thread.
+ *
+ * @param command Command to execute
+ * @param destination Texture to draw to. NULL to draw to the render texture.
+ * @return Texture drawn to after the command. NULL if render texture.
+ */
+texture_t* graphics_command_execute(command_t* command, texture_t* destination);
+
+#endif
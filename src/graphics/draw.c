@@ -1,20 +1,31 @@
 #include <math.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 
 #include <math.h>
 
 #include <mathc/mathc.h>
 
+#include "blit.h"
 #include "draw.h"
-#include "../assets.h"
 #include "../graphics.h"
-#include "../log.h"
 #include "../math.h"
+#include "../threads.h"
 
-static color_t draw_palette[256];
-static color_t transparent_color = 0;
-static rect_t clip_rect;
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+// Draw state is per thread so tiles can be drawn in parallel. Primitives
+// must produce the same pixels however they are clipped for this to be
+// deterministic.
+static THREAD_LOCAL color_t draw_palette[256];
+static THREAD_LOCAL color_t transparent_color = 0;
+static THREAD_LOCAL rect_t clip_rect;
+
+// Blend table combining drawn colors with the destination. NULL to write
+// colors as is.
+static THREAD_LOCAL blend_table_t* blend_table = NULL;
 
 void graphics_draw_pixel(texture_t* destination, int x, int y, color_t color) {
     // Don't draw if transparent
@@ -24,666 +35,2751 @@ void graphics_draw_pixel(texture_t* destination, int x, int y, color_t color) {
     if (x < clip_rect.x || x >= clip_rect.x + clip_rect.width) return;
     if (y < clip_rect.y || y >= clip_rect.y + clip_rect.height) return;
 
+    if (blend_table) {
+        color = blend_table->colors[color][graphics_texture_pixel_get(destination, x, y)];
+    }
+
     graphics_texture_pixel_set(destination, x, y, color);
 }
 
-static void pattern_pixel_set(texture_t* destination, int x, int y, texture_t* pattern, int offset_x, int offset_y) {
-    if (!pattern) return;
+/**
+ * Get drawable region of given texture. This is the intersection of the
+ * clipping rectangle and the texture bounds.
+ *
+ * @param destination Texture to draw to
+ * @param bounds Drawable region. Width and height will be zero if empty.
+ * @return true if drawable region is not empty, false otherwise
+ */
+static bool drawable_bounds_get(texture_t* destination, rect_t* bounds) {
+    int left = clip_rect.x > 0 ? clip_rect.x : 0;
+    int top = clip_rect.y > 0 ? clip_rect.y : 0;
+    int right = clip_rect.x + clip_rect.width;
+    int bottom = clip_rect.y + clip_rect.height;
+
+    if (right > destination->width) right = destination->width;
+    if (bottom > destination->height) bottom = destination->height;
+
+    bounds->x = left;
+    bounds->y = top;
+    bounds->width = right > left ? right - left : 0;
+    bounds->height = bottom > top ? bottom - top : 0;
+
+    return bounds->width > 0 && bounds->height > 0;
+}
+
+typedef enum {
+    CLIP_OUTSIDE = 0,
+    CLIP_PARTIAL,
+    CLIP_INSIDE
+} clip_result_t;
+
+/**
+ * Classify an inclusive bounding box against the drawable region.
+ *
+ * @param bounds Drawable region
+ * @param x0 Box left x-coordinate
+ * @param y0 Box top y-coordinate
+ * @param x1 Box right x-coordinate
+ * @param y1 Box bottom y-coordinate
+ * @return CLIP_INSIDE if every pixel is drawable, CLIP_OUTSIDE if no pixel
+ * is drawable, CLIP_PARTIAL otherwise
+ */
+static clip_result_t clip_test(rect_t* bounds, int x0, int y0, int x1, int y1) {
+    int right = bounds->x + bounds->width;
+    int bottom = bounds->y + bounds->height;
+
+    if (x1 < bounds->x || x0 >= right) return CLIP_OUTSIDE;
+    if (y1 < bounds->y || y0 >= bottom) return CLIP_OUTSIDE;
+
+    if (x0 >= bounds->x && x1 < right && y0 >= bounds->y && y1 < bottom) {
+        return CLIP_INSIDE;
+    }
+
+    return CLIP_PARTIAL;
+}
+
+/**
+ * Determine if given point is inside drawable region.
+ */
+static inline bool bounds_contains(rect_t* bounds, int x, int y) {
+    return (unsigned)(x - bounds->x) < (unsigned)bounds->width &&
+           (unsigned)(y - bounds->y) < (unsigned)bounds->height;
+}
+
+/**
+ * Write pixel without any transparency or bounds checks. Callers are
+ * expected to have clipped against the drawable region. The blend table is
+ * passed in so loops load it once, as pixel writes could alias it.
+ */
+static inline void pixel_put(texture_t* destination, const blend_table_t* blend, int x, int y, color_t color) {
+    color_t* pixel = &destination->pixels[y * destination->stride + x];
+    *pixel = blend ? blend->colors[color][*pixel] : color;
+}
+
+/**
+ * Fill count pixels of a row with given color, blending when a blend table
+ * is set. Blending with a single color only needs one row of the table.
+ */
+static inline void row_fill(color_t* row, int count, color_t color) {
+    if (!blend_table) {
+        memset(row, color, count);
+        return;
+    }
+
+    const color_t* blend = blend_table->colors[color];
+
+    for (int i = 0; i < count; i++) {
+        row[i] = blend[row[i]];
+    }
+}
+
+/**
+ * Fill horizontal run of pixels from x0 to x1 inclusive. Span is clipped
+ * against the drawable region and then written directly to the destination
+ * row. Callers are responsible for the transparent color check.
+ *
+ * @param destination Texture to draw to
+ * @param bounds Drawable region
+ * @param x0 Span start x-coordinate
+ * @param x1 Span end x-coordinate
+ * @param y Span y-coordinate
+ * @param color Fill color
+ */
+static void fill_span(texture_t* destination, rect_t* bounds, int x0, int x1, int y, color_t color) {
+    if (x0 > x1) {
+        int swap = x0;
+        x0 = x1;
+        x1 = swap;
+    }
+
+    if (y < bounds->y || y >= bounds->y + bounds->height) return;
+
+    if (x0 < bounds->x) x0 = bounds->x;
+    if (x1 >= bounds->x + bounds->width) x1 = bounds->x + bounds->width - 1;
+    if (x0 > x1) return;
+
+    row_fill(destination->pixels + y * destination->stride + x0, x1 - x0 + 1, color);
+}
+
+/**
+ * Pattern texture with its offsets resolved for wrapping. Set up once per
+ * primitive so spans and pixels only need an integer remainder to find
+ * their pattern coordinates.
+ */
+typedef struct {
+    texture_t* texture;
+    int wrap_x;
+    int wrap_y;
+} pattern_t;
+
+/**
+ * Prepare pattern for drawing.
+ *
+ * @param pattern Pattern to set up
+ * @param texture Texture to use as a pattern
+ * @param offset_x Pattern x-axis offset
+ * @param offset_y Pattern y-axis offset
+ * @return true if pattern can be drawn, false otherwise
+ */
+static bool pattern_init(pattern_t* pattern, texture_t* texture, int offset_x, int offset_y) {
+    if (!texture || texture->width <= 0 || texture->height <= 0) return false;
+
+    // Offsets are folded into (0, size] so any drawable coordinate plus the
+    // wrap value is non-negative
+    pattern->texture = texture;
+    pattern->wrap_x = texture->width - (offset_x % texture->width + texture->width) % texture->width;
+    pattern->wrap_y = texture->height - (offset_y % texture->height + texture->height) % texture->height;
+
+    return true;
+}
+
+/**
+ * Get pattern row for given destination y-coordinate.
+ */
+static inline const color_t* pattern_row_get(pattern_t* pattern, int y) {
+    texture_t* texture = pattern->texture;
+
+    return texture->pixels + ((y + pattern->wrap_y) % texture->height) * texture->stride;
+}
+
+static void pattern_pixel_set(texture_t* destination, rect_t* bounds, bool inside, int x, int y, pattern_t* pattern) {
+    if (!inside && !bounds_contains(bounds, x, y)) return;
+
+    const color_t* source = pattern_row_get(pattern, y);
+    color_t pixel = draw_palette[source[(x + pattern->wrap_x) % pattern->texture->width]];
+    if (pixel == transparent_color) return;
+
+    pixel_put(destination, blend_table, x, y, pixel);
+}
+
+/**
+ * Fill horizontal run of pixels from x0 to x1 inclusive with given pattern.
+ * Span is clipped against the drawable region once and the pattern row is
+ * looked up once. The first repetition of the row is remapped by the draw
+ * palette, and if none of it is transparent and nothing is blended it is
+ * copied along the rest of the span.
+ *
+ * @param destination Texture to draw to
+ * @param bounds Drawable region
+ * @param x0 Span start x-coordinate
+ * @param x1 Span end x-coordinate
+ * @param y Span y-coordinate
+ * @param pattern Pattern to fill with
+ */
+static void pattern_span(texture_t* destination, rect_t* bounds, int x0, int x1, int y, pattern_t* pattern) {
+    if (x0 > x1) {
+        int swap = x0;
+        x0 = x1;
+        x1 = swap;
+    }
+
+    if (y < bounds->y || y >= bounds->y + bounds->height) return;
+
+    if (x0 < bounds->x) x0 = bounds->x;
+    if (x1 >= bounds->x + bounds->width) x1 = bounds->x + bounds->width - 1;
+    if (x0 > x1) return;
+
+    int width = pattern->texture->width;
+    const color_t* source = pattern_row_get(pattern, y);
+    color_t* row = destination->pixels + y * destination->stride + x0;
+
+    int count = x1 - x0 + 1;
+    int period = MIN(count, width);
+    int sx = (x0 + pattern->wrap_x) % width;
+    const blend_table_t* blend = blend_table;
+    bool opaque = !blend;
+
+    for (int i = 0; i < period; i++) {
+        color_t pixel = draw_palette[source[sx]];
+
+        if (pixel != transparent_color) {
+            row[i] = blend ? blend->colors[pixel][row[i]] : pixel;
+        }
+        else {
+            opaque = false;
+        }
+
+        if (++sx == width) sx = 0;
+    }
+
+    if (opaque) {
+        // Span is now whole repetitions of the first one, so keep doubling
+        for (int i = period; i < count;) {
+            int size = MIN(i, count - i);
+            memcpy(row + i, row, size);
+            i += size;
+        }
+
+        return;
+    }
+
+    for (int i = period; i < count; i++) {
+        color_t pixel = draw_palette[source[sx]];
+        if (pixel != transparent_color) row[i] = blend ? blend->colors[pixel][row[i]] : pixel;
+
+        if (++sx == width) sx = 0;
+    }
+}
+
+/**
+ * Incremental state for walking the pixels of a line. Lines are stepped one
+ * pixel at a time along the major axis and the minor axis is advanced
+ * whenever the error term overflows.
+ */
+typedef struct line {
+    int x;
+    int y;
+    int major_x;
+    int major_y;
+    int minor_x;
+    int minor_y;
+    int error;
+    int error_increment;
+    int error_decrement;
+    int first;
+    int last;
+    int length;
+} line_t;
+
+enum {
+    OUTCODE_LEFT = 1,
+    OUTCODE_RIGHT = 2,
+    OUTCODE_TOP = 4,
+    OUTCODE_BOTTOM = 8
+};
+
+/**
+ * Get Cohen-Sutherland outcode of given point.
+ */
+static int outcode_get(rect_t* bounds, int x, int y) {
+    int code = 0;
+
+    if (x < bounds->x) code |= OUTCODE_LEFT;
+    else if (x >= bounds->x + bounds->width) code |= OUTCODE_RIGHT;
+
+    if (y < bounds->y) code |= OUTCODE_TOP;
+    else if (y >= bounds->y + bounds->height) code |= OUTCODE_BOTTOM;
+
+    return code;
+}
+
+static int64_t ceil_div(int64_t a, int64_t b) {
+    return a >= 0 ? (a + b - 1) / b : -(-a / b);
+}
+
+static int64_t floor_div(int64_t a, int64_t b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+/**
+ * Set up line walk from x0, y0 to x1, y1 clipped to drawable region.
+ *
+ * Lines are rasterized with the midpoint algorithm. Outcodes trivially accept
+ * or reject the line. Partially visible lines are clipped by solving for the
+ * range of steps along the major axis that land inside the drawable region,
+ * so the visible pixels are exactly those of the unclipped line.
+ *
+ * @param line Line walk to initialize
+ * @param bounds Drawable region
+ * @return true if any pixel of line is visible, false otherwise
+ */
+static bool line_clip(line_t* line, rect_t* bounds, int x0, int y0, int x1, int y1) {
+    int code0 = outcode_get(bounds, x0, y0);
+    int code1 = outcode_get(bounds, x1, y1);
+
+    if (code0 & code1) return false;
+
+    int64_t delta_x = (int64_t)x1 - x0;
+    int64_t delta_y = (int64_t)y1 - y0;
+    int step_x = delta_x < 0 ? -1 : 1;
+    int step_y = delta_y < 0 ? -1 : 1;
+    int64_t abs_x = delta_x < 0 ? -delta_x : delta_x;
+    int64_t abs_y = delta_y < 0 ? -delta_y : delta_y;
+
+    bool x_major = abs_x >= abs_y;
+    int64_t major = x_major ? abs_x : abs_y;
+    int64_t minor = x_major ? abs_y : abs_x;
+
+    // Express bounds relative to the start point along each axis direction
+    int64_t left = (int64_t)bounds->x - x0;
+    int64_t right = (int64_t)bounds->x + bounds->width - 1 - x0;
+    int64_t top = (int64_t)bounds->y - y0;
+    int64_t bottom = (int64_t)bounds->y + bounds->height - 1 - y0;
+
+    int64_t x_low = step_x > 0 ? left : -right;
+    int64_t x_high = step_x > 0 ? right : -left;
+    int64_t y_low = step_y > 0 ? top : -bottom;
+    int64_t y_high = step_y > 0 ? bottom : -top;
+
+    int64_t major_low = x_major ? x_low : y_low;
+    int64_t major_high = x_major ? x_high : y_high;
+    int64_t minor_low = x_major ? y_low : x_low;
+    int64_t minor_high = x_major ? y_high : x_high;
+
+    int64_t first = 0;
+    int64_t last = major;
+
+    if (code0 | code1) {
+        // Clip major axis directly
+        if (major_low > first) first = major_low;
+        if (major_high < last) last = major_high;
+
+        // Clip minor axis. Minor offset of step i is
+        // floor((2 * i * minor + major) / (2 * major)).
+        if (minor == 0) {
+            if (minor_low > 0 || minor_high < 0) return false;
+        }
+        else {
+            if (minor_high < 0) return false;
+
+            if (minor_low > 0) {
+                int64_t i = ceil_div(2 * major * minor_low - major, 2 * minor);
+                if (i > first) first = i;
+            }
+
+            int64_t i = floor_div(2 * major * (minor_high + 1) - major - 1, 2 * minor);
+            if (i < last) last = i;
+        }
+
+        if (first > last) return false;
+    }
+
+    int64_t error_decrement = 2 * major;
+    int64_t numerator = 2 * first * minor + major;
+    int64_t minor_offset = major ? numerator / error_decrement : 0;
+
+    line->major_x = x_major ? step_x : 0;
+    line->major_y = x_major ? 0 : step_y;
+    line->minor_x = x_major ? 0 : step_x;
+    line->minor_y = x_major ? step_y : 0;
+    line->x = x0 + line->major_x * first + line->minor_x * minor_offset;
+    line->y = y0 + line->major_y * first + line->minor_y * minor_offset;
+    line->error = major ? numerator % error_decrement : 0;
+    line->error_increment = 2 * minor;
+    line->error_decrement = major ? error_decrement : 1;
+    line->first = first;
+    line->last = last;
+    line->length = major;
+
+    return true;
+}
+
+/**
+ * Advance line walk to next pixel.
+ */
+static inline void line_step(line_t* line) {
+    line->x += line->major_x;
+    line->y += line->major_y;
+    line->error += line->error_increment;
+
+    if (line->error >= line->error_decrement) {
+        line->error -= line->error_decrement;
+        line->x += line->minor_x;
+        line->y += line->minor_y;
+    }
+}
+
+void graphics_draw_line(texture_t* destination, int x0, int y0, int x1, int y1, color_t color) {
+    if (color == transparent_color) return;
+
+    rect_t bounds;
+    if (!drawable_bounds_get(destination, &bounds)) return;
+
+    // Horizontal lines are a single span
+    if (y0 == y1) {
+        fill_span(destination, &bounds, x0, x1, y0, color);
+        return;
+    }
+
+    // Vertical lines walk down the column by stride
+    if (x0 == x1) {
+        if (x0 < bounds.x || x0 >= bounds.x + bounds.width) return;
+
+        int top = MAX(MIN(y0, y1), bounds.y);
+        int bottom = MIN(MAX(y0, y1), bounds.y + bounds.height - 1);
+
+        color_t* pixel = destination->pixels + top * destination->stride + x0;
+        const color_t* blend = blend_table ? blend_table->colors[color] : NULL;
+
+        for (int y = top; y <= bottom; y++) {
+            *pixel = blend ? blend[*pixel] : color;
+            pixel += destination->stride;
+        }
+
+        return;
+    }
+
+    line_t line;
+    if (!line_clip(&line, &bounds, x0, y0, x1, y1)) return;
+
+    const blend_table_t* blend = blend_table;
+
+    for (int i = line.first; i <= line.last; i++) {
+        pixel_put(destination, blend, line.x, line.y, color);
+        line_step(&line);
+    }
+}
+
+void graphics_draw_pattern_line(texture_t* destination, int x0, int y0, int x1, int y1, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    pattern_t fill;
+    if (!pattern_init(&fill, pattern, pattern_offset_x, pattern_offset_y)) return;
+
+    rect_t bounds;
+    if (!drawable_bounds_get(destination, &bounds)) return;
+
+    // Horizontal lines are a single span
+    if (y0 == y1) {
+        pattern_span(destination, &bounds, x0, x1, y0, &fill);
+        return;
+    }
+
+    line_t line;
+    if (!line_clip(&line, &bounds, x0, y0, x1, y1)) return;
+
+    for (int i = line.first; i <= line.last; i++) {
+        pattern_pixel_set(destination, &bounds, true, line.x, line.y, &fill);
+        line_step(&line);
+    }
+}
+
+void graphics_draw_textured_line(texture_t* destination, int x0, int y0, float u0, float v0, int x1, int y1, float u1, float v1, texture_t* texture_map) {
+    rect_t bounds;
+    if (!drawable_bounds_get(destination, &bounds)) return;
+
+    line_t line;
+    if (!line_clip(&line, &bounds, x0, y0, x1, y1)) return;
+
+    float texture_width = graphics_texture_width_get(texture_map) - 1;
+    float texture_height = graphics_texture_height_get(texture_map) - 1;
+
+    // Convert uv-coordinates to st-coordinates
+    float s0 = u0 * texture_width;
+    float t0 = v0 * texture_height;
+    float s1 = u1 * texture_width;
+    float t1 = v1 * texture_height;
+
+    float delta_s = s1 - s0;
+    float delta_t = t1 - t0;
+    float st_longest_side = fmax(fabs(delta_s), fabs(delta_t));
+
+    // Length of longest side in terms of pixels.
+    float st_distance_pixels = st_longest_side + 1;
+    float xy_distance_pixels = line.length + 1;
+
+    // Calculate ratio of st-coordinates to xy-coordinates.
+    float ratio = st_distance_pixels / xy_distance_pixels;
+
+    float s_inc = st_longest_side == 0 ? 0 : delta_s / st_longest_side * ratio;
+    float t_inc = st_longest_side == 0 ? 0 : delta_t / st_longest_side * ratio;
+
+    // Sample texture at pixel centers
+    float s_scaled_pixel_center = delta_s == 0 ? 0.5f : 0.5f * ratio;
+    float t_scaled_pixel_center = delta_t == 0 ? 0.5f : 0.5f * ratio;
+    s0 += s_scaled_pixel_center;
+    t0 += t_scaled_pixel_center;
+
+    // Step from the line start so sampling doesn't depend on clipping
+    for (int i = line.first; i <= line.last; i++) {
+        float current_s = s0 + s_inc * i;
+        float current_t = t0 + t_inc * i;
+
+        if (current_s >= 0 && current_t >= 0) {
+            int s = current_s;
+            int t = current_t;
+            color_t c = graphics_texture_pixel_get(texture_map, s, t);
+
+            if (c != transparent_color) {
+                pixel_put(destination, blend_table, line.x, line.y, c);
+            }
+        }
+
+        line_step(&line);
+    }
+}
+
+// Farthest a curve may stray from the segments approximating it, in pixels
+#define CURVE_TOLERANCE 0.25
+
+// Curves are never split into more segments than this. Only reached by
+// curves much larger than any texture.
+#define CURVE_MAX_SEGMENTS 4096
+
+/**
+ * Connected line segments drawn one after another with either a color or a
+ * pattern. Each segment starts where the previous one ended, and the shared
+ * joint pixel is only drawn once so blended strokes don't double up.
+ */
+typedef struct {
+    texture_t* destination;
+    rect_t bounds;
+    const blend_table_t* blend;
+    color_t color;
+    pattern_t* pattern;
+
+    // Current point and whether its pixel has been drawn
+    int x;
+    int y;
+    bool drawn;
+} stroke_t;
+
+/**
+ * Prepare stroke for drawing.
+ *
+ * @param pattern Pattern to draw with, NULL to draw with color
+ * @return true if anything can be drawn, false otherwise
+ */
+static bool stroke_init(stroke_t* stroke, texture_t* destination, color_t color, pattern_t* pattern) {
+    if (!pattern && color == transparent_color) return false;
+    if (!drawable_bounds_get(destination, &stroke->bounds)) return false;
+
+    stroke->destination = destination;
+    stroke->blend = blend_table;
+    stroke->color = color;
+    stroke->pattern = pattern;
+    stroke->x = 0;
+    stroke->y = 0;
+    stroke->drawn = false;
+
+    return true;
+}
+
+/**
+ * Draw segment from x0, y0 to x1, y1, leaving out either end if asked.
+ */
+static void stroke_segment(stroke_t* stroke, int x0, int y0, int x1, int y1, bool skip_first, bool skip_last) {
+    texture_t* destination = stroke->destination;
+    rect_t* bounds = &stroke->bounds;
+
+    // Horizontal segments are a single span
+    if (y0 == y1 && x0 != x1) {
+        int step = x1 > x0 ? 1 : -1;
+        if (skip_first) x0 += step;
+        if (skip_last) x1 -= step;
+        if ((int64_t)(x1 - x0) * step < 0) return;
+
+        if (stroke->pattern) pattern_span(destination, bounds, x0, x1, y0, stroke->pattern);
+        else fill_span(destination, bounds, x0, x1, y0, stroke->color);
+
+        return;
+    }
+
+    line_t line;
+    if (!line_clip(&line, bounds, x0, y0, x1, y1)) return;
+
+    if (skip_first && line.first == 0) {
+        line_step(&line);
+        line.first++;
+    }
+
+    if (skip_last && line.last == line.length) line.last--;
+
+    if (stroke->pattern) {
+        for (int i = line.first; i <= line.last; i++) {
+            pattern_pixel_set(destination, bounds, true, line.x, line.y, stroke->pattern);
+            line_step(&line);
+        }
+
+        return;
+    }
+
+    const blend_table_t* blend = stroke->blend;
+    color_t color = stroke->color;
+
+    for (int i = line.first; i <= line.last; i++) {
+        pixel_put(destination, blend, line.x, line.y, color);
+        line_step(&line);
+    }
+}
+
+/**
+ * Start a new stroke at given point without drawing anything.
+ */
+static inline void stroke_move(stroke_t* stroke, int x, int y) {
+    stroke->x = x;
+    stroke->y = y;
+    stroke->drawn = false;
+}
+
+/**
+ * Draw segment from current point to given point, which becomes the current
+ * point. Repeated points draw nothing unless the current point hasn't been
+ * drawn yet.
+ *
+ * @param end_drawn Whether the end pixel was already drawn by this stroke
+ */
+static void stroke_to(stroke_t* stroke, int x, int y, bool end_drawn) {
+    if (x == stroke->x && y == stroke->y) {
+        if (!stroke->drawn && !end_drawn) stroke_segment(stroke, x, y, x, y, false, false);
+        stroke->drawn = true;
+        return;
+    }
+
+    stroke_segment(stroke, stroke->x, stroke->y, x, y, stroke->drawn, end_drawn);
+
+    stroke->x = x;
+    stroke->y = y;
+    stroke->drawn = true;
+}
+
+/**
+ * Draw polyline through given points, optionally closing it back to the
+ * first point.
+ */
+static void stroke_polyline(stroke_t* stroke, const int* points, int count, bool closed) {
+    if (!points || count <= 0) return;
+
+    stroke_move(stroke, points[0], points[1]);
+
+    for (int i = 1; i < count; i++) {
+        stroke_to(stroke, points[i * 2], points[i * 2 + 1], false);
+    }
+
+    // Single points are drawn as a pixel
+    if (closed || count == 1) {
+        stroke_to(stroke, points[0], points[1], closed && count > 1);
+    }
+}
+
+/**
+ * Get number of segments keeping a curve within tolerance. Segments of
+ * parameter length 1 / n stay within M / (8 * n^2) of a curve whose second
+ * derivative is at most M in length.
+ *
+ * @param second_derivative Upper bound of second derivative length
+ */
+static int curve_segments_get(double second_derivative) {
+    double segments = ceil(sqrt(second_derivative / (8.0 * CURVE_TOLERANCE)));
+
+    if (segments < 1) return 1;
+    if (segments > CURVE_MAX_SEGMENTS) return CURVE_MAX_SEGMENTS;
+
+    return segments;
+}
+
+/**
+ * Determine if the bounding box of given points misses the drawable region.
+ * Curves lie inside the box of their control points.
+ */
+static bool curve_outside(stroke_t* stroke, const int* points, int count) {
+    int code = ~0;
+
+    for (int i = 0; i < count; i++) {
+        code &= outcode_get(&stroke->bounds, points[i * 2], points[i * 2 + 1]);
+    }
+
+    return code != 0;
+}
+
+/**
+ * Continue stroke to curve start, or start a new stroke there if the curve
+ * doesn't join the previous one.
+ */
+static inline void curve_begin(stroke_t* stroke, const int* points, bool first) {
+    if (first || points[0] != stroke->x || points[1] != stroke->y) {
+        stroke_move(stroke, points[0], points[1]);
+    }
+}
+
+/**
+ * Draw quadratic curve from the current point by forward differencing. The
+ * curve is split into enough segments to stay within tolerance, so flat
+ * curves take a single segment.
+ *
+ * @param points Anchor, control and anchor point
+ */
+static void stroke_quadratic(stroke_t* stroke, const int* points) {
+    if (curve_outside(stroke, points, 3)) {
+        stroke_move(stroke, points[4], points[5]);
+        return;
+    }
+
+    // B(t) = a * t^2 + b * t + p0
+    double ax = (double)points[0] - 2.0 * points[2] + points[4];
+    double ay = (double)points[1] - 2.0 * points[3] + points[5];
+    double bx = 2.0 * ((double)points[2] - points[0]);
+    double by = 2.0 * ((double)points[3] - points[1]);
+
+    int segments = curve_segments_get(2.0 * sqrt(ax * ax + ay * ay));
+    double h = 1.0 / segments;
+
+    double x = points[0];
+    double y = points[1];
+    double dx = ax * h * h + bx * h;
+    double dy = ay * h * h + by * h;
+    double ddx = 2.0 * ax * h * h;
+    double ddy = 2.0 * ay * h * h;
+
+    for (int i = 1; i < segments; i++) {
+        x += dx;
+        y += dy;
+        dx += ddx;
+        dy += ddy;
+
+        stroke_to(stroke, floor(x + 0.5), floor(y + 0.5), false);
+    }
+
+    // End exactly on the anchor whatever rounding built up
+    stroke_to(stroke, points[4], points[5], false);
+}
+
+/**
+ * Draw cubic curve from the current point by forward differencing. The
+ * curve is split into enough segments to stay within tolerance, so flat
+ * curves take a single segment.
+ *
+ * @param points Anchor, two control and anchor point
+ */
+static void stroke_cubic(stroke_t* stroke, const int* points) {
+    if (curve_outside(stroke, points, 4)) {
+        stroke_move(stroke, points[6], points[7]);
+        return;
+    }
+
+    double x0 = points[0], y0 = points[1];
+    double x1 = points[2], y1 = points[3];
+    double x2 = points[4], y2 = points[5];
+    double x3 = points[6], y3 = points[7];
+
+    // Second derivative is largest at an end, 6 times a second difference
+    double ex0 = x0 - 2.0 * x1 + x2;
+    double ey0 = y0 - 2.0 * y1 + y2;
+    double ex1 = x1 - 2.0 * x2 + x3;
+    double ey1 = y1 - 2.0 * y2 + y3;
+    double second_difference = sqrt(MAX(ex0 * ex0 + ey0 * ey0, ex1 * ex1 + ey1 * ey1));
+
+    int segments = curve_segments_get(6.0 * second_difference);
+    double h = 1.0 / segments;
+    double h2 = h * h;
+    double h3 = h2 * h;
+
+    // B(t) = a * t^3 + b * t^2 + c * t + p0
+    double ax = -x0 + 3.0 * x1 - 3.0 * x2 + x3;
+    double ay = -y0 + 3.0 * y1 - 3.0 * y2 + y3;
+    double bx = 3.0 * ex0;
+    double by = 3.0 * ey0;
+    double cx = 3.0 * (x1 - x0);
+    double cy = 3.0 * (y1 - y0);
+
+    double x = x0;
+    double y = y0;
+    double dx = ax * h3 + bx * h2 + cx * h;
+    double dy = ay * h3 + by * h2 + cy * h;
+    double ddx = 6.0 * ax * h3 + 2.0 * bx * h2;
+    double ddy = 6.0 * ay * h3 + 2.0 * by * h2;
+    double dddx = 6.0 * ax * h3;
+    double dddy = 6.0 * ay * h3;
+
+    for (int i = 1; i < segments; i++) {
+        x += dx;
+        y += dy;
+        dx += ddx;
+        dy += ddy;
+        ddx += dddx;
+        ddy += dddy;
+
+        stroke_to(stroke, floor(x + 0.5), floor(y + 0.5), false);
+    }
+
+    // End exactly on the anchor whatever rounding built up
+    stroke_to(stroke, points[6], points[7], false);
+}
+
+/**
+ * Draw list of curves. Curves starting where the previous one ended are
+ * joined into one stroke.
+ *
+ * @param points Control points, degree + 1 per curve
+ * @param count Number of points. Leftover points are ignored.
+ * @param degree 2 for quadratic or 3 for cubic curves
+ */
+static void stroke_curves(stroke_t* stroke, const int* points, int count, int degree) {
+    if (!points) return;
+
+    for (int i = 0; i + degree < count; i += degree + 1) {
+        const int* curve = points + i * 2;
+        curve_begin(stroke, curve, i == 0);
+
+        if (degree == 2) stroke_quadratic(stroke, curve);
+        else stroke_cubic(stroke, curve);
+    }
+}
+
+void graphics_draw_polyline(texture_t* destination, const int* points, int count, color_t color) {
+    stroke_t stroke;
+    if (!stroke_init(&stroke, destination, color, NULL)) return;
+
+    stroke_polyline(&stroke, points, count, false);
+}
+
+void graphics_draw_pattern_polyline(texture_t* destination, const int* points, int count, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    pattern_t fill;
+    if (!pattern_init(&fill, pattern, pattern_offset_x, pattern_offset_y)) return;
+
+    stroke_t stroke;
+    if (!stroke_init(&stroke, destination, 0, &fill)) return;
+
+    stroke_polyline(&stroke, points, count, false);
+}
+
+void graphics_draw_quadratic_bezier(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, color_t color) {
+    int points[] = {x0, y0, x1, y1, x2, y2};
+    graphics_draw_quadratic_beziers(destination, points, 3, color);
+}
+
+void graphics_draw_pattern_quadratic_bezier(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    int points[] = {x0, y0, x1, y1, x2, y2};
+    graphics_draw_pattern_quadratic_beziers(destination, points, 3, pattern, pattern_offset_x, pattern_offset_y);
+}
+
+void graphics_draw_quadratic_beziers(texture_t* destination, const int* points, int count, color_t color) {
+    stroke_t stroke;
+    if (!stroke_init(&stroke, destination, color, NULL)) return;
+
+    stroke_curves(&stroke, points, count, 2);
+}
+
+void graphics_draw_pattern_quadratic_beziers(texture_t* destination, const int* points, int count, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    pattern_t fill;
+    if (!pattern_init(&fill, pattern, pattern_offset_x, pattern_offset_y)) return;
+
+    stroke_t stroke;
+    if (!stroke_init(&stroke, destination, 0, &fill)) return;
+
+    stroke_curves(&stroke, points, count, 2);
+}
+
+void graphics_draw_bezier(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3, color_t color) {
+    int points[] = {x0, y0, x1, y1, x2, y2, x3, y3};
+    graphics_draw_beziers(destination, points, 4, color);
+}
+
+void graphics_draw_pattern_bezier(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    int points[] = {x0, y0, x1, y1, x2, y2, x3, y3};
+    graphics_draw_pattern_beziers(destination, points, 4, pattern, pattern_offset_x, pattern_offset_y);
+}
+
+void graphics_draw_beziers(texture_t* destination, const int* points, int count, color_t color) {
+    stroke_t stroke;
+    if (!stroke_init(&stroke, destination, color, NULL)) return;
+
+    stroke_curves(&stroke, points, count, 3);
+}
+
+void graphics_draw_pattern_beziers(texture_t* destination, const int* points, int count, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    pattern_t fill;
+    if (!pattern_init(&fill, pattern, pattern_offset_x, pattern_offset_y)) return;
+
+    stroke_t stroke;
+    if (!stroke_init(&stroke, destination, 0, &fill)) return;
+
+    stroke_curves(&stroke, points, count, 3);
+}
+
+void graphics_draw_rectangle(texture_t* destination, int x, int y, int width, int height, color_t color) {
+    // Drawn as one shape so corners aren't drawn twice
+    graphics_draw_rounded_rectangle(destination, x, y, width, height, 0, color);
+}
+
+void graphics_draw_pattern_rectangle(texture_t* destination, int x, int y, int width, int height, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    graphics_draw_pattern_rounded_rectangle(destination, x, y, width, height, 0, pattern, pattern_offset_x, pattern_offset_y);
+}
+
+void graphics_draw_filled_rectangle(texture_t* destination, int x, int y, int width, int height, color_t color) {
+    if (color == transparent_color) return;
+
+    rect_t bounds;
+    if (!drawable_bounds_get(destination, &bounds)) return;
+
+    // Clip rectangle to drawable region
+    int x0 = x > bounds.x ? x : bounds.x;
+    int y0 = y > bounds.y ? y : bounds.y;
+    int x1 = x + width;
+    int y1 = y + height;
+
+    if (x1 > bounds.x + bounds.width) x1 = bounds.x + bounds.width;
+    if (y1 > bounds.y + bounds.height) y1 = bounds.y + bounds.height;
+
+    if (x0 >= x1 || y0 >= y1) return;
+
+    size_t size = x1 - x0;
+    color_t* row = destination->pixels + y0 * destination->stride + x0;
+
+    for (int i = y0; i < y1; i++) {
+        row_fill(row, size, color);
+        row += destination->stride;
+    }
+}
+
+void graphics_draw_filled_pattern_rectangle(texture_t* destination, int x, int y, int width, int height, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    pattern_t fill;
+    if (!pattern_init(&fill, pattern, pattern_offset_x, pattern_offset_y)) return;
+
+    rect_t bounds;
+    if (!drawable_bounds_get(destination, &bounds)) return;
+
+    int x0 = x;
+    int x1 = x + width - 1;
+
+    // Only visit rows inside the drawable region
+    int y0 = MAX(y, bounds.y);
+    int y1 = MIN(y + height, bounds.y + bounds.height);
+
+    for (int i = y0; i < y1; i++) {
+        pattern_span(destination, &bounds, x0, x1, i, &fill);
+    }
+}
+
+/**
+ * Row of a flood fill waiting to be searched. Row y is searched for target
+ * pixels from x0 to x1, having been reached by moving dy rows.
+ */
+typedef struct {
+    int x0;
+    int x1;
+    int y;
+    int dy;
+} flood_span_t;
+
+// Number of pending rows kept on the stack before moving to the heap
+#define FLOOD_STACK_SPANS 256
+
+typedef struct {
+    texture_t* destination;
+    rect_t bounds;
+    color_t target;
+    color_t color;
+    pattern_t* pattern;
+
+    // One bit per pixel of the drawable region, set once filled. Only used
+    // when filled pixels can still match the target color.
+    uint8_t* filled;
+
+    flood_span_t* spans;
+    int span_count;
+    int span_capacity;
+    bool heap;
+} flood_t;
+
+static bool flood_push(flood_t* flood, int x0, int x1, int y, int dy) {
+    // Rows outside the drawable region have nothing to fill
+    if (y < flood->bounds.y || y >= flood->bounds.y + flood->bounds.height) return true;
+
+    if (flood->span_count == flood->span_capacity) {
+        int capacity = flood->span_capacity * 2;
+        flood_span_t* spans = flood->heap ? realloc(flood->spans, capacity * sizeof(flood_span_t)) : malloc(capacity * sizeof(flood_span_t));
+        if (!spans) return false;
+
+        if (!flood->heap) memcpy(spans, flood->spans, flood->span_count * sizeof(flood_span_t));
+
+        flood->spans = spans;
+        flood->span_capacity = capacity;
+        flood->heap = true;
+    }
+
+    flood->spans[flood->span_count++] = (flood_span_t){x0, x1, y, dy};
+
+    return true;
+}
+
+/**
+ * Determine if pixel is part of the region and not yet filled.
+ */
+static inline bool flood_inside(flood_t* flood, int x, int y) {
+    if (!bounds_contains(&flood->bounds, x, y)) return false;
+    if (flood->destination->pixels[y * flood->destination->stride + x] != flood->target) return false;
+    if (!flood->filled) return true;
+
+    size_t bit = (size_t)(y - flood->bounds.y) * flood->bounds.width + (x - flood->bounds.x);
+
+    return !(flood->filled[bit >> 3] & (1 << (bit & 7)));
+}
+
+static void flood_span_fill(flood_t* flood, int x0, int x1, int y) {
+    if (flood->pattern) pattern_span(flood->destination, &flood->bounds, x0, x1, y, flood->pattern);
+    else fill_span(flood->destination, &flood->bounds, x0, x1, y, flood->color);
+
+    if (!flood->filled) return;
+
+    size_t row = (size_t)(y - flood->bounds.y) * flood->bounds.width - flood->bounds.x;
+
+    for (int x = x0; x <= x1; x++) {
+        size_t bit = row + x;
+        flood->filled[bit >> 3] |= 1 << (bit & 7);
+    }
+}
+
+/**
+ * Fill region connected to x, y with span filling. Each popped row is
+ * searched for runs of target pixels, which are filled as whole spans, and
+ * the rows above and below the runs are pushed. Only the parts of a run
+ * hanging over the row it was reached from are searched again in that
+ * direction.
+ */
+static void flood_fill(flood_t* flood, int x, int y) {
+    flood_span_t storage[FLOOD_STACK_SPANS];
+    flood->spans = storage;
+    flood->span_count = 0;
+    flood->span_capacity = FLOOD_STACK_SPANS;
+    flood->heap = false;
+
+    bool pushed = flood_push(flood, x, x, y, 1) && flood_push(flood, x, x, y - 1, -1);
+
+    while (pushed && flood->span_count > 0) {
+        flood_span_t span = flood->spans[--flood->span_count];
+        int x0 = span.x0;
+        int x1 = span.x1;
+        int y = span.y;
+        int dy = span.dy;
+
+        // Runs starting left of the span spill back toward the previous row
+        int start = x0;
+
+        if (flood_inside(flood, start, y)) {
+            while (flood_inside(flood, start - 1, y)) start--;
+
+            if (start < x0) pushed &= flood_push(flood, start, x0 - 1, y - dy, -dy);
+        }
+
+        while (x0 <= x1) {
+            while (flood_inside(flood, x0, y)) x0++;
+
+            if (x0 > start) {
+                flood_span_fill(flood, start, x0 - 1, y);
+                pushed &= flood_push(flood, start, x0 - 1, y + dy, dy);
+
+                if (x0 - 1 > x1) pushed &= flood_push(flood, x1 + 1, x0 - 1, y - dy, -dy);
+            }
+
+            x0++;
+            while (x0 < x1 && !flood_inside(flood, x0, y)) x0++;
+            start = x0;
+        }
+    }
+
+    if (flood->heap) free(flood->spans);
+}
+
+/**
+ * Set up flood fill of region connected to x, y and fill it.
+ *
+ * @param pattern Pattern to fill with, NULL to fill with color
+ */
+static void flood_draw(texture_t* destination, int x, int y, color_t color, pattern_t* pattern) {
+    flood_t flood;
+    if (!drawable_bounds_get(destination, &flood.bounds)) return;
+    if (!bounds_contains(&flood.bounds, x, y)) return;
+
+    flood.destination = destination;
+    flood.target = destination->pixels[y * destination->stride + x];
+    flood.color = color;
+    flood.pattern = pattern;
+    flood.filled = NULL;
+
+    // Filled pixels stop matching the target when written with another
+    // color. Otherwise filled pixels have to be remembered.
+    if (pattern || blend_table) {
+        flood.filled = calloc(((size_t)flood.bounds.width * flood.bounds.height + 7) / 8, 1);
+        if (!flood.filled) return;
+    }
+    else if (color == flood.target) {
+        return;
+    }
+
+    flood_fill(&flood, x, y);
+
+    free(flood.filled);
+}
+
+void graphics_draw_flood_fill(texture_t* destination, int x, int y, color_t color) {
+    if (color == transparent_color) return;
+
+    flood_draw(destination, x, y, color, NULL);
+}
+
+void graphics_draw_pattern_flood_fill(texture_t* destination, int x, int y, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    pattern_t fill;
+    if (!pattern_init(&fill, pattern, pattern_offset_x, pattern_offset_y)) return;
+
+    flood_draw(destination, x, y, 0, &fill);
+}
+
+/**
+ * Color or pattern that shapes are filled with one span at a time.
+ */
+typedef struct {
+    texture_t* destination;
+    rect_t bounds;
+    const blend_table_t* blend;
+    color_t color;
+    pattern_t* pattern;
+} brush_t;
+
+/**
+ * Prepare brush for drawing.
+ *
+ * @param pattern Pattern to draw with, NULL to draw with color
+ * @return true if anything can be drawn, false otherwise
+ */
+static bool brush_init(brush_t* brush, texture_t* destination, color_t color, pattern_t* pattern) {
+    if (!pattern && color == transparent_color) return false;
+    if (!drawable_bounds_get(destination, &brush->bounds)) return false;
+
+    brush->destination = destination;
+    brush->blend = blend_table;
+    brush->color = color;
+    brush->pattern = pattern;
+
+    return true;
+}
+
+/**
+ * Fill span from x0 to x1 inclusive. Coordinates may be past the range of
+ * int, as only the part inside the drawable region is drawn. Outlines are
+ * mostly spans of a few pixels, so those are written directly.
+ */
+static inline void brush_span(brush_t* brush, int64_t x0, int64_t x1, int64_t y) {
+    rect_t* bounds = &brush->bounds;
+
+    if (y < bounds->y || y >= bounds->y + bounds->height) return;
+
+    x0 = MAX(x0, bounds->x);
+    x1 = MIN(x1, (int64_t)bounds->x + bounds->width - 1);
+    if (x0 > x1) return;
+
+    if (brush->pattern) {
+        pattern_span(brush->destination, bounds, x0, x1, y, brush->pattern);
+        return;
+    }
+
+    color_t* row = brush->destination->pixels + (int)y * brush->destination->stride;
+    int count = x1 - x0 + 1;
+
+    if (brush->blend) {
+        const color_t* blend = brush->blend->colors[brush->color];
+
+        for (int x = x0; x <= x1; x++) {
+            row[x] = blend[row[x]];
+        }
+    }
+    else if (count <= 8) {
+        for (int x = x0; x <= x1; x++) {
+            row[x] = brush->color;
+        }
+    }
+    else {
+        memset(row + x0, brush->color, count);
+    }
+}
+
+/**
+ * Draw single pixel.
+ *
+ * @param inside True if pixel is known to be inside the drawable region
+ */
+static inline void brush_pixel(brush_t* brush, bool inside, int x, int y) {
+    if (!inside && !bounds_contains(&brush->bounds, x, y)) return;
+
+    if (brush->pattern) pattern_pixel_set(brush->destination, &brush->bounds, true, x, y, brush->pattern);
+    else pixel_put(brush->destination, brush->blend, x, y, brush->color);
+}
+
+/**
+ * Fill column at x from y0 to y1 inclusive. Rows must be inside the
+ * drawable region.
+ */
+static void brush_column(brush_t* brush, int64_t x, int64_t y0, int64_t y1) {
+    rect_t* bounds = &brush->bounds;
+    if (x < bounds->x || x >= (int64_t)bounds->x + bounds->width) return;
+
+    for (int64_t y = y0; y <= y1; y++) {
+        brush_pixel(brush, true, x, y);
+    }
+}
+
+/**
+ * Part of a circle between two angles. Angles are in radians and go
+ * clockwise from the positive x-axis, as y points down.
+ */
+typedef struct {
+    double start_x;
+    double start_y;
+    double end_x;
+    double end_y;
+    bool full;
+
+    // Sectors over half a turn are the union of two half-planes through the
+    // center rather than their intersection
+    bool wide;
+} sector_t;
+
+#define SECTOR_HALF_TURN 3.14159265358979323846
+
+/**
+ * Prepare sector from start angle clockwise to end angle.
+ *
+ * @return true if sector covers anything, false otherwise
+ */
+static bool sector_init(sector_t* sector, float start_angle, float end_angle) {
+    double sweep = (double)end_angle - start_angle;
+
+    if (sweep >= 2 * SECTOR_HALF_TURN) {
+        sector->full = true;
+        return true;
+    }
+
+    // Angles wrap, so an end angle before the start goes round the other way
+    sweep = fmod(sweep, 2 * SECTOR_HALF_TURN);
+    if (sweep < 0) sweep += 2 * SECTOR_HALF_TURN;
+    if (!(sweep > 0)) return false;
+
+    sector->full = false;
+
+    sector->start_x = cos(start_angle);
+    sector->start_y = sin(start_angle);
+    sector->end_x = cos(end_angle);
+    sector->end_y = sin(end_angle);
+    sector->wide = sweep > SECTOR_HALF_TURN;
+
+    return true;
+}
+
+// Offset standing in for an unbounded end of a range. Far past any texture
+// but small enough to add coordinates to.
+#define SECTOR_UNBOUNDED ((int64_t)1 << 40)
+
+/**
+ * Get range of x offsets on row dy inside half-plane a * dx + b * dy >= 0.
+ * Empty ranges have lo greater than hi.
+ */
+static void half_plane_range(double a, double b, int64_t dy, int64_t* lo, int64_t* hi) {
+    double c = -b * dy;
+
+    *lo = -SECTOR_UNBOUNDED;
+    *hi = SECTOR_UNBOUNDED;
+
+    if (a > 0) {
+        double limit = ceil(c / a);
+        if (limit > *lo) *lo = MIN(limit, (double)SECTOR_UNBOUNDED);
+    }
+    else if (a < 0) {
+        double limit = floor(c / a);
+        if (limit < *hi) *hi = MAX(limit, (double)-SECTOR_UNBOUNDED);
+    }
+    else if (c > 0) {
+        *lo = 1;
+        *hi = 0;
+    }
+}
+
+/**
+ * Fill the part of a span inside sector centered on cx, cy. NULL sectors
+ * fill the whole span.
+ */
+static void sector_span(sector_t* sector, brush_t* brush, int64_t cx, int64_t cy, int64_t x0, int64_t x1, int64_t y) {
+    if (!sector || sector->full) {
+        brush_span(brush, x0, x1, y);
+        return;
+    }
+
+    int64_t dy = y - cy;
+    int64_t start_lo, start_hi, end_lo, end_hi;
+
+    // Clockwise of the start direction and counter-clockwise of the end
+    half_plane_range(-sector->start_y, sector->start_x, dy, &start_lo, &start_hi);
+    half_plane_range(sector->end_y, -sector->end_x, dy, &end_lo, &end_hi);
+
+    if (!sector->wide) {
+        int64_t lo = MAX(x0, cx + MAX(start_lo, end_lo));
+        int64_t hi = MIN(x1, cx + MIN(start_hi, end_hi));
+
+        if (lo <= hi) brush_span(brush, lo, hi, y);
+        return;
+    }
+
+    int64_t a0 = MAX(x0, cx + start_lo);
+    int64_t a1 = MIN(x1, cx + start_hi);
+    int64_t b0 = MAX(x0, cx + end_lo);
+    int64_t b1 = MIN(x1, cx + end_hi);
+
+    if (a0 > a1) {
+        if (b0 <= b1) brush_span(brush, b0, b1, y);
+    }
+    else if (b0 > b1) {
+        brush_span(brush, a0, a1, y);
+    }
+    else if (a0 <= b1 + 1 && b0 <= a1 + 1) {
+        // Overlapping parts are only drawn once
+        brush_span(brush, MIN(a0, b0), MAX(a1, b1), y);
+    }
+    else {
+        brush_span(brush, a0, a1, y);
+        brush_span(brush, b0, b1, y);
+    }
+}
+
+// Rows of round shape widths kept on the stack before moving to the heap
+#define ROUND_STACK_ROWS 512
+
+/**
+ * Shape made of four quarter curves around a central rectangle, drawn one
+ * row at a time so every pixel is written once. Circles and ellipses have a
+ * single center pixel and rounded rectangles stretch it to straight edges.
+ *
+ * Row d above the top center or below the bottom center reaches widths[d]
+ * pixels past the left and right centers, and rows between the centers
+ * reach widths[0]. Only widths of rows in the drawable region are kept.
+ */
+typedef struct {
+    int64_t left;
+    int64_t top;
+    int64_t right;
+    int64_t bottom;
+    int radius_y;
+
+    // Range of rows d kept in widths
+    int64_t first;
+    int64_t last;
+    int* widths;
+    int storage[ROUND_STACK_ROWS];
+} round_t;
+
+/**
+ * Add rows from lo to hi to the range of rows kept.
+ */
+static void round_rows_add(round_t* round, int64_t lo, int64_t hi) {
+    lo = MAX(lo, 0);
+    hi = MIN(hi, round->radius_y);
+    if (lo > hi) return;
+
+    round->first = MIN(round->first, lo);
+    round->last = MAX(round->last, hi);
+}
+
+/**
+ * Set up shape around given centers with all widths unset.
+ *
+ * @return true if successful, false otherwise
+ */
+static bool round_init(round_t* round, rect_t* bounds, int64_t left, int64_t top, int64_t right, int64_t bottom, int radius_y) {
+    round->left = left;
+    round->top = top;
+    round->right = right;
+    round->bottom = bottom;
+    round->radius_y = radius_y;
+    round->first = INT64_MAX;
+    round->last = -1;
+    round->widths = round->storage;
+
+    int64_t view_top = bounds->y;
+    int64_t view_bottom = (int64_t)bounds->y + bounds->height - 1;
+
+    round_rows_add(round, top - view_bottom, top - view_top);
+    round_rows_add(round, view_top - bottom, view_bottom - bottom);
+
+    if (top <= view_bottom && bottom >= view_top) {
+        round_rows_add(round, 0, 0);
+    }
+
+    if (round->first > round->last) return true;
+
+    // Outlines look at the row past each one, which is left unset past the
+    // radius
+    round->last++;
+
+    size_t count = round->last - round->first + 1;
+
+    if (count > ROUND_STACK_ROWS) {
+        round->widths = malloc(count * sizeof(int));
+        if (!round->widths) return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        round->widths[i] = -1;
+    }
+
+    return true;
+}
+
+static void round_free(round_t* round) {
+    if (round->widths != round->storage) free(round->widths);
+}
+
+static inline void round_width_set(round_t* round, int d, int width) {
+    if (d < round->first || d > round->last) return;
+
+    int* row = &round->widths[d - round->first];
+    if (width > *row) *row = width;
+}
+
+static inline int round_width_get(round_t* round, int64_t d) {
+    return round->widths[d - round->first];
+}
+
+/**
+ * Set widths for a circle, matching the pixels of the midpoint circle
+ * algorithm.
+ */
+static void round_circle_widths_set(round_t* round, int radius) {
+    int x = 0;
+    int y = radius;
+    int midpoint_criteria = 1 - radius;
+
+    round_width_set(round, y, x);
+    round_width_set(round, x, y);
+
+    while (x < y) {
+        // Mid-point on or inside radius
+        if (midpoint_criteria <= 0) {
+            midpoint_criteria += (x << 1) + 3;
+        }
+        // Mid-point outside radius
+        else {
+            midpoint_criteria += ((x - y) << 1) + 5;
+            y -= 1;
+        }
+        x++;
+
+        // Each step is a pixel in two octants
+        round_width_set(round, y, x);
+        round_width_set(round, x, y);
+    }
+}
+
+/**
+ * Set widths for an ellipse. Rows cover the pixels whose centers are in the
+ * ellipse half a pixel larger than the radii, which gives the same shape as
+ * the midpoint circle for most circles.
+ */
+static void round_ellipse_widths_set(round_t* round, int radius_x, int radius_y) {
+    int64_t last = MIN(round->last, radius_y);
+
+    for (int64_t d = round->first; d <= last; d++) {
+        double t = 2.0 * d / (2.0 * radius_y + 1);
+        round->widths[d - round->first] = floor((radius_x + 0.5) * sqrt(1 - t * t));
+    }
+}
+
+/**
+ * Fill span of a row of shape, clipped to sector if there is one.
+ */
+static inline void round_span(round_t* round, brush_t* brush, sector_t* sector, int64_t x0, int64_t x1, int64_t y) {
+    if (sector) sector_span(sector, brush, round->left, round->top, x0, x1, y);
+    else brush_span(brush, x0, x1, y);
+}
+
+/**
+ * Fill shape, optionally only inside sector around the left and top center.
+ */
+static void round_fill(round_t* round, brush_t* brush, sector_t* sector) {
+    rect_t* bounds = &brush->bounds;
+    int64_t view_top = bounds->y;
+    int64_t view_bottom = (int64_t)bounds->y + bounds->height - 1;
+
+    int64_t y0 = MAX(round->top - round->radius_y, view_top);
+    int64_t y1 = MIN(round->top, view_bottom);
+
+    for (int64_t y = y0; y <= y1; y++) {
+        int width = round_width_get(round, round->top - y);
+        round_span(round, brush, sector, round->left - width, round->right + width, y);
+    }
+
+    y0 = MAX(round->top + 1, view_top);
+    y1 = MIN(round->bottom + round->radius_y, view_bottom);
+
+    for (int64_t y = y0; y <= y1; y++) {
+        int width = round_width_get(round, y > round->bottom ? y - round->bottom : 0);
+        round_span(round, brush, sector, round->left - width, round->right + width, y);
+    }
+}
+
+/**
+ * Draw row d of a quarter curve, from just past the width of the next row
+ * out to its own width, so the outline is connected and no pixel is drawn
+ * twice. The outermost row runs across the middle.
+ */
+static inline void round_outline_row(round_t* round, brush_t* brush, sector_t* sector, int64_t y, int64_t d) {
+    int width = round_width_get(round, d);
+    int inner = MIN(round_width_get(round, d + 1) + 1, width);
+
+    int64_t left_end = round->left - inner;
+    int64_t right_start = round->right + inner;
+
+    if (d == round->radius_y || left_end + 1 >= right_start) {
+        round_span(round, brush, sector, round->left - width, round->right + width, y);
+    }
+    else {
+        round_span(round, brush, sector, round->left - width, left_end, y);
+        round_span(round, brush, sector, right_start, round->right + width, y);
+    }
+}
+
+/**
+ * Draw outline of shape, optionally only inside sector around the left and
+ * top center.
+ */
+static void round_outline(round_t* round, brush_t* brush, sector_t* sector) {
+    rect_t* bounds = &brush->bounds;
+    int64_t view_top = bounds->y;
+    int64_t view_bottom = (int64_t)bounds->y + bounds->height - 1;
+
+    int64_t y0 = MAX(round->top - round->radius_y, view_top);
+    int64_t y1 = MIN(round->top, view_bottom);
+
+    for (int64_t y = y0; y <= y1; y++) {
+        round_outline_row(round, brush, sector, y, round->top - y);
+    }
+
+    // Straight sides between the centers
+    y0 = MAX(round->top + 1, view_top);
+    y1 = MIN(round->bottom - 1, view_bottom);
+
+    if (y0 <= y1) {
+        int width = round_width_get(round, 0);
+        int64_t left = round->left - width;
+        int64_t right = round->right + width;
+
+        if (sector) {
+            for (int64_t y = y0; y <= y1; y++) {
+                sector_span(sector, brush, round->left, round->top, left, left, y);
+                if (right != left) sector_span(sector, brush, round->left, round->top, right, right, y);
+            }
+        }
+        else {
+            brush_column(brush, left, y0, y1);
+            if (right != left) brush_column(brush, right, y0, y1);
+        }
+    }
+
+    y0 = MAX(MAX(round->bottom, round->top + 1), view_top);
+    y1 = MIN(round->bottom + round->radius_y, view_bottom);
+
+    for (int64_t y = y0; y <= y1; y++) {
+        round_outline_row(round, brush, sector, y, y - round->bottom);
+    }
+}
+
+/**
+ * Draw the pixels mirroring x, y into all eight octants of a circle. Points
+ * on the axes and diagonals mirror onto themselves, so those are only drawn
+ * once.
+ */
+static inline void circle_points_draw(brush_t* brush, bool inside, int center_x, int center_y, int x, int y) {
+    if (x == 0) {
+        brush_pixel(brush, inside, center_x, center_y + y);
+        brush_pixel(brush, inside, center_x, center_y - y);
+        brush_pixel(brush, inside, center_x + y, center_y);
+        brush_pixel(brush, inside, center_x - y, center_y);
+        return;
+    }
+
+    brush_pixel(brush, inside, center_x + x, center_y + y);
+    brush_pixel(brush, inside, center_x - x, center_y + y);
+    brush_pixel(brush, inside, center_x + x, center_y - y);
+    brush_pixel(brush, inside, center_x - x, center_y - y);
+
+    if (x == y) return;
+
+    brush_pixel(brush, inside, center_x + y, center_y + x);
+    brush_pixel(brush, inside, center_x - y, center_y + x);
+    brush_pixel(brush, inside, center_x + y, center_y - x);
+    brush_pixel(brush, inside, center_x - y, center_y - x);
+}
+
+/**
+ * Draw circle outline with the midpoint circle algorithm, clipping each
+ * pixel unless the whole circle is inside the drawable region. Outlines
+ * are mostly single pixel runs, which are quicker to plot directly than
+ * row by row.
+ */
+static void circle_outline(brush_t* brush, int x, int y, int radius) {
+    clip_result_t clip = clip_test(&brush->bounds, x - radius, y - radius, x + radius, y + radius);
+    if (clip == CLIP_OUTSIDE) return;
+
+    bool inside = clip == CLIP_INSIDE;
+
+    int _x = 0;
+    int _y = radius;
+    int midpoint_criteria = 1 - radius;
+
+    circle_points_draw(brush, inside, x, y, _x, _y);
+
+    while (_x < _y) {
+        // Mid-point on or inside radius
+        if (midpoint_criteria <= 0) {
+            midpoint_criteria += (_x << 1) + 3;
+        }
+        // Mid-point outside radius
+        else {
+            midpoint_criteria += ((_x - _y) << 1) + 5;
+            _y -= 1;
+        }
+        _x++;
+
+        // Stepping past the diagonal mirrors the previous point
+        if (_x > _y) break;
+
+        circle_points_draw(brush, inside, x, y, _x, _y);
+    }
+}
+
+/**
+ * Fill the rows d above and below the center of a circle.
+ */
+static inline void circle_rows_fill(brush_t* brush, int center_x, int center_y, int d, int width) {
+    brush_span(brush, (int64_t)center_x - width, (int64_t)center_x + width, (int64_t)center_y + d);
+    if (d != 0) brush_span(brush, (int64_t)center_x - width, (int64_t)center_x + width, (int64_t)center_y - d);
+}
+
+/**
+ * Fill circle with the midpoint circle algorithm. Each step is the widest
+ * point of the row as far out as x, and rows closer to the top and bottom
+ * are finished once the curve steps in from them, so every row is filled
+ * exactly once.
+ */
+static void circle_fill(brush_t* brush, int x, int y, int radius) {
+    if (clip_test(&brush->bounds, x - radius, y - radius, x + radius, y + radius) == CLIP_OUTSIDE) return;
+
+    int _x = 0;
+    int _y = radius;
+    int midpoint_criteria = 1 - radius;
+
+    circle_rows_fill(brush, x, y, _x, _y);
+
+    while (_x < _y) {
+        // Mid-point on or inside radius
+        if (midpoint_criteria <= 0) {
+            midpoint_criteria += (_x << 1) + 3;
+        }
+        // Mid-point outside radius
+        else {
+            midpoint_criteria += ((_x - _y) << 1) + 5;
+            circle_rows_fill(brush, x, y, _y, _x);
+            _y -= 1;
+        }
+        _x++;
+
+        // Stepping past the diagonal mirrors the previous point
+        if (_x > _y) break;
+
+        circle_rows_fill(brush, x, y, _x, _y);
+    }
+}
+
+/**
+ * Draw circle or ellipse centered on x, y.
+ *
+ * @param filled Fill shape if true, draw outline otherwise
+ * @param sector Part of circle to draw, NULL for all of it
+ */
+static void ellipse_draw(brush_t* brush, int x, int y, int radius_x, int radius_y, bool filled, sector_t* sector) {
+    if (radius_x == radius_y && (!sector || sector->full)) {
+        if (filled) circle_fill(brush, x, y, radius_x);
+        else circle_outline(brush, x, y, radius_x);
+        return;
+    }
+
+    round_t round;
+    if (!round_init(&round, &brush->bounds, x, y, x, y, radius_y)) return;
+
+    if (radius_x == radius_y) round_circle_widths_set(&round, radius_x);
+    else round_ellipse_widths_set(&round, radius_x, radius_y);
+
+    if (filled) round_fill(&round, brush, sector);
+    else round_outline(&round, brush, sector);
+
+    round_free(&round);
+}
+
+/**
+ * Draw rectangle with corners rounded by quarter circles of given radius.
+ * The radius is limited to what fits in the rectangle.
+ *
+ * @param filled Fill shape if true, draw outline otherwise
+ */
+static void rounded_rectangle_draw(brush_t* brush, int x, int y, int width, int height, int radius, bool filled) {
+    if (width <= 0 || height <= 0) return;
+
+    radius = MAX(0, MIN(radius, (MIN(width, height) - 1) / 2));
+
+    int64_t left = (int64_t)x + radius;
+    int64_t top = (int64_t)y + radius;
+    int64_t right = (int64_t)x + width - 1 - radius;
+    int64_t bottom = (int64_t)y + height - 1 - radius;
+
+    round_t round;
+    if (!round_init(&round, &brush->bounds, left, top, right, bottom, radius)) return;
+
+    round_circle_widths_set(&round, radius);
+
+    if (filled) round_fill(&round, brush, NULL);
+    else round_outline(&round, brush, NULL);
+
+    round_free(&round);
+}
+
+void graphics_draw_circle(texture_t* destination, int x, int y, int radius, color_t color) {
+    if (radius <= 0) return;
+
+    brush_t brush;
+    if (!brush_init(&brush, destination, color, NULL)) return;
+
+    ellipse_draw(&brush, x, y, radius, radius, false, NULL);
+}
+
+void graphics_draw_pattern_circle(texture_t* destination, int x, int y, int radius, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    if (radius <= 0) return;
+
+    pattern_t fill;
+    if (!pattern_init(&fill, pattern, pattern_offset_x, pattern_offset_y)) return;
+
+    brush_t brush;
+    if (!brush_init(&brush, destination, 0, &fill)) return;
+
+    ellipse_draw(&brush, x, y, radius, radius, false, NULL);
+}
+
+void graphics_draw_filled_circle(texture_t* destination, int x, int y, int radius, color_t color) {
+    if (radius <= 0) return;
+
+    brush_t brush;
+    if (!brush_init(&brush, destination, color, NULL)) return;
+
+    ellipse_draw(&brush, x, y, radius, radius, true, NULL);
+}
+
+void graphics_draw_filled_pattern_circle(texture_t* destination, int x, int y, int radius, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    if (radius <= 0) return;
+
+    pattern_t fill;
+    if (!pattern_init(&fill, pattern, pattern_offset_x, pattern_offset_y)) return;
+
+    brush_t brush;
+    if (!brush_init(&brush, destination, 0, &fill)) return;
+
+    ellipse_draw(&brush, x, y, radius, radius, true, NULL);
+}
+
+void graphics_draw_ellipse(texture_t* destination, int x, int y, int radius_x, int radius_y, color_t color) {
+    if (radius_x <= 0 || radius_y <= 0) return;
+
+    brush_t brush;
+    if (!brush_init(&brush, destination, color, NULL)) return;
+
+    ellipse_draw(&brush, x, y, radius_x, radius_y, false, NULL);
+}
+
+void graphics_draw_pattern_ellipse(texture_t* destination, int x, int y, int radius_x, int radius_y, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    if (radius_x <= 0 || radius_y <= 0) return;
+
+    pattern_t fill;
+    if (!pattern_init(&fill, pattern, pattern_offset_x, pattern_offset_y)) return;
+
+    brush_t brush;
+    if (!brush_init(&brush, destination, 0, &fill)) return;
+
+    ellipse_draw(&brush, x, y, radius_x, radius_y, false, NULL);
+}
+
+void graphics_draw_filled_ellipse(texture_t* destination, int x, int y, int radius_x, int radius_y, color_t color) {
+    if (radius_x <= 0 || radius_y <= 0) return;
+
+    brush_t brush;
+    if (!brush_init(&brush, destination, color, NULL)) return;
+
+    ellipse_draw(&brush, x, y, radius_x, radius_y, true, NULL);
+}
+
+void graphics_draw_filled_pattern_ellipse(texture_t* destination, int x, int y, int radius_x, int radius_y, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    if (radius_x <= 0 || radius_y <= 0) return;
+
+    pattern_t fill;
+    if (!pattern_init(&fill, pattern, pattern_offset_x, pattern_offset_y)) return;
+
+    brush_t brush;
+    if (!brush_init(&brush, destination, 0, &fill)) return;
+
+    ellipse_draw(&brush, x, y, radius_x, radius_y, true, NULL);
+}
+
+void graphics_draw_arc(texture_t* destination, int x, int y, int radius, float start_angle, float end_angle, color_t color) {
+    if (radius <= 0) return;
+
+    sector_t sector;
+    if (!sector_init(&sector, start_angle, end_angle)) return;
+
+    brush_t brush;
+    if (!brush_init(&brush, destination, color, NULL)) return;
+
+    ellipse_draw(&brush, x, y, radius, radius, false, &sector);
+}
+
+void graphics_draw_pattern_arc(texture_t* destination, int x, int y, int radius, float start_angle, float end_angle, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    if (radius <= 0) return;
+
+    sector_t sector;
+    if (!sector_init(&sector, start_angle, end_angle)) return;
+
+    pattern_t fill;
+    if (!pattern_init(&fill, pattern, pattern_offset_x, pattern_offset_y)) return;
+
+    brush_t brush;
+    if (!brush_init(&brush, destination, 0, &fill)) return;
+
+    ellipse_draw(&brush, x, y, radius, radius, false, &sector);
+}
+
+void graphics_draw_filled_arc(texture_t* destination, int x, int y, int radius, float start_angle, float end_angle, color_t color) {
+    if (radius <= 0) return;
+
+    sector_t sector;
+    if (!sector_init(&sector, start_angle, end_angle)) return;
+
+    brush_t brush;
+    if (!brush_init(&brush, destination, color, NULL)) return;
+
+    ellipse_draw(&brush, x, y, radius, radius, true, &sector);
+}
+
+void graphics_draw_filled_pattern_arc(texture_t* destination, int x, int y, int radius, float start_angle, float end_angle, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    if (radius <= 0) return;
+
+    sector_t sector;
+    if (!sector_init(&sector, start_angle, end_angle)) return;
+
+    pattern_t fill;
+    if (!pattern_init(&fill, pattern, pattern_offset_x, pattern_offset_y)) return;
+
+    brush_t brush;
+    if (!brush_init(&brush, destination, 0, &fill)) return;
+
+    ellipse_draw(&brush, x, y, radius, radius, true, &sector);
+}
+
+void graphics_draw_rounded_rectangle(texture_t* destination, int x, int y, int width, int height, int radius, color_t color) {
+    brush_t brush;
+    if (!brush_init(&brush, destination, color, NULL)) return;
+
+    rounded_rectangle_draw(&brush, x, y, width, height, radius, false);
+}
+
+void graphics_draw_pattern_rounded_rectangle(texture_t* destination, int x, int y, int width, int height, int radius, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    pattern_t fill;
+    if (!pattern_init(&fill, pattern, pattern_offset_x, pattern_offset_y)) return;
+
+    brush_t brush;
+    if (!brush_init(&brush, destination, 0, &fill)) return;
+
+    rounded_rectangle_draw(&brush, x, y, width, height, radius, false);
+}
+
+void graphics_draw_filled_rounded_rectangle(texture_t* destination, int x, int y, int width, int height, int radius, color_t color) {
+    brush_t brush;
+    if (!brush_init(&brush, destination, color, NULL)) return;
+
+    rounded_rectangle_draw(&brush, x, y, width, height, radius, true);
+}
+
+void graphics_draw_filled_pattern_rounded_rectangle(texture_t* destination, int x, int y, int width, int height, int radius, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    pattern_t fill;
+    if (!pattern_init(&fill, pattern, pattern_offset_x, pattern_offset_y)) return;
+
+    brush_t brush;
+    if (!brush_init(&brush, destination, 0, &fill)) return;
+
+    rounded_rectangle_draw(&brush, x, y, width, height, radius, true);
+}
+
+/**
+ * Determine if draw palette maps every color to itself.
+ */
+static bool palette_is_identity(void) {
+    color_t difference = 0;
+
+    for (int i = 0; i < 256; i++) {
+        difference |= draw_palette[i] ^ (color_t)i;
+    }
+
+    return difference == 0;
+}
+
+/**
+ * Copy source rectangle to destination rectangle, remapping pixels through
+ * the draw palette. Clipped to the drawable region.
+ *
+ * @param destination Texture to draw to
+ * @param bounds Drawable region
+ * @param source Texture to copy from
+ * @param source_rect Region of source to copy
+ * @param dest_rect Region of destination to copy to
+ */
+static void draw_blit(texture_t* destination, rect_t* bounds, texture_t* source, rect_t* source_rect, rect_t* dest_rect) {
+    // An identity palette only needs the transparent color check
+    blit_t blit = {
+        .mode = palette_is_identity() ? BLIT_KEYED : BLIT_REMAPPED,
+        .transparent = transparent_color,
+        .palette = draw_palette,
+        .blend = blend_table
+    };
+
+    if (blend_table) {
+        blit.mode = BLIT_BLENDED;
+    }
+
+    graphics_blit_rect(destination, bounds, source, source_rect, dest_rect, &blit);
+}
+
+// Font glyphs as 1bpp masks, one byte per glyph row with the leftmost pixel
+// in the most significant bit. Only written by graphics_draw_font_set so it
+// is shared by all draw threads.
+static uint8_t glyph_masks[256][8];
+
+// Glyph row masks expanded to one byte per pixel, 0xff for set bits. Used to
+// select between colors for a whole glyph row at once.
+static uint64_t glyph_row_masks[256];
+
+void graphics_draw_font_set(texture_t* font) {
+    for (int bits = 0; bits < 256; bits++) {
+        uint8_t row[8];
+
+        for (int k = 0; k < 8; k++) {
+            row[k] = bits & (0x80 >> k) ? 0xff : 0;
+        }
 
-    int sx = modulo(x - offset_x, graphics_texture_width_get(pattern));
-    int sy = modulo(y - offset_y, graphics_texture_height_get(pattern));
+        memcpy(&glyph_row_masks[bits], row, sizeof(row));
+    }
 
-    color_t pixel = graphics_texture_pixel_get(pattern, sx, sy);
-    color_t* draw_palette = graphics_draw_palette_get();
-    pixel = draw_palette[pixel];
+    memset(glyph_masks, 0, sizeof(glyph_masks));
 
-    graphics_draw_pixel(destination, x, y, pixel);
-}
+    int columns = font->width / 8;
+    if (columns <= 0) return;
 
-void graphics_draw_line(texture_t* destination, int x0, int y0, int x1, int y1, color_t color) {
-    // DDA based line drawing algorithm
-    int delta_x = x1 - x0;
-    int delta_y = y1 - y0;
-    int longest_side = fmax(abs(delta_x), abs(delta_y));
+    for (int c = 0; c < 256; c++) {
+        int glyph_x = c % columns * 8;
+        int glyph_y = c / columns * 8;
 
-    float x_inc = delta_x / (float)longest_side;
-    float y_inc = delta_y / (float)longest_side;
+        for (int row = 0; row < 8 && glyph_y + row < font->height; row++) {
+            color_t* source = font->pixels + (glyph_y + row) * font->stride + glyph_x;
+            uint8_t mask = 0;
 
-    float current_x = x0;
-    float current_y = y0;
+            for (int k = 0; k < 8; k++) {
+                if (source[k]) mask |= 0x80 >> k;
+            }
 
-    for (int i = 0; i <= longest_side; i++) {
-        graphics_draw_pixel(destination, current_x, current_y, color);
-        current_x += x_inc;
-        current_y += y_inc;
+            glyph_masks[c][row] = mask;
+        }
     }
 }
 
-void graphics_draw_pattern_line(texture_t* destination, int x0, int y0, int x1, int y1, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
-    // DDA based line drawing algorithm
-    int delta_x = x1 - x0;
-    int delta_y = y1 - y0;
-    int longest_side = fmax(abs(delta_x), abs(delta_y));
+/**
+ * Draw text using the glyph masks. Set bits are drawn in the foreground
+ * color and clear bits in the background color. Either color is skipped if
+ * it is the transparent color.
+ *
+ * @param destination Texture to draw to
+ * @param message Text to draw
+ * @param x Text top-left x-coordinate
+ * @param y Text top-left y-coordinate
+ * @param foreground Foreground color
+ * @param background Background color
+ */
+static void text_draw(texture_t* destination, const char* message, int x, int y, color_t foreground, color_t background) {
+    bool draw_foreground = foreground != transparent_color;
+    bool draw_background = background != transparent_color;
+    if (!draw_foreground && !draw_background) return;
 
-    float x_inc = delta_x / (float)longest_side;
-    float y_inc = delta_y / (float)longest_side;
+    rect_t bounds;
+    if (!drawable_bounds_get(destination, &bounds)) return;
 
-    float current_x = x0;
-    float current_y = y0;
+    int right = bounds.x + bounds.width;
+    int bottom = bounds.y + bounds.height;
 
-    for (int i = 0; i <= longest_side; i++) {
-        pattern_pixel_set(destination, current_x, current_y, pattern, pattern_offset_x, pattern_offset_y);
-        current_x += x_inc;
-        current_y += y_inc;
-    }
-}
+    // If only one color is drawn, its bits are the ones written
+    color_t color = draw_foreground ? foreground : background;
+    uint8_t invert = draw_foreground ? 0 : 0xff;
 
-void graphics_draw_textured_line(texture_t* destination, int x0, int y0, float u0, float v0, int x1, int y1, float u1, float v1, texture_t* texture_map) {
-    // DDA based line drawing algorithm
-    int delta_x = x1 - x0;
-    int delta_y = y1 - y0;
-    int xy_longest_side = fmax(abs(delta_x), abs(delta_y));
+    uint64_t foreground_row = foreground * UINT64_C(0x0101010101010101);
+    uint64_t background_row = background * UINT64_C(0x0101010101010101);
+    uint64_t color_row = color * UINT64_C(0x0101010101010101);
 
-    float x_inc = delta_x / (float)xy_longest_side;
-    float y_inc = delta_y / (float)xy_longest_side;
+    int dest_x = x;
+    int dest_y = y;
 
-    float current_x = x0;
-    float current_y = y0;
+    for (const unsigned char* c = (const unsigned char*)message; *c != '\0'; c++) {
+        if (*c == '\n') {
+            dest_x = x;
+            dest_y += 8;
+            continue;
+        }
 
-    float texture_width = graphics_texture_width_get(texture_map) - 1;
-    float texture_height = graphics_texture_height_get(texture_map) - 1;
+        if (*c == '\t') {
+            dest_x += 16;
+            continue;
+        }
 
-    // Convert uv-coordinates to st-coordinates
-    float s0 = u0 * texture_width;
-    float t0 = v0 * texture_height;
-    float s1 = u1 * texture_width;
-    float t1 = v1 * texture_height;
+        int glyph_x = dest_x;
+        dest_x += 8;
 
-    float delta_s = s1 - s0;
-    float delta_t = t1 - t0;
-    float st_longest_side = fmax(fabs(delta_s), fabs(delta_t));
+        // Skip glyphs entirely outside of drawable region
+        if (clip_test(&bounds, glyph_x, dest_y, glyph_x + 7, dest_y + 7) == CLIP_OUTSIDE) continue;
+
+        int first_column = MAX(bounds.x - glyph_x, 0);
+        int last_column = MIN(right - glyph_x, 8);
+        int first_row = MAX(bounds.y - dest_y, 0);
+        int last_row = MIN(bottom - dest_y, 8);
+
+        const uint8_t* mask = glyph_masks[*c];
+
+        // Whole glyph rows are selected eight pixels at a time
+        if (first_column == 0 && last_column == 8) {
+            for (int row = first_row; row < last_row; row++) {
+                color_t* pixels = destination->pixels + (dest_y + row) * destination->stride + glyph_x;
+                uint64_t value;
+
+                if (draw_foreground && draw_background) {
+                    uint64_t select = glyph_row_masks[mask[row]];
+                    value = (foreground_row & select) | (background_row & ~select);
+                }
+                else {
+                    uint64_t select = glyph_row_masks[mask[row] ^ invert];
+                    memcpy(&value, pixels, sizeof(value));
+                    value = (color_row & select) | (value & ~select);
+                }
+
+                memcpy(pixels, &value, sizeof(value));
+            }
 
-    // Length of longest side in terms of pixels.
-    float st_distance_pixels = st_longest_side + 1;
-    float xy_distance_pixels = xy_longest_side + 1;
+            continue;
+        }
 
-    // Calculate ratio of st-coordinates to xy-coordinates.
-    float ratio = st_distance_pixels / xy_distance_pixels;
+        for (int row = first_row; row < last_row; row++) {
+            color_t* pixels = destination->pixels + (dest_y + row) * destination->stride;
+            unsigned bits = mask[row];
 
-    float s_inc = delta_s / st_longest_side * ratio;
-    float t_inc = delta_t / st_longest_side * ratio;
+            if (draw_foreground && draw_background) {
+                for (int k = first_column; k < last_column; k++) {
+                    pixels[glyph_x + k] = bits & (0x80 >> k) ? foreground : background;
+                }
 
-    // Sample texture at pixel centers
-    float s_scaled_pixel_center = delta_s == 0 ? 0.5f : 0.5f * ratio;
-    float t_scaled_pixel_center = delta_t == 0 ? 0.5f : 0.5f * ratio;
-    float current_s = s0 + s_scaled_pixel_center;
-    float current_t = t0 + t_scaled_pixel_center;
+                continue;
+            }
 
-    for (int i = 0; i <= xy_longest_side; i++) {
-        if (current_s >= 0 && current_t >= 0) {
-            int s = floor(current_s);
-            int t = floor(current_t);
-            color_t c = graphics_texture_pixel_get(texture_map, s, t);
+            bits ^= invert;
 
-            graphics_draw_pixel(destination, current_x, current_y, c);
-        }
+            // Write runs of the drawn bits as spans
+            for (int k = first_column; k < last_column;) {
+                if (!(bits & (0x80 >> k))) {
+                    k++;
+                    continue;
+                }
 
-        current_x += x_inc;
-        current_y += y_inc;
-        current_s += s_inc;
-        current_t += t_inc;
+                int start = k;
+                while (k < last_column && bits & (0x80 >> k)) k++;
+
+                memset(pixels + glyph_x + start, color, k - start);
+            }
+        }
     }
 }
 
-void graphics_draw_bezier(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3, color_t color) {
-    mfloat_t a[VEC2_SIZE] = {x0, y0};
-    mfloat_t b[VEC2_SIZE] = {x1, y1};
-    mfloat_t c[VEC2_SIZE] = {x2, y2};
-    mfloat_t d[VEC2_SIZE] = {x3, y3};
+void graphics_draw_text(texture_t* destination, const char* message, int x, int y) {
+    text_draw(destination, message, x, y, draw_palette[1], draw_palette[0]);
+}
+
+void graphics_draw_colored_text(texture_t* destination, const char* message, int x, int y, color_t foreground, color_t background) {
+    text_draw(destination, message, x, y, foreground, background);
+}
+
+void graphics_draw_triangle(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, color_t color) {
+    graphics_draw_line(destination, x0, y0, x1, y1, color);
+    graphics_draw_line(destination, x1, y1, x2, y2, color);
+    graphics_draw_line(destination, x2, y2, x0, y0, color);
+}
+
+void graphics_draw_pattern_triangle(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    graphics_draw_pattern_line(destination, x0, y0, x1, y1, pattern, pattern_offset_x, pattern_offset_y);
+    graphics_draw_pattern_line(destination, x1, y1, x2, y2, pattern, pattern_offset_x, pattern_offset_y);
+    graphics_draw_pattern_line(destination, x2, y2, x0, y0, pattern, pattern_offset_x, pattern_offset_y);
+}
 
-    mfloat_t ab[VEC2_SIZE];
-    mfloat_t bc[VEC2_SIZE];
-    mfloat_t cd[VEC2_SIZE];
+#define BLOCK_SIZE 8
 
-    mfloat_t abbc[VEC2_SIZE];
-    mfloat_t bccd[VEC2_SIZE];
+/**
+ * Triangle edge function evaluated at pixel centers. Values are in fixed-point
+ * with one fractional bit, which is exact for integer vertices. The value at
+ * pixel x, y is a * x + b * y + c and is twice the signed area of the
+ * parallelogram spanned by the edge and the pixel center.
+ */
+typedef struct edge {
+    int64_t a;
+    int64_t b;
+    int64_t c;
+    int64_t bias;
+} edge_t;
+
+/**
+ * Called once per covered span of a rasterized triangle or polygon.
+ *
+ * @param destination Texture to draw to
+ * @param x0 Span start x-coordinate
+ * @param x1 Span end x-coordinate inclusive
+ * @param y Span y-coordinate
+ * @param data User data
+ */
+typedef void (*span_func_t)(texture_t* destination, int x0, int x1, int y, void* data);
+
+static void edge_init(edge_t* edge, int x0, int y0, int x1, int y1) {
+    int64_t delta_x = (int64_t)x1 - x0;
+    int64_t delta_y = (int64_t)y1 - y0;
+
+    edge->a = -2 * delta_y;
+    edge->b = 2 * delta_x;
+    edge->c = delta_x * (1 - 2 * (int64_t)y0) - delta_y * (1 - 2 * (int64_t)x0);
 
-    mfloat_t first[VEC2_SIZE] = {x0, y0};
-    mfloat_t next[VEC2_SIZE];
+    // Top-left fill rule. Pixel centers exactly on an edge are only covered
+    // by top and left edges.
+    bool is_top = delta_y == 0 && delta_x > 0;
+    bool is_left = delta_y < 0;
+    edge->bias = is_top || is_left ? 0 : -1;
+}
 
-    // Approximate curve length
-    mfloat_t d0 = vec2_distance(a, d);
-    mfloat_t d1 = vec2_distance(a, b) + vec2_distance(b, c) + vec2_distance(c, d);
-    mfloat_t length = 2.0f / 3.0f * d0 + 1.0f / 3.0f * d1;
+static inline int64_t edge_value(edge_t* edge, int x, int y) {
+    return edge->a * x + edge->b * y + edge->c;
+}
 
-    int pixels_per_segment = 4;
-    int steps = length / pixels_per_segment;
+/**
+ * Set up edge functions and clipped bounding box of triangle.
+ *
+ * @param edges Edge functions to initialize
+ * @param box Clipped bounding box to set
+ * @param bounds Drawable region
+ * @return Twice the triangle area, or zero if nothing is visible
+ */
+static int64_t triangle_setup(edge_t* edges, rect_t* box, rect_t* bounds, int x0, int y0, int x1, int y1, int x2, int y2) {
+    int64_t area = ((int64_t)x2 - x1) * ((int64_t)y0 - y1) - ((int64_t)y2 - y1) * ((int64_t)x0 - x1);
 
-    for (int i = 1; i <= steps; i++) {
-        mfloat_t t = i / (float)steps;
+    // Only clockwise triangles in screen space are drawn
+    if (area <= 0) return 0;
 
-        vec2_lerp(ab, a, b, t);
-        vec2_lerp(bc, b, c, t);
-        vec2_lerp(cd, c, d, t);
+    int left = MAX(MIN(MIN(x0, x1), x2), bounds->x);
+    int top = MAX(MIN(MIN(y0, y1), y2), bounds->y);
+    int right = MIN(MAX(MAX(x0, x1), x2), bounds->x + bounds->width - 1);
+    int bottom = MIN(MAX(MAX(y0, y1), y2), bounds->y + bounds->height - 1);
 
-        vec2_lerp(abbc, ab, bc, t);
-        vec2_lerp(bccd, bc, cd, t);
+    if (left > right || top > bottom) return 0;
 
-        vec2_lerp(next, abbc, bccd, t);
+    box->x = left;
+    box->y = top;
+    box->width = right - left + 1;
+    box->height = bottom - top + 1;
 
-        graphics_draw_line(destination, first[0], first[1], next[0], next[1], color);
+    edge_init(&edges[0], x1, y1, x2, y2);
+    edge_init(&edges[1], x2, y2, x0, y0);
+    edge_init(&edges[2], x0, y0, x1, y1);
 
-        vec2_assign(first, next);
-    }
+    return 2 * area;
 }
 
-void graphics_draw_pattern_bezier(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
-    mfloat_t a[VEC2_SIZE] = {x0, y0};
-    mfloat_t b[VEC2_SIZE] = {x1, y1};
-    mfloat_t c[VEC2_SIZE] = {x2, y2};
-    mfloat_t d[VEC2_SIZE] = {x3, y3};
+/**
+ * Rasterize triangle with half-space edge functions. The bounding box is
+ * walked in 8x8 blocks. Blocks entirely outside an edge are skipped, blocks
+ * entirely inside all edges are accepted without testing pixels and only
+ * blocks straddling an edge are tested per pixel. Coverage of each row is
+ * gathered and emitted as a single span.
+ *
+ * @param destination Texture to draw to
+ * @param edges Triangle edge functions
+ * @param box Clipped bounding box
+ * @param func Function called for each covered span
+ * @param data User data passed to func
+ */
+static void triangle_rasterize(texture_t* destination, edge_t* edges, rect_t* box, span_func_t func, void* data) {
+    int right = box->x + box->width;
+    int bottom = box->y + box->height;
+
+    int span_start[BLOCK_SIZE];
+    int span_end[BLOCK_SIZE];
+
+    for (int by = box->y; by < bottom; by += BLOCK_SIZE) {
+        int rows = MIN(BLOCK_SIZE, bottom - by);
 
-    mfloat_t ab[VEC2_SIZE];
-    mfloat_t bc[VEC2_SIZE];
-    mfloat_t cd[VEC2_SIZE];
+        for (int r = 0; r < rows; r++) {
+            span_start[r] = right;
+            span_end[r] = box->x - 1;
+        }
+
+        for (int bx = box->x; bx < right; bx += BLOCK_SIZE) {
+            int columns = MIN(BLOCK_SIZE, right - bx);
 
-    mfloat_t abbc[VEC2_SIZE];
-    mfloat_t bccd[VEC2_SIZE];
+            bool accept = true;
+            bool reject = false;
+            int64_t corner[3];
 
-    mfloat_t first[VEC2_SIZE] = {x0, y0};
-    mfloat_t next[VEC2_SIZE];
+            // Classify block against each edge using its extreme corners
+            for (int i = 0; i < 3; i++) {
+                edge_t* e = &edges[i];
+                corner[i] = edge_value(e, bx, by) + e->bias;
 
-    // Approximate curve length
-    mfloat_t d0 = vec2_distance(a, d);
-    mfloat_t d1 = vec2_distance(a, b) + vec2_distance(b, c) + vec2_distance(c, d);
-    mfloat_t length = 2.0f / 3.0f * d0 + 1.0f / 3.0f * d1;
+                int64_t step_x = e->a * (columns - 1);
+                int64_t step_y = e->b * (rows - 1);
+                int64_t low = corner[i] + MIN(step_x, 0) + MIN(step_y, 0);
+                int64_t high = corner[i] + MAX(step_x, 0) + MAX(step_y, 0);
 
-    int pixels_per_segment = 4;
-    int steps = length / pixels_per_segment;
+                if (high < 0) {
+                    reject = true;
+                    break;
+                }
+
+                if (low < 0) accept = false;
+            }
 
-    for (int i = 1; i <= steps; i++) {
-        mfloat_t t = i / (float)steps;
+            if (reject) continue;
 
-        vec2_lerp(ab, a, b, t);
-        vec2_lerp(bc, b, c, t);
-        vec2_lerp(cd, c, d, t);
+            if (accept) {
+                for (int r = 0; r < rows; r++) {
+                    span_start[r] = MIN(span_start[r], bx);
+                    span_end[r] = MAX(span_end[r], bx + columns - 1);
+                }
 
-        vec2_lerp(abbc, ab, bc, t);
-        vec2_lerp(bccd, bc, cd, t);
+                continue;
+            }
 
-        vec2_lerp(next, abbc, bccd, t);
+            // Partially covered block, test each pixel
+            for (int r = 0; r < rows; r++) {
+                int64_t w0 = corner[0] + edges[0].b * r;
+                int64_t w1 = corner[1] + edges[1].b * r;
+                int64_t w2 = corner[2] + edges[2].b * r;
+
+                int first = -1;
+                int last = -1;
+
+                for (int c = 0; c < columns; c++) {
+                    if ((w0 | w1 | w2) >= 0) {
+                        if (first < 0) first = c;
+                        last = c;
+                    }
+                    else if (first >= 0) {
+                        break;
+                    }
+
+                    w0 += edges[0].a;
+                    w1 += edges[1].a;
+                    w2 += edges[2].a;
+                }
+
+                if (first < 0) continue;
+
+                span_start[r] = MIN(span_start[r], bx + first);
+                span_end[r] = MAX(span_end[r], bx + last);
+            }
+        }
 
-        graphics_draw_pattern_line(destination, first[0], first[1], next[0], next[1], pattern, pattern_offset_x, pattern_offset_y);
+        // Triangles are convex so each row is covered by a single span
+        for (int r = 0; r < rows; r++) {
+            if (span_end[r] < span_start[r]) continue;
 
-        vec2_assign(first, next);
+            func(destination, span_start[r], span_end[r], by + r, data);
+        }
     }
 }
 
-void graphics_draw_rectangle(texture_t* destination, int x, int y, int width, int height, color_t color) {
-    int x0 = x;
-    int y0 = y;
-    int x1 = x + width - 1;
-    int y1 = y + height - 1;
+typedef struct fill_data {
+    rect_t* bounds;
+    color_t color;
+} fill_data_t;
 
-    graphics_draw_line(destination, x0, y0, x1, y0, color);
-    graphics_draw_line(destination, x1, y0, x1, y1, color);
-    graphics_draw_line(destination, x1, y1, x0, y1, color);
-    graphics_draw_line(destination, x0, y1, x0, y0, color);
+static void fill_span_func(texture_t* destination, int x0, int x1, int y, void* data) {
+    fill_data_t* fill = data;
+    fill_span(destination, fill->bounds, x0, x1, y, fill->color);
 }
 
-void graphics_draw_pattern_rectangle(texture_t* destination, int x, int y, int width, int height, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
-    int x0 = x;
-    int y0 = y;
-    int x1 = x + width - 1;
-    int y1 = y + height - 1;
+void graphics_draw_filled_triangle(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, color_t color) {
+    if (color == transparent_color) return;
 
-    graphics_draw_pattern_line(destination, x0, y0, x1, y0, pattern, pattern_offset_x, pattern_offset_y);
-    graphics_draw_pattern_line(destination, x1, y0, x1, y1, pattern, pattern_offset_x, pattern_offset_y);
-    graphics_draw_pattern_line(destination, x1, y1, x0, y1, pattern, pattern_offset_x, pattern_offset_y);
-    graphics_draw_pattern_line(destination, x0, y1, x0, y0, pattern, pattern_offset_x, pattern_offset_y);
+    rect_t bounds;
+    if (!drawable_bounds_get(destination, &bounds)) return;
+
+    edge_t edges[3];
+    rect_t box;
+    if (!triangle_setup(edges, &box, &bounds, x0, y0, x1, y1, x2, y2)) return;
+
+    fill_data_t fill = {&bounds, color};
+    triangle_rasterize(destination, edges, &box, fill_span_func, &fill);
 }
 
-void graphics_draw_filled_rectangle(texture_t* destination, int x, int y, int width, int height, color_t color) {
-    int x0 = x;
-    int x1 = x + width - 1;
-    int y0 = y;
+typedef struct pattern_data {
+    rect_t* bounds;
+    pattern_t pattern;
+} pattern_data_t;
 
-    for (int i = 0; i < height; i++) {
-        y0 = y + i;
-        graphics_draw_line(destination, x0, y0, x1, y0, color);
-    }
+static void pattern_span_func(texture_t* destination, int x0, int x1, int y, void* data) {
+    pattern_data_t* fill = data;
+    pattern_span(destination, fill->bounds, x0, x1, y, &fill->pattern);
 }
 
-void graphics_draw_filled_pattern_rectangle(texture_t* destination, int x, int y, int width, int height, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
-    int x0 = x;
-    int x1 = x + width - 1;
-    int y0 = y;
+void graphics_draw_filled_pattern_triangle(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    pattern_data_t fill;
+    if (!pattern_init(&fill.pattern, pattern, pattern_offset_x, pattern_offset_y)) return;
 
-    for (int i = 0; i < height; i++) {
-        y0 = y + i;
-        graphics_draw_pattern_line(destination, x0, y0, x1, y0, pattern, pattern_offset_x, pattern_offset_y);
-    }
+    rect_t bounds;
+    if (!drawable_bounds_get(destination, &bounds)) return;
+
+    edge_t edges[3];
+    rect_t box;
+    if (!triangle_setup(edges, &box, &bounds, x0, y0, x1, y1, x2, y2)) return;
+
+    fill.bounds = &bounds;
+    triangle_rasterize(destination, edges, &box, pattern_span_func, &fill);
 }
 
 /**
- * Plot 8 pixels of the circle at a time using octave symmetry.
- *
- * @param x Current x-coordinate on perimeter of circle
- * @param y Current y-coordinate on perimeter of circle
- * @param offset_x X-coordinate offset
- * @param offset_y Y-coordinate offset
- * @param color Line color
+ * Texture coordinates of a textured triangle or polygon as planes over
+ * screen space.
+ * Coordinate at pixel x, y is s_x * x + s_y * y + s_c and likewise for t.
  */
-static void draw_pixel_octave_symmetry(texture_t* destination, int x, int y, int offset_x, int offset_y, color_t color) {
-    graphics_draw_pixel(destination,  x + offset_x,  y + offset_y, color);
-    graphics_draw_pixel(destination,  y + offset_x,  x + offset_y, color);
-    graphics_draw_pixel(destination, -x + offset_x,  y + offset_y, color);
-    graphics_draw_pixel(destination, -y + offset_x,  x + offset_y, color);
-    graphics_draw_pixel(destination,  x + offset_x, -y + offset_y, color);
-    graphics_draw_pixel(destination,  y + offset_x, -x + offset_y, color);
-    graphics_draw_pixel(destination, -x + offset_x, -y + offset_y, color);
-    graphics_draw_pixel(destination, -y + offset_x, -x + offset_y, color);
+typedef struct textured_data {
+    texture_t* texture;
+    float s_x;
+    float s_y;
+    float s_c;
+    float t_x;
+    float t_y;
+    float t_c;
+} textured_data_t;
+
+static void textured_span_func(texture_t* destination, int x0, int x1, int y, void* data) {
+    textured_data_t* textured = data;
+    texture_t* texture = textured->texture;
+
+    // Copied to locals since pixel writes could alias them
+    color_t* pixels = texture->pixels;
+    unsigned width = texture->width;
+    unsigned height = texture->height;
+    int stride = texture->stride;
+    color_t transparent = transparent_color;
+    const blend_table_t* blend = blend_table;
+
+    float s_x = textured->s_x;
+    float t_x = textured->t_x;
+    float s_row = textured->s_y * y + textured->s_c;
+    float t_row = textured->t_y * y + textured->t_c;
+
+    color_t* row = destination->pixels + y * destination->stride;
+
+    // Evaluate the planes at every pixel so sampling doesn't depend on
+    // where the span starts
+    for (int x = x0; x <= x1; x++) {
+        int sx = s_x * x + s_row;
+        int sy = t_x * x + t_row;
+
+        if ((unsigned)sx < width && (unsigned)sy < height) {
+            color_t c = pixels[sy * stride + sx];
+
+            if (c != transparent) {
+                row[x] = blend ? blend->colors[c][row[x]] : c;
+            }
+        }
+    }
+}
+
+void graphics_draw_textured_triangle(texture_t* destination, int x0, int y0, float u0, float v0, int x1, int y1, float u1, float v1, int x2, int y2, float u2, float v2, texture_t* texture_map) {
+    rect_t bounds;
+    if (!drawable_bounds_get(destination, &bounds)) return;
+
+    edge_t edges[3];
+    rect_t box;
+    int64_t area = triangle_setup(edges, &box, &bounds, x0, y0, x1, y1, x2, y2);
+    if (!area) return;
+
+    // Barycentric coordinates are the edge functions divided by the area,
+    // so texture coordinates are a linear function of screen position
+    float inverse_area = 1.0f / area;
+    float width = texture_map->width * inverse_area;
+    float height = texture_map->height * inverse_area;
+
+    textured_data_t textured = {
+        texture_map,
+        (u0 * edges[0].a + u1 * edges[1].a + u2 * edges[2].a) * width,
+        (u0 * edges[0].b + u1 * edges[1].b + u2 * edges[2].b) * width,
+        (u0 * edges[0].c + u1 * edges[1].c + u2 * edges[2].c) * width,
+        (v0 * edges[0].a + v1 * edges[1].a + v2 * edges[2].a) * height,
+        (v0 * edges[0].b + v1 * edges[1].b + v2 * edges[2].b) * height,
+        (v0 * edges[0].c + v1 * edges[1].c + v2 * edges[2].c) * height
+    };
+
+    triangle_rasterize(destination, edges, &box, textured_span_func, &textured);
 }
 
 /**
- * Draw four horizontal lines at time using octave symmetry.
- *
- * @param x Current x-coordinate on perimeter of circle
- * @param y Current y-coordinate on perimeter of circle
- * @param offset_x X-coordinate offset
- * @param offset_y Y-coordinate offset
- * @param color Fill color
+ * Polygon edge walked down one scanline at a time. Crossings are sampled at
+ * pixel centers and x is the first column whose center is on or right of
+ * the crossing. It is kept exact with an integer remainder, so the result
+ * doesn't depend on the scanline walking started on.
  */
-static void fill_pixel_octave_symmetry(texture_t* destination, int x, int y, int offset_x, int offset_y, color_t color) {
-    graphics_draw_line(destination, x + offset_x,  y + offset_y, -x + offset_x,  y + offset_y, color);
-    graphics_draw_line(destination, y + offset_x,  x + offset_y, -y + offset_x,  x + offset_y, color);
-    graphics_draw_line(destination, x + offset_x, -y + offset_y, -x + offset_x, -y + offset_y, color);
-    graphics_draw_line(destination, y + offset_x, -x + offset_y, -y + offset_x, -x + offset_y, color);
-}
+typedef struct polygon_edge {
+    int top;
+    int bottom;
+    int winding;
+    int x0;
+    int y0;
+    int64_t delta_x;
+    int64_t delta_y;
+    int64_t x;
+    int64_t remainder;
+    int64_t step;
+    int64_t step_remainder;
+} polygon_edge_t;
 
 /**
- * Draw circle
+ * Set up edge from x0, y0 to x1, y1. Edges cover scanlines whose centers are
+ * in [top, bottom), which is the top-left rule used for triangles.
  *
- * @param x Circle center x-coordinate
- * @param y Circle center y-coordinate
- * @param radius Circle radius
- * @param color Line color
+ * @return true if edge covers any scanlines, false if horizontal
  */
-void graphics_draw_circle(texture_t* destination, int x, int y, int radius, color_t color) {
-    // Bresenham's circle algorithm
-    if (radius <= 0) return;
+static bool polygon_edge_init(polygon_edge_t* edge, int x0, int y0, int x1, int y1) {
+    if (y0 == y1) return false;
+
+    edge->winding = 1;
+
+    if (y0 > y1) {
+        int x = x0;
+        int y = y0;
+        x0 = x1;
+        y0 = y1;
+        x1 = x;
+        y1 = y;
+        edge->winding = -1;
+    }
 
-    int _x = 0;
-    int _y = radius;
-    int midpoint_criteria = 1 - radius;
+    edge->top = y0;
+    edge->bottom = y1;
+    edge->x0 = x0;
+    edge->y0 = y0;
+    edge->delta_x = (int64_t)x1 - x0;
+    edge->delta_y = (int64_t)y1 - y0;
 
-    draw_pixel_octave_symmetry(destination, _x, _y, x, y, color);
+    // Crossings move by delta_x / delta_y per scanline
+    edge->step = floor_div(2 * edge->delta_x, 2 * edge->delta_y);
+    edge->step_remainder = 2 * edge->delta_x - edge->step * 2 * edge->delta_y;
 
-    while (_x < _y) {
-        // Mid-point on or inside radius
-        if (midpoint_criteria <= 0) {
-            midpoint_criteria += (_x << 1) + 3;
-        }
-        // Mid-point outside radius
-        else {
-            midpoint_criteria += ((_x - _y) << 1) + 5;
-            _y -= 1;
-        }
-        _x++;
-        draw_pixel_octave_symmetry(destination, _x, _y, x, y, color);
-    }
+    return true;
 }
 
-static void draw_pattern_octave_symmetry(texture_t* destination, int x, int y, int offset_x, int offset_y, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
-    pattern_pixel_set(destination,  x + offset_x,  y + offset_y, pattern, pattern_offset_x, pattern_offset_y);
-    pattern_pixel_set(destination,  y + offset_x,  x + offset_y, pattern, pattern_offset_x, pattern_offset_y);
-    pattern_pixel_set(destination, -x + offset_x,  y + offset_y, pattern, pattern_offset_x, pattern_offset_y);
-    pattern_pixel_set(destination, -y + offset_x,  x + offset_y, pattern, pattern_offset_x, pattern_offset_y);
-    pattern_pixel_set(destination,  x + offset_x, -y + offset_y, pattern, pattern_offset_x, pattern_offset_y);
-    pattern_pixel_set(destination,  y + offset_x, -x + offset_y, pattern, pattern_offset_x, pattern_offset_y);
-    pattern_pixel_set(destination, -x + offset_x, -y + offset_y, pattern, pattern_offset_x, pattern_offset_y);
-    pattern_pixel_set(destination, -y + offset_x, -x + offset_y, pattern, pattern_offset_x, pattern_offset_y);
+/**
+ * Start walking edge at scanline y. The crossing with the center of the
+ * scanline is x0 + (y + 0.5 - y0) * delta_x / delta_y, and the first column
+ * at or right of it is the ceiling of the crossing minus one half.
+ */
+static void polygon_edge_start(polygon_edge_t* edge, int y) {
+    int64_t denominator = 2 * edge->delta_y;
+    int64_t numerator = (2 * (int64_t)edge->x0 - 1) * edge->delta_y + (2 * ((int64_t)y - edge->y0) + 1) * edge->delta_x;
+
+    edge->x = ceil_div(numerator, denominator);
+    edge->remainder = edge->x * denominator - numerator;
 }
 
-void graphics_draw_pattern_circle(texture_t* destination, int x, int y, int radius, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
-    // Bresenham's circle algorithm
-    if (radius <= 0) return;
+static inline void polygon_edge_step(polygon_edge_t* edge) {
+    edge->x += edge->step;
+    edge->remainder -= edge->step_remainder;
 
-    int _x = 0;
-    int _y = radius;
-    int midpoint_criteria = 1 - radius;
+    if (edge->remainder < 0) {
+        edge->remainder += 2 * edge->delta_y;
+        edge->x++;
+    }
+}
 
-    draw_pattern_octave_symmetry(destination, _x, _y, x, y, pattern, pattern_offset_x, pattern_offset_y);
+static int polygon_edge_compare(const void* a, const void* b) {
+    const polygon_edge_t* edge_a = a;
+    const polygon_edge_t* edge_b = b;
 
-    while (_x < _y) {
-        // Mid-point on or inside radius
-        if (midpoint_criteria <= 0) {
-            midpoint_criteria += (_x << 1) + 3;
-        }
-        // Mid-point outside radius
-        else {
-            midpoint_criteria += ((_x - _y) << 1) + 5;
-            _y -= 1;
-        }
-        _x++;
-        draw_pattern_octave_symmetry(destination, _x, _y, x, y, pattern, pattern_offset_x, pattern_offset_y);
-    }
+    return (edge_a->top > edge_b->top) - (edge_a->top < edge_b->top);
 }
 
+static inline bool polygon_inside(int winding, fill_rule_t rule) {
+    return rule == FILL_RULE_NON_ZERO ? winding != 0 : (winding & 1) != 0;
+}
+
+#define POLYGON_STACK_EDGES 32
+
 /**
- * Draw filled circle
+ * Rasterize polygon with a global edge table and an active edge list. Edges
+ * are sorted by their first scanline once. Each scanline adds the edges that
+ * start on it, drops the ones that ended and steps the rest, then restores
+ * x order with an insertion sort, which is cheap since the order rarely
+ * changes between scanlines. Covered spans are found by walking the active
+ * edges and tracking the winding number.
  *
- * @param x Circle center x-coordinate
- * @param y Circle center y-coordinate
- * @param radius Circle radius
- * @param color Fill color
+ * @param destination Texture to draw to
+ * @param bounds Drawable region. Spans are clipped to it.
+ * @param points Interleaved x, y vertex coordinates
+ * @param count Number of vertices
+ * @param rule Fill rule
+ * @param func Function called for each covered span
+ * @param data User data passed to func
  */
-void graphics_draw_filled_circle(texture_t* destination, int x, int y, int radius, color_t color) {
-    // Bresenham's circle algorithm
-    if (radius <= 0) return;
+static void polygon_rasterize(texture_t* destination, rect_t* bounds, const int* points, int count, fill_rule_t rule, span_func_t func, void* data) {
+    if (!points || count < 3) return;
 
-    int _x = 0;
-    int _y = radius;
-    int midpoint_criteria = 1 - radius;
+    polygon_edge_t edge_storage[POLYGON_STACK_EDGES];
+    polygon_edge_t* active_storage[POLYGON_STACK_EDGES];
+    polygon_edge_t* edges = edge_storage;
+    polygon_edge_t** active = active_storage;
+    void* heap = NULL;
 
-    fill_pixel_octave_symmetry(destination, _x, _y, x, y, color);
+    if (count > POLYGON_STACK_EDGES) {
+        heap = malloc(count * (sizeof(polygon_edge_t) + sizeof(polygon_edge_t*)));
+        if (!heap) return;
 
-    while (_x < _y) {
-        // Mid-point on or inside radius
-        if (midpoint_criteria <= 0) {
-            midpoint_criteria += (_x << 1) + 3;
-        }
-        // Mid-point outside radius
-        else {
-            midpoint_criteria += ((_x - _y) << 1) + 5;
-            _y -= 1;
-        }
-        _x++;
-        fill_pixel_octave_symmetry(destination, _x, _y, x, y, color);
+        edges = heap;
+        active = (polygon_edge_t**)(edges + count);
     }
-}
 
-static void fill_pattern_octave_symmetry(texture_t* destination, int x, int y, int offset_x, int offset_y, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
-    graphics_draw_pattern_line(destination, x + offset_x,  y + offset_y, -x + offset_x,  y + offset_y, pattern, pattern_offset_x, pattern_offset_y);
-    graphics_draw_pattern_line(destination, y + offset_x,  x + offset_y, -y + offset_x,  x + offset_y, pattern, pattern_offset_x, pattern_offset_y);
-    graphics_draw_pattern_line(destination, x + offset_x, -y + offset_y, -x + offset_x, -y + offset_y, pattern, pattern_offset_x, pattern_offset_y);
-    graphics_draw_pattern_line(destination, y + offset_x, -x + offset_y, -y + offset_x, -x + offset_y, pattern, pattern_offset_x, pattern_offset_y);
-}
+    int edge_count = 0;
+    int bottom = INT32_MIN;
 
-void graphics_draw_filled_pattern_circle(texture_t* destination, int x, int y, int radius, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
-    // Bresenham's circle algorithm
-    if (radius <= 0) return;
+    for (int i = 0; i < count; i++) {
+        int next = (i + 1) % count;
+        polygon_edge_t* edge = &edges[edge_count];
 
-    int _x = 0;
-    int _y = radius;
-    int midpoint_criteria = 1 - radius;
+        if (!polygon_edge_init(edge, points[i * 2], points[i * 2 + 1], points[next * 2], points[next * 2 + 1])) continue;
 
-    fill_pattern_octave_symmetry(destination, _x, _y, x, y, pattern, pattern_offset_x, pattern_offset_y);
+        bottom = MAX(bottom, edge->bottom);
+        edge_count++;
+    }
 
-    while (_x < _y) {
-        // Mid-point on or inside radius
-        if (midpoint_criteria <= 0) {
-            midpoint_criteria += (_x << 1) + 3;
-        }
-        // Mid-point outside radius
-        else {
-            midpoint_criteria += ((_x - _y) << 1) + 5;
-            _y -= 1;
-        }
-        _x++;
-        fill_pattern_octave_symmetry(destination, _x, _y, x, y, pattern, pattern_offset_x, pattern_offset_y);
+    if (edge_count == 0) {
+        free(heap);
+        return;
     }
-}
 
-static void draw_blit_func(texture_t* source_texture, texture_t* destination_texture, int sx, int sy, int dx, int dy) {
-    color_t pixel = graphics_texture_pixel_get(source_texture, sx, sy);
-    color_t* draw_palette = graphics_draw_palette_get();
-    pixel = draw_palette[pixel];
+    qsort(edges, edge_count, sizeof(polygon_edge_t), polygon_edge_compare);
 
-    graphics_draw_pixel(destination_texture, dx, dy, pixel);
-}
+    // Only visit scanlines inside the drawable region
+    int top = MAX(edges[0].top, bounds->y);
+    bottom = MIN(bottom, bounds->y + bounds->height);
 
-void graphics_draw_text(texture_t* destination, const char* message, int x, int y) {
-    texture_t* font_texture = assets_texture_get("font.gif", 0);
-    if (!font_texture) {
-        log_fatal("Missing font.gif asset");
-    }
+    int left = bounds->x;
+    int right = bounds->x + bounds->width - 1;
+    int next = 0;
+    int active_count = 0;
 
-    rect_t source_rect = {0, 0, 8, 8};
-    rect_t dest_rect = {0, y, 8, 8};
+    for (int y = top; y < bottom; y++) {
+        // Step edges that continue from the previous scanline
+        int kept = 0;
+        for (int i = 0; i < active_count; i++) {
+            polygon_edge_t* edge = active[i];
+            if (edge->bottom <= y) continue;
 
-    int dest_x = x;
+            polygon_edge_step(edge);
+            active[kept++] = edge;
+        }
 
-    for (int i = 0; i < strlen(message); i++) {
-        unsigned char c = message[i];
+        active_count = kept;
 
-        if (c == '\n') {
-            dest_x = x;
-            dest_rect.y += 8;
-            continue;
+        // Edges starting above the drawable region start on its first scanline
+        while (next < edge_count && edges[next].top <= y) {
+            polygon_edge_t* edge = &edges[next++];
+            if (edge->bottom <= y) continue;
+
+            polygon_edge_start(edge, y);
+            active[active_count++] = edge;
         }
 
-        if (c == '\t') {
-            dest_x += 16;
-            continue;
+        for (int i = 1; i < active_count; i++) {
+            polygon_edge_t* current = active[i];
+            int j = i - 1;
+
+            while (j >= 0 && active[j]->x > current->x) {
+                active[j + 1] = active[j];
+                j--;
+            }
+
+            active[j + 1] = current;
         }
 
-        int cx = c % (graphics_texture_width_get(font_texture) / 8) * 8;
-        int cy = c / (graphics_texture_width_get(font_texture) / 8) * 8;
+        int winding = 0;
+        int64_t start = 0;
 
-        source_rect.x = cx;
-        source_rect.y = cy;
-        dest_rect.x = dest_x;
+        for (int i = 0; i < active_count; i++) {
+            bool was_inside = polygon_inside(winding, rule);
+            winding += active[i]->winding;
+            bool is_inside = polygon_inside(winding, rule);
 
-        dest_x += 8;
+            if (!was_inside && is_inside) {
+                start = active[i]->x;
+            }
+            else if (was_inside && !is_inside) {
+                int64_t x0 = MAX(start, left);
+                int64_t x1 = MIN(active[i]->x - 1, right);
 
-        graphics_blit(
-            font_texture,
-            destination,
-            &source_rect,
-            &dest_rect,
-            draw_blit_func
-        );
+                if (x0 <= x1) func(destination, x0, x1, y, data);
+            }
+        }
     }
-}
-
-void graphics_draw_triangle(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, color_t color) {
-    graphics_draw_line(destination, x0, y0, x1, y1, color);
-    graphics_draw_line(destination, x1, y1, x2, y2, color);
-    graphics_draw_line(destination, x2, y2, x0, y0, color);
-}
 
-void graphics_draw_pattern_triangle(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
-    graphics_draw_pattern_line(destination, x0, y0, x1, y1, pattern, pattern_offset_x, pattern_offset_y);
-    graphics_draw_pattern_line(destination, x1, y1, x2, y2, pattern, pattern_offset_x, pattern_offset_y);
-    graphics_draw_pattern_line(destination, x2, y2, x0, y0, pattern, pattern_offset_x, pattern_offset_y);
+    free(heap);
 }
 
-static int edge_function(mfloat_t* a, mfloat_t* b, mfloat_t* p) {
-    mfloat_t ab[VEC2_SIZE];
-    vec2_subtract(ab, b, a);
+void graphics_draw_polygon(texture_t* destination, const int* points, int count, color_t color) {
+    stroke_t stroke;
+    if (!stroke_init(&stroke, destination, color, NULL)) return;
 
-    mfloat_t ap[VEC2_SIZE];
-    vec2_subtract(ap, p, a);
-
-    return vec2_cross(ab, ap);
+    stroke_polyline(&stroke, points, count, true);
 }
 
-static bool is_top_left(mfloat_t* a, mfloat_t* b) {
-    mfloat_t edge[VEC2_SIZE];
-    vec2_subtract(edge, b, a);
+void graphics_draw_pattern_polygon(texture_t* destination, const int* points, int count, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    pattern_t fill;
+    if (!pattern_init(&fill, pattern, pattern_offset_x, pattern_offset_y)) return;
 
-    bool is_top = edge[1] == 0 && edge[0] > 0;
-    bool is_left = edge[1] < 0;
+    stroke_t stroke;
+    if (!stroke_init(&stroke, destination, 0, &fill)) return;
 
-    return is_top || is_left;
+    stroke_polyline(&stroke, points, count, true);
 }
 
-void graphics_draw_filled_triangle(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, color_t color) {
-    mfloat_t vertex0[VEC2_SIZE] = {x0, y0};
-    mfloat_t vertex1[VEC2_SIZE] = {x1, y1};
-    mfloat_t vertex2[VEC2_SIZE] = {x2, y2};
-
-    // Find triangle
-    int x_min = fminf(fminf(vertex0[0], vertex1[0]), vertex2[0]);
-    int y_min = fminf(fminf(vertex0[1], vertex1[1]), vertex2[1]);
-    int x_max = fmaxf(fmaxf(vertex0[0], vertex1[0]), vertex2[0]);
-    int y_max = fmaxf(fmaxf(vertex0[1], vertex1[1]), vertex2[1]);
-
-    // Biases for fill rule
-    float bias0 = is_top_left(vertex1, vertex2) ? 0.0f : -0.001f;
-    float bias1 = is_top_left(vertex2, vertex0) ? 0.0f : -0.001f;
-    float bias2 = is_top_left(vertex0, vertex1) ? 0.0f : -0.001f;
-
-    float delta_w0_col = vertex1[1] - vertex2[1];
-    float delta_w1_col = vertex2[1] - vertex0[1];
-    float delta_w2_col = vertex0[1] - vertex1[1];
-    float delta_w0_row = vertex2[0] - vertex1[0];
-    float delta_w1_row = vertex0[0] - vertex2[0];
-    float delta_w2_row = vertex1[0] - vertex0[0];
-
-    mfloat_t p[2] = { x_min + 0.5f, y_min + 0.5f };
-    float w0_row = edge_function(vertex1, vertex2, p) + bias0;
-    float w1_row = edge_function(vertex2, vertex0, p) + bias1;
-    float w2_row = edge_function(vertex0, vertex1, p) + bias2;
-
-    for (int y = y_min; y <= y_max; y++) {
-        float w0 = w0_row;
-        float w1 = w1_row;
-        float w2 = w2_row;
-
-        for (int x = x_min; x <= x_max; x++) {
-            // Check if inside the triangle
-            if (w0 >= 0 && w1 >= 0 && w2 >= 0) {
-                graphics_draw_pixel(destination, x, y, color);
-            }
+void graphics_draw_filled_polygon(texture_t* destination, const int* points, int count, color_t color, fill_rule_t rule) {
+    if (color == transparent_color) return;
 
-            w0 += delta_w0_col;
-            w1 += delta_w1_col;
-            w2 += delta_w2_col;
-        }
+    rect_t bounds;
+    if (!drawable_bounds_get(destination, &bounds)) return;
 
-        w0_row += delta_w0_row;
-        w1_row += delta_w1_row;
-        w2_row += delta_w2_row;
-    }
+    fill_data_t fill = {&bounds, color};
+    polygon_rasterize(destination, &bounds, points, count, rule, fill_span_func, &fill);
 }
 
-void graphics_draw_filled_pattern_triangle(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
-    mfloat_t vertex0[VEC2_SIZE] = {x0, y0};
-    mfloat_t vertex1[VEC2_SIZE] = {x1, y1};
-    mfloat_t vertex2[VEC2_SIZE] = {x2, y2};
-
-    // Find triangle
-    int x_min = fminf(fminf(vertex0[0], vertex1[0]), vertex2[0]);
-    int y_min = fminf(fminf(vertex0[1], vertex1[1]), vertex2[1]);
-    int x_max = fmaxf(fmaxf(vertex0[0], vertex1[0]), vertex2[0]);
-    int y_max = fmaxf(fmaxf(vertex0[1], vertex1[1]), vertex2[1]);
-
-    // Biases for fill rule
-    float bias0 = is_top_left(vertex1, vertex2) ? 0.0f : -0.001f;
-    float bias1 = is_top_left(vertex2, vertex0) ? 0.0f : -0.001f;
-    float bias2 = is_top_left(vertex0, vertex1) ? 0.0f : -0.001f;
-
-    float delta_w0_col = vertex1[1] - vertex2[1];
-    float delta_w1_col = vertex2[1] - vertex0[1];
-    float delta_w2_col = vertex0[1] - vertex1[1];
-    float delta_w0_row = vertex2[0] - vertex1[0];
-    float delta_w1_row = vertex0[0] - vertex2[0];
-    float delta_w2_row = vertex1[0] - vertex0[0];
-
-    mfloat_t p[2] = { x_min + 0.5f, y_min + 0.5f };
-    float w0_row = edge_function(vertex1, vertex2, p) + bias0;
-    float w1_row = edge_function(vertex2, vertex0, p) + bias1;
-    float w2_row = edge_function(vertex0, vertex1, p) + bias2;
-
-    for (int y = y_min; y <= y_max; y++) {
-        float w0 = w0_row;
-        float w1 = w1_row;
-        float w2 = w2_row;
-
-        for (int x = x_min; x <= x_max; x++) {
-            // Check if inside the triangle
-            if (w0 >= 0 && w1 >= 0 && w2 >= 0) {
-                pattern_pixel_set(destination, x, y, pattern, pattern_offset_x, pattern_offset_y);
-            }
+void graphics_draw_filled_pattern_polygon(texture_t* destination, const int* points, int count, texture_t* pattern, int pattern_offset_x, int pattern_offset_y, fill_rule_t rule) {
+    pattern_data_t fill;
+    if (!pattern_init(&fill.pattern, pattern, pattern_offset_x, pattern_offset_y)) return;
 
-            w0 += delta_w0_col;
-            w1 += delta_w1_col;
-            w2 += delta_w2_col;
-        }
+    rect_t bounds;
+    if (!drawable_bounds_get(destination, &bounds)) return;
 
-        w0_row += delta_w0_row;
-        w1_row += delta_w1_row;
-        w2_row += delta_w2_row;
-    }
+    fill.bounds = &bounds;
+    polygon_rasterize(destination, &bounds, points, count, rule, pattern_span_func, &fill);
 }
 
-void graphics_draw_textured_triangle(texture_t* destination, int x0, int y0, float u0, float v0, int x1, int y1, float u1, float v1, int x2, int y2, float u2, float v2, texture_t* texture_map) {
-    mfloat_t vertex0[VEC2_SIZE] = {x0, y0};
-    mfloat_t vertex1[VEC2_SIZE] = {x1, y1};
-    mfloat_t vertex2[VEC2_SIZE] = {x2, y2};
-    mfloat_t uv0[VEC2_SIZE] = {u0, v0};
-    mfloat_t uv1[VEC2_SIZE] = {u1, v1};
-    mfloat_t uv2[VEC2_SIZE] = {u2, v2};
-
-    // Find triangle
-    int x_min = fminf(fminf(vertex0[0], vertex1[0]), vertex2[0]);
-    int y_min = fminf(fminf(vertex0[1], vertex1[1]), vertex2[1]);
-    int x_max = fmaxf(fmaxf(vertex0[0], vertex1[0]), vertex2[0]);
-    int y_max = fmaxf(fmaxf(vertex0[1], vertex1[1]), vertex2[1]);
-
-    // Biases for fill rule
-    float bias0 = is_top_left(vertex1, vertex2) ? 0.0f : -0.001f;
-    float bias1 = is_top_left(vertex2, vertex0) ? 0.0f : -0.001f;
-    float bias2 = is_top_left(vertex0, vertex1) ? 0.0f : -0.001f;
-
-    float delta_w0_col = vertex1[1] - vertex2[1];
-    float delta_w1_col = vertex2[1] - vertex0[1];
-    float delta_w2_col = vertex0[1] - vertex1[1];
-    float delta_w0_row = vertex2[0] - vertex1[0];
-    float delta_w1_row = vertex0[0] - vertex2[0];
-    float delta_w2_row = vertex1[0] - vertex0[0];
-
-    float area = edge_function(vertex1, vertex2, vertex0);
-    float inverse_area = 1.0f / area;
-
-    mfloat_t p[2] = { x_min + 0.5f, y_min + 0.5f };
-    float w0_row = edge_function(vertex1, vertex2, p) + bias0;
-    float w1_row = edge_function(vertex2, vertex0, p) + bias1;
-    float w2_row = edge_function(vertex0, vertex1, p) + bias2;
-
-    for (int y = y_min; y <= y_max; y++) {
-        float w0 = w0_row;
-        float w1 = w1_row;
-        float w2 = w2_row;
+void graphics_draw_textured_polygon(texture_t* destination, const int* points, const float* coordinates, int count, texture_t* texture_map, fill_rule_t rule) {
+    if (!points || !coordinates || count < 3) return;
 
-        for (int x = x_min; x <= x_max; x++) {
-            // Check if inside the triangle
-            if (w0 >= 0 && w1 >= 0 && w2 >= 0) {
-                // Calculate barycentric coords
-                float alpha = w0 * inverse_area;
-                float beta = w1 * inverse_area;
-                float gamma = w2 * inverse_area;
+    rect_t bounds;
+    if (!drawable_bounds_get(destination, &bounds)) return;
 
-                // Calculate st coords
-                int s = (uv0[0] * alpha + uv1[0] * beta + uv2[0] * gamma) * graphics_texture_width_get(texture_map);
-                int t = (uv0[1] * alpha + uv1[1] * beta + uv2[1] * gamma) * graphics_texture_height_get(texture_map);
+    // Fit texture coordinates as planes over screen space with least squares.
+    // Coordinates are centered on the vertex mean to keep the sums small.
+    double mean_x = 0, mean_y = 0, mean_u = 0, mean_v = 0;
 
-                color_t c = graphics_texture_pixel_get(texture_map, s, t);
+    for (int i = 0; i < count; i++) {
+        mean_x += points[i * 2];
+        mean_y += points[i * 2 + 1];
+        mean_u += coordinates[i * 2];
+        mean_v += coordinates[i * 2 + 1];
+    }
 
-                graphics_draw_pixel(destination, x, y, c);
-            }
+    mean_x /= count;
+    mean_y /= count;
+    mean_u /= count;
+    mean_v /= count;
+
+    double xx = 0, xy = 0, yy = 0, xu = 0, yu = 0, xv = 0, yv = 0;
+
+    for (int i = 0; i < count; i++) {
+        double x = points[i * 2] - mean_x;
+        double y = points[i * 2 + 1] - mean_y;
+        double u = coordinates[i * 2] - mean_u;
+        double v = coordinates[i * 2 + 1] - mean_v;
+
+        xx += x * x;
+        xy += x * y;
+        yy += y * y;
+        xu += x * u;
+        yu += y * u;
+        xv += x * v;
+        yv += y * v;
+    }
 
-            w0 += delta_w0_col;
-            w1 += delta_w1_col;
-            w2 += delta_w2_col;
-        }
+    // Vertices on a single line cover no pixel centers
+    double determinant = xx * yy - xy * xy;
+    if (determinant == 0) return;
+
+    double u_x = (yy * xu - xy * yu) / determinant;
+    double u_y = (xx * yu - xy * xu) / determinant;
+    double v_x = (yy * xv - xy * yv) / determinant;
+    double v_y = (xx * yv - xy * xv) / determinant;
+
+    // Planes are evaluated at pixel centers and scaled to texels
+    float width = texture_map->width;
+    float height = texture_map->height;
+
+    textured_data_t textured = {
+        texture_map,
+        u_x * width,
+        u_y * width,
+        (mean_u + u_x * (0.5 - mean_x) + u_y * (0.5 - mean_y)) * width,
+        v_x * height,
+        v_y * height,
+        (mean_v + v_x * (0.5 - mean_x) + v_y * (0.5 - mean_y)) * height
+    };
 
-        w0_row += delta_w0_row;
-        w1_row += delta_w1_row;
-        w2_row += delta_w2_row;
-    }
+    polygon_rasterize(destination, &bounds, points, count, rule, textured_span_func, &textured);
 }
 
 void graphics_draw_quad(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3, color_t color) {
@@ -700,175 +2796,258 @@ void graphics_draw_pattern_quad(texture_t* destination, int x0, int y0, int x1,
     graphics_draw_pattern_line(destination, x3, y3, x0, y0, pattern, pattern_offset_x, pattern_offset_y);
 }
 
-static int compare_floats(const void* a, const void* b) {
-    return *(const float*)a > *(const float*)b;
-}
-
 void graphics_draw_filled_quad(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3, color_t color) {
-    int min_y = y0;
-    min_y = fminf(min_y, y1);
-    min_y = fminf(min_y, y2);
-    min_y = fminf(min_y, y3);
-
-    int max_y = y0;
-    max_y = fmaxf(max_y, y1);
-    max_y = fmaxf(max_y, y2);
-    max_y = fmaxf(max_y, y3);
+    int points[8] = {x0, y0, x1, y1, x2, y2, x3, y3};
+    graphics_draw_filled_polygon(destination, points, 4, color, FILL_RULE_EVEN_ODD);
+}
 
-    mfloat_t points[4][VEC2_SIZE] = {
-        {x0, y0},
-        {x1, y1},
-        {x2, y2},
-        {x3, y3}
-    };
+void graphics_draw_filled_pattern_quad(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
+    int points[8] = {x0, y0, x1, y1, x2, y2, x3, y3};
+    graphics_draw_filled_pattern_polygon(destination, points, 4, pattern, pattern_offset_x, pattern_offset_y, FILL_RULE_EVEN_ODD);
+}
 
-    float intersections[4];
-    int count = 0;
+#define QUAD_RUN_LENGTH 8
 
-    for (int y = min_y; y <= max_y; y++) {
-        count = 0;
+/**
+ * Inverse bilinear mapping from screen space to quad space, set up once per
+ * quad. Adapted from:
+ * https://www.reedbeta.com/blog/quadrilateral-interpolation-part-2/
+ */
+typedef struct bilinear {
+    mfloat_t origin[VEC2_SIZE];
+    mfloat_t b1[VEC2_SIZE];
+    mfloat_t b2[VEC2_SIZE];
+    mfloat_t b3[VEC2_SIZE];
+    float A;
+    float b1_cross_b2;
+    mfloat_t uvs[4][VEC2_SIZE];
+    texture_t* texture;
+} bilinear_t;
+
+static void bilinear_init(bilinear_t* bilinear, mfloat_t points[4][VEC2_SIZE], mfloat_t uvs[4][VEC2_SIZE], texture_t* texture) {
+    mfloat_t* a = points[0];
+    mfloat_t* b = points[1];
+    mfloat_t* c = points[2];
+    mfloat_t* d = points[3];
+
+    vec2_assign(bilinear->origin, a);
+    vec2_subtract(bilinear->b1, b, a);
+    vec2_subtract(bilinear->b2, d, a);
 
-        for (int i = 0; i < 4; i++) {
-            mfloat_t* a = points[i];
-            mfloat_t* b = points[(i + 1) % 4];
+    // a - b - d + c
+    vec2_subtract(bilinear->b3, a, b);
+    vec2_subtract(bilinear->b3, bilinear->b3, d);
+    vec2_add(bilinear->b3, bilinear->b3, c);
 
-            if (y <= a[1] && y <= b[1]) continue;
-            if (y > a[1] && y > b[1]) continue;
+    bilinear->A = vec2_cross(bilinear->b2, bilinear->b3);
+    bilinear->b1_cross_b2 = vec2_cross(bilinear->b1, bilinear->b2);
 
-            // Don't intersect horizontal lines
-            if (approximately(a[1], b[1])) continue;
+    for (int i = 0; i < 4; i++) {
+        vec2_assign(bilinear->uvs[i], uvs[i]);
+    }
 
-            mfloat_t d[VEC2_SIZE];
-            vec2_subtract(d, b, a);
-            float x = b[0] - (b[1] - y) / d[1] * d[0];
+    bilinear->texture = texture;
+}
 
-            intersections[count] = x;
-            count++;
-        }
+/**
+ * Map quad space coordinates to texture UV coordinates.
+ */
+static inline void bilinear_uv_get(bilinear_t* bilinear, float u, float v, float* result) {
+    mfloat_t* uv0 = bilinear->uvs[0];
+    mfloat_t* uv1 = bilinear->uvs[1];
+    mfloat_t* uv2 = bilinear->uvs[2];
+    mfloat_t* uv3 = bilinear->uvs[3];
+
+    result[0] = (uv0[0] + (uv1[0] - uv0[0]) * u) * (1.0f - v) + (uv3[0] + (uv2[0] - uv3[0]) * u) * v;
+    result[1] = (uv0[1] + (uv1[1] - uv0[1]) * u) * (1.0f - v) + (uv3[1] + (uv2[1] - uv3[1]) * u) * v;
+}
 
-        if (count == 0) continue;
+/**
+ * Solve for quad space coordinates given the quadratic's B and C terms at
+ * the point q relative to the quad origin, then map to texture UVs.
+ */
+static inline void bilinear_solve(bilinear_t* bilinear, float B, float C, float qx, float qy, bool flip, float* result) {
+    float A = bilinear->A;
+    float v;
 
-        qsort(intersections, count, sizeof(float), compare_floats);
+    if (fabsf(A) < 0.0001f) {
+        v = -C / B;
+    }
+    else {
+        float sqrd = sqrtf(B * B - 4.0f * A * C);
+        v = 0.5f * (-B + (flip ? sqrd : -sqrd)) / A;
+    }
 
-        for (int i = 0; i < count; i += 2) {
-            float x0 = floorf(intersections[i]);
-            float x1 = floorf(intersections[i + 1]);
+    float denominator_x = bilinear->b1[0] + bilinear->b3[0] * v;
+    float denominator_y = bilinear->b1[1] + bilinear->b3[1] * v;
+    float u;
 
-            graphics_draw_line(destination, x0, y, x1, y, color);
-        }
+    if (fabsf(denominator_x) > fabsf(denominator_y)) {
+        u = (qx - bilinear->b2[0] * v) / denominator_x;
+    }
+    else {
+        u = (qy - bilinear->b2[1] * v) / denominator_y;
     }
-}
-
-void graphics_draw_filled_pattern_quad(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3, texture_t* pattern, int pattern_offset_x, int pattern_offset_y) {
-    int min_y = y0;
-    min_y = fminf(min_y, y1);
-    min_y = fminf(min_y, y2);
-    min_y = fminf(min_y, y3);
 
-    int max_y = y0;
-    max_y = fmaxf(max_y, y1);
-    max_y = fmaxf(max_y, y2);
-    max_y = fmaxf(max_y, y3);
+    bilinear_uv_get(bilinear, u, v, result);
+}
 
-    mfloat_t points[4][VEC2_SIZE] = {
-        {x0, y0},
-        {x1, y1},
-        {x2, y2},
-        {x3, y3}
-    };
+/**
+ * Solve texture UVs at given screen position.
+ */
+static void bilinear_solve_at(bilinear_t* bilinear, int x, int y, bool flip, float* result) {
+    float qx = x - bilinear->origin[0];
+    float qy = y - bilinear->origin[1];
+    float B = bilinear->b3[0] * qy - bilinear->b3[1] * qx - bilinear->b1_cross_b2;
+    float C = bilinear->b1[0] * qy - bilinear->b1[1] * qx;
 
-    float intersections[4];
-    int count = 0;
+    bilinear_solve(bilinear, B, C, qx, qy, flip, result);
+}
 
-    for (int y = min_y; y <= max_y; y++) {
-        count = 0;
+/**
+ * Write texel at given UV coordinates. UVs repeat across the texture.
+ */
+static inline void bilinear_pixel_put(bilinear_t* bilinear, color_t* pixel, float* uv) {
+    texture_t* texture = bilinear->texture;
 
-        for (int i = 0; i < 4; i++) {
-            mfloat_t* a = points[i];
-            mfloat_t* b = points[(i + 1) % 4];
+    float s = frac(uv[0]) * texture->width;
+    float t = frac(uv[1]) * texture->height;
 
-            if (y <= a[1] && y <= b[1]) continue;
-            if (y > a[1] && y > b[1]) continue;
+    if (!(s >= 0 && s < texture->width && t >= 0 && t < texture->height)) return;
 
-            // Don't intersect horizontal lines
-            if (approximately(a[1], b[1])) continue;
+    color_t color = texture->pixels[(int)t * texture->stride + (int)s];
+    if (color == transparent_color) return;
 
-            mfloat_t d[VEC2_SIZE];
-            vec2_subtract(d, b, a);
-            float x = b[0] - (b[1] - y) / d[1] * d[0];
+    *pixel = blend_table ? blend_table->colors[color][*pixel] : color;
+}
 
-            intersections[count] = x;
-            count++;
-        }
+/**
+ * Draw scanline segment of a parallelogram. Quad space coordinates are
+ * linear along x so they are stepped without solving.
+ *
+ * @param start Unclipped start of the scanline segment
+ */
+static void bilinear_parallelogram_span(bilinear_t* bilinear, color_t* row, int start, int x0, int x1, int y) {
+    float qx = start - bilinear->origin[0];
+    float qy = y - bilinear->origin[1];
+    float B = -bilinear->b1_cross_b2;
+    float C = bilinear->b1[0] * qy - bilinear->b1[1] * qx;
+
+    float v = -C / B;
+    float v_step = bilinear->b1[1] / B;
+    float u;
+    float u_step;
+
+    if (fabsf(bilinear->b1[0]) > fabsf(bilinear->b1[1])) {
+        u = (qx - bilinear->b2[0] * v) / bilinear->b1[0];
+        u_step = (1.0f - bilinear->b2[0] * v_step) / bilinear->b1[0];
+    }
+    else {
+        u = (qy - bilinear->b2[1] * v) / bilinear->b1[1];
+        u_step = -bilinear->b2[1] * v_step / bilinear->b1[1];
+    }
 
-        if (count == 0) continue;
+    float uv[VEC2_SIZE];
 
-        qsort(intersections, count, sizeof(float), compare_floats);
+    // Step from the unclipped span start to avoid accumulating rounding
+    // error and so clipping doesn't change sampling
+    for (int i = x0 - start; i <= x1 - start; i++) {
+        bilinear_uv_get(bilinear, u + u_step * i, v + v_step * i, uv);
+        bilinear_pixel_put(bilinear, row + start + i, uv);
+    }
+}
 
-        for (int i = 0; i < count; i += 2) {
-            float x0 = floorf(intersections[i]);
-            float x1 = floorf(intersections[i + 1]);
-
-            graphics_draw_pattern_line(
-                destination,
-                x0, y,
-                x1, y,
-                pattern,
-                pattern_offset_x,
-                pattern_offset_y
-            );
+/**
+ * Draw scanline segment solving the mapping exactly at every pixel. The
+ * quadratic's B and C terms are linear in x and are forward differenced.
+ *
+ * @param start Position differencing starts from
+ */
+static void bilinear_exact_span(bilinear_t* bilinear, color_t* row, int start, int x0, int x1, int y, bool flip) {
+    float qx = start - bilinear->origin[0];
+    float qy = y - bilinear->origin[1];
+    float B = bilinear->b3[0] * qy - bilinear->b3[1] * qx - bilinear->b1_cross_b2;
+    float C = bilinear->b1[0] * qy - bilinear->b1[1] * qx;
+    float B_step = -bilinear->b3[1];
+    float C_step = -bilinear->b1[1];
+
+    float uv[VEC2_SIZE];
+
+    for (int x = start; x <= x1; x++) {
+        if (x >= x0) {
+            bilinear_solve(bilinear, B, C, qx, qy, flip, uv);
+            bilinear_pixel_put(bilinear, row + x, uv);
         }
+
+        qx += 1.0f;
+        B += B_step;
+        C += C_step;
     }
 }
 
-// Adapted from: https://www.reedbeta.com/blog/quadrilateral-interpolation-part-2/
-static void inverse_bilinear(mfloat_t* result, mfloat_t* p, mfloat_t* a, mfloat_t* b, mfloat_t* c, mfloat_t* d, bool flip) {
-    mfloat_t q[VEC2_SIZE];
-    mfloat_t b1[VEC2_SIZE];
-    mfloat_t b2[VEC2_SIZE];
-    mfloat_t b3[VEC2_SIZE];
+/**
+ * Draw scanline segment of a general quad. The mapping is solved exactly at
+ * the ends of short runs and interpolated linearly in between. A run falls
+ * back to solving every pixel when its midpoint is off by more than a
+ * quarter texel, which only happens where the quad is strongly non-planar.
+ * Runs are aligned to the unclipped segment so clipping doesn't change
+ * sampling.
+ *
+ * @param start Unclipped start of the scanline segment
+ * @param end Unclipped end of the scanline segment
+ */
+static void bilinear_span(bilinear_t* bilinear, color_t* row, int start, int end, int x0, int x1, int y, bool flip) {
+    float tolerance_u = 0.25f / bilinear->texture->width;
+    float tolerance_v = 0.25f / bilinear->texture->height;
 
-    vec2_subtract(q, p, a);
-    vec2_subtract(b1, b, a);
-    vec2_subtract(b2, d, a);
+    float middle[VEC2_SIZE];
 
-    // a - b - d + c
-    vec2_subtract(b3, a, b);
-    vec2_subtract(b3, b3, d);
-    vec2_add(b3, b3, c);
+    // Start at the run containing the first visible pixel
+    int x = start + (x0 - start) / QUAD_RUN_LENGTH * QUAD_RUN_LENGTH;
 
-    float A = vec2_cross(b2, b3);
-    float B = vec2_cross(b3, q) - vec2_cross(b1, b2);
-    float C = vec2_cross(b1, q);
+    float run_start[VEC2_SIZE];
+    float run_end_uv[VEC2_SIZE];
+    bilinear_solve_at(bilinear, x, y, flip, run_start);
 
-    float discriminant = 0.0f;
-    float sqrd = 0.0f;
+    while (x <= x1) {
+        int run_end = MIN(x + QUAD_RUN_LENGTH, end);
+        int length = run_end - x;
 
-    if (fabsf(A) < 0.0001f) {
-        result[1] = -C / B;
-    }
-    else {
-        discriminant = B * B - 4.0f * A * C;
-        sqrd = sqrtf(discriminant);
+        // Runs share their end pixel with the start of the next run
+        int last = run_end == end ? run_end : run_end - 1;
+
+        if (length == 0) {
+            bilinear_pixel_put(bilinear, row + x, run_start);
+            break;
+        }
+
+        int first = MAX(x, x0);
+        int stop = MIN(last, x1);
 
-        if (flip) {
-            result[1] = 0.5f * (-B + sqrd) / A;
+        bilinear_solve_at(bilinear, run_end, y, flip, run_end_uv);
+        bilinear_solve_at(bilinear, x + length / 2, y, flip, middle);
+
+        float t = (length / 2) / (float)length;
+        float error_u = run_start[0] + (run_end_uv[0] - run_start[0]) * t - middle[0];
+        float error_v = run_start[1] + (run_end_uv[1] - run_start[1]) * t - middle[1];
+
+        if (fabsf(error_u) <= tolerance_u && fabsf(error_v) <= tolerance_v) {
+            float step_u = (run_end_uv[0] - run_start[0]) / length;
+            float step_v = (run_end_uv[1] - run_start[1]) / length;
+            float uv[VEC2_SIZE];
+
+            for (int i = first - x; i <= stop - x; i++) {
+                uv[0] = run_start[0] + step_u * i;
+                uv[1] = run_start[1] + step_v * i;
+                bilinear_pixel_put(bilinear, row + x + i, uv);
+            }
         }
         else {
-            result[1] = 0.5f * (-B - sqrd) / A;
+            bilinear_exact_span(bilinear, row, x, first, stop, y, flip);
         }
-    }
-
-    mfloat_t denominator[VEC2_SIZE];
-    mfloat_t bb3[VEC2_SIZE];
-    vec2_multiply_f(bb3, b3, result[1]);
-    vec2_add(denominator, b1, bb3);
 
-    if (fabsf(denominator[0]) > fabsf(denominator[1])) {
-        result[0] = (q[0] - b2[0] * result[1]) / denominator[0];
-    }
-    else {
-        result[0] = (q[1] - b2[1] * result[1]) / denominator[1];
+        vec2_assign(run_start, run_end_uv);
+        x = last + 1;
     }
 }
 
@@ -877,11 +3056,22 @@ typedef struct intersection {
     int index;
 } intersection_t;
 
-static int compare_intersections(const void* a, const void* b) {
-    intersection_t* A = (intersection_t*)a;
-    intersection_t* B = (intersection_t*)b;
+/**
+ * Sort scanline intersections by x. There are at most four so an insertion
+ * sort is used.
+ */
+static void intersections_sort(intersection_t* intersections, int count) {
+    for (int i = 1; i < count; i++) {
+        intersection_t current = intersections[i];
+        int j = i - 1;
+
+        while (j >= 0 && intersections[j].x > current.x) {
+            intersections[j + 1] = intersections[j];
+            j--;
+        }
 
-    return A->x > B->x;
+        intersections[j + 1] = current;
+    }
 }
 
 void graphics_draw_textured_quad(texture_t* destination, int x0, int y0, float u0, float v0, int x1, int y1, float u1, float v1, int x2, int y2, float u2, float v2, int x3, int y3, float u3, float v3, texture_t* texture_map) {
@@ -895,6 +3085,13 @@ void graphics_draw_textured_quad(texture_t* destination, int x0, int y0, float u
     max_y = fmaxf(max_y, y2);
     max_y = fmaxf(max_y, y3);
 
+    rect_t bounds;
+    if (!drawable_bounds_get(destination, &bounds)) return;
+
+    // Only visit scanlines inside the drawable region
+    min_y = MAX(min_y, bounds.y);
+    max_y = MIN(max_y, bounds.y + bounds.height - 1);
+
     mfloat_t points[4][VEC2_SIZE] = {
         {x0, y0},
         {x1, y1},
@@ -915,6 +3112,12 @@ void graphics_draw_textured_quad(texture_t* destination, int x0, int y0, float u
     vec2_subtract(edge_vectors[2], points[3], points[2]);
     vec2_subtract(edge_vectors[3], points[0], points[3]);
 
+    bilinear_t bilinear;
+    bilinear_init(&bilinear, points, uvs, texture_map);
+
+    // Opposite edges are parallel, so the mapping is affine
+    bool parallelogram = bilinear.b3[0] == 0 && bilinear.b3[1] == 0 && bilinear.b1_cross_b2 != 0;
+
     intersection_t intersections[4];
     int count = 0;
 
@@ -941,11 +3144,9 @@ void graphics_draw_textured_quad(texture_t* destination, int x0, int y0, float u
 
         if (count == 0) continue;
 
-        qsort(intersections, count, sizeof(intersection_t), compare_intersections);
+        intersections_sort(intersections, count);
 
-        mfloat_t uv[VEC2_SIZE];
-        mfloat_t st[VEC2_SIZE];
-        mfloat_t p[VEC2_SIZE];
+        color_t* row = destination->pixels + y * destination->stride;
         mfloat_t r[VEC2_SIZE];
 
         // Draw all scanline segments
@@ -953,6 +3154,17 @@ void graphics_draw_textured_quad(texture_t* destination, int x0, int y0, float u
             float x0 = floorf(intersections[i].x);
             float x1 = floorf(intersections[i + 1].x);
 
+            // Clip scanline segment to drawable region
+            int left = MAX((int)x0, bounds.x);
+            int right = MIN((int)x1, bounds.x + bounds.width - 1);
+
+            if (left > right) continue;
+
+            if (parallelogram) {
+                bilinear_parallelogram_span(&bilinear, row, x0, left, right, y);
+                continue;
+            }
+
             int j = intersections[i].index;
 
             // Vector from edge tail to tip
@@ -964,161 +3176,408 @@ void graphics_draw_textured_quad(texture_t* destination, int x0, int y0, float u
 
             bool flip = vec2_cross(e, r) > 0;
 
-            // Draw scanline segment
-            for (int x = x0; x <= x1; x++) {
-                vec2(p, x, y);
+            bilinear_span(&bilinear, row, x0, x1, left, right, y, flip);
+        }
+    }
+}
+
+void graphics_draw_texture(texture_t* destination, texture_t* source, int x, int y, int width, int height) {
+    rect_t bounds;
+    if (!drawable_bounds_get(destination, &bounds)) return;
+
+    rect_t source_rect = {0, 0, source->width, source->height};
+    rect_t dest_rect = {x, y, width, height};
+
+    draw_blit(destination, &bounds, source, &source_rect, &dest_rect);
+}
+
+void graphics_draw_sprite(texture_t* destination, sprite_t* sprite, int x, int y, bool flip_x, bool flip_y) {
+    rect_t bounds;
+    if (!drawable_bounds_get(destination, &bounds)) return;
+
+    int left = bounds.x;
+    int right = bounds.x + bounds.width;
+    int top = MAX(y, bounds.y);
+    int bottom = MIN((int64_t)y + sprite->height, bounds.y + bounds.height);
+
+    // Runs never hold the sprite's transparent color, so they can be copied
+    // as is unless the palette, transparent color or blending could change
+    // them
+    const blend_table_t* blend = blend_table;
+    bool copy = !blend && palette_is_identity() && transparent_color == sprite->transparent;
+
+    for (int dy = top; dy < bottom; dy++) {
+        int row = flip_y ? sprite->height - 1 - (dy - y) : dy - y;
+        color_t* pixels = destination->pixels + dy * destination->stride;
+
+        for (int r = sprite->rows[row]; r < sprite->rows[row + 1]; r++) {
+            sprite_run_t* run = &sprite->runs[r];
+            const color_t* source = sprite->pixels + run->offset;
+
+            int64_t start = (int64_t)x + (flip_x ? sprite->width - run->x - run->length : run->x);
+            int x0 = MAX(start, left);
+            int x1 = MIN(start + run->length, right);
+            if (x0 >= x1) continue;
+
+            if (!flip_x) {
+                source += x0 - start;
+
+                if (copy) {
+                    memcpy(pixels + x0, source, x1 - x0);
+                    continue;
+                }
+
+                for (int i = 0; i < x1 - x0; i++) {
+                    color_t pixel = draw_palette[source[i]];
+                    if (pixel == transparent_color) continue;
+
+                    pixels[x0 + i] = blend ? blend->colors[pixel][pixels[x0 + i]] : pixel;
+                }
 
-                // Get mapping in quad space
-                inverse_bilinear(uv, p, points[0], points[1], points[2], points[3], flip);
+                continue;
+            }
+
+            // Mirrored runs are read backwards from their last pixel
+            source += run->length - 1 - (x0 - start);
+
+            for (int i = 0; i < x1 - x0; i++) {
+                color_t pixel = draw_palette[source[-i]];
+                if (pixel == transparent_color) continue;
+
+                pixels[x0 + i] = blend ? blend->colors[pixel][pixels[x0 + i]] : pixel;
+            }
+        }
+    }
+}
+
+void graphics_draw_sprite_batch(texture_t* destination, sprite_batch_t* batch) {
+    rect_t bounds;
+    if (!drawable_bounds_get(destination, &bounds)) return;
+
+    if (!graphics_sprite_batch_sort(batch)) return;
+
+    // Remap table for the current palette offset. Rebuilt only when the
+    // offset changes between sprites.
+    color_t palette[256];
+    int palette_offset = -1;
+    bool identity = palette_is_identity();
+
+    blit_t blit = {
+        .transparent = transparent_color,
+        .palette = palette,
+        .blend = blend_table
+    };
+
+    int right = bounds.x + bounds.width;
+    int bottom = bounds.y + bounds.height;
+
+    for (size_t i = 0; i < batch->count; i++) {
+        sprite_batch_entry_t* entry = &batch->entries[batch->order[i]];
+
+        int width = entry->source.width;
+        int height = entry->source.height;
+        if (width <= 0 || height <= 0) continue;
 
-                // Map quad space to UV space
-                vec2_bilinear(uv, uvs[0], uvs[1], uvs[3], uvs[2], uv[0], uv[1]);
+        // Reject sprites outside the drawable region before any setup
+        if (entry->x >= right || entry->y >= bottom) continue;
+        if ((int64_t)entry->x + width <= bounds.x || (int64_t)entry->y + height <= bounds.y) continue;
 
-                int w = graphics_texture_width_get(texture_map);
-                int h = graphics_texture_height_get(texture_map);
+        if (entry->palette_offset != palette_offset) {
+            palette_offset = entry->palette_offset;
 
-                // Texture repeat
-                vec2(st, frac(uv[0]) * w, frac(uv[1]) * h);
-                vec2_floor(st, st);
+            // Offset colors are remapped by the draw palette, but the
+            // transparent color stays transparent
+            for (int c = 0; c < 256; c++) {
+                palette[c] = draw_palette[(c + palette_offset) & 0xFF];
+            }
+
+            if (palette_offset != 0) {
+                palette[transparent_color] = transparent_color;
+            }
 
-                color_t color = graphics_texture_pixel_get(texture_map, st[0], st[1]);
-                graphics_draw_pixel(destination, x, y, color);
+            if (blend_table) {
+                blit.mode = BLIT_BLENDED;
+            }
+            else {
+                blit.mode = identity && palette_offset == 0 ? BLIT_KEYED : BLIT_REMAPPED;
             }
         }
+
+        // Mirrored sprites sample their source backwards
+        rect_t source_rect = entry->source;
+        rect_t dest_rect = {entry->x, entry->y, width, height};
+
+        if (entry->flip_x) {
+            source_rect.x += width;
+            source_rect.width = -width;
+        }
+
+        if (entry->flip_y) {
+            source_rect.y += height;
+            source_rect.height = -height;
+        }
+
+        graphics_blit_rect(destination, &bounds, entry->texture, &source_rect, &dest_rect, &blit);
     }
 }
 
-void graphics_draw_texture(texture_t* destination, texture_t* source, int x, int y, int width, int height) {
-    rect_t dest_rect = {x, y, width, height};
+#define AFFINE_FRACTION_BITS 16
+#define AFFINE_ONE (1 << AFFINE_FRACTION_BITS)
+
+// Largest fixed-point value allowed, so stepping across any destination
+// can't overflow
+#define AFFINE_LIMIT ((double)((int64_t)1 << 46))
+
+/**
+ * Affine mapping from destination pixels to source texels in 16.16 fixed
+ * point. The texel coordinate sampled by pixel x, y is s_x * x + s_y * y + s_c
+ * and likewise for t. Everything after setup is integer math, so the texel a
+ * pixel samples doesn't depend on how the span was clipped.
+ */
+typedef struct affine {
+    texture_t* texture;
+    texture_wrap_t wrap;
+    int64_t s_x;
+    int64_t s_y;
+    int64_t s_c;
+    int64_t t_x;
+    int64_t t_y;
+    int64_t t_c;
+} affine_t;
 
-    graphics_blit(
-        source,
-        destination,
-        NULL,
-        &dest_rect,
-        draw_blit_func
-    );
-}
-
-void graphics_draw_affine_texture(texture_t* destination, texture_t* source, mfloat_t* matrix) {
-    /**
-     * Rendering a texture with an affine transformation:
-     *
-     * 1. Transform bounding points of 0-1 UV space to screen space.
-     *
-     * 2. Determine bounds of transformed points.
-     *
-     * 3. Calculate first scanline UV coords by multipling by inverse matrix.
-     *
-     * 4. Calculate UV increment vector.
-     *
-     * 5. Render bounds as a series of scanlines.
-     *
-     *    a. Clip current scanline & UVs to screen.
-     *
-     *    b. Render clipped scanline using graphics_draw_textured_line.
-     *
-     *    c. Update current UV coords by UV increment vector.
-     */
-
-    // 1. Transform UV space bounds to screen space
-    mfloat_t p0[VEC3_SIZE] = {0, 0, 1};
-    mfloat_t p1[VEC3_SIZE] = {0, 1, 1};
-    mfloat_t p2[VEC3_SIZE] = {1, 1, 1};
-    mfloat_t p3[VEC3_SIZE] = {1, 0, 1};
-
-    vec3_multiply_mat3(p0, p0, matrix);
-    vec3_multiply_mat3(p1, p1, matrix);
-    vec3_multiply_mat3(p2, p2, matrix);
-    vec3_multiply_mat3(p3, p3, matrix);
-
-    // 2. Determine screen space bounds
-    mfloat_t min[VEC3_SIZE];
-    mfloat_t max[VEC3_SIZE];
-    vec3_assign(min, p0);
-    vec3_assign(max, p0);
-
-    vec3_min(min, min, p1);
-    vec3_min(min, min, p2);
-    vec3_min(min, min, p3);
-
-    vec3_max(max, max, p1);
-    vec3_max(max, max, p2);
-    vec3_max(max, max, p3);
-
-    vec3_floor(min, min);
-    vec3_floor(max, max);
-
-    // Get screen to UV transformation
+/**
+ * Set up mapping from the inverse of a matrix that transforms 0-1 UV space to
+ * screen space.
+ *
+ * @return true if successful, false if the matrix can't be inverted
+ */
+static bool affine_init(affine_t* affine, texture_t* texture, mfloat_t* matrix, texture_wrap_t wrap) {
     mfloat_t inverse[MAT3_SIZE];
     mat3_inverse(inverse, matrix);
 
-    // 3. Calculate UV coordinates for first scanline
-    mfloat_t uv0[VEC3_SIZE];
-    mfloat_t uv1[VEC3_SIZE];
-    vec3(uv0, min[0], min[1], 1);
-    vec3(uv1, max[0] + 1, min[1], 1);
-    vec3_multiply_mat3(uv0, uv0, inverse);
-    vec3_multiply_mat3(uv1, uv1, inverse);
-
-    // 4. Calculate UV increment vector
-    mfloat_t inc[VEC3_SIZE];
-    float one_pixel_vertical = 1.0f / graphics_texture_height_get(source);
-    vec3(inc, 0, 1.0f + one_pixel_vertical, 0);
-    vec3_multiply_mat3(inc, inc, inverse);
-
-    int max_height = graphics_texture_height_get(destination);
-    int max_width = graphics_texture_width_get(destination);
-
-    // 5. Render scanlines
-    for (int y = min[1]; y < max[1]; y++) {
-        if (y >= max_height) break;
-
-        if (y >= 0) {
-            // Clip scanline to screen
-            mfloat_t d[VEC3_SIZE];
-            vec3_subtract(d, uv1, uv0);
-
-            float x0 = min[0];
-            float x1 = max[0];
-            float u0 = uv0[0];
-            float v0 = uv0[1];
-            float u1 = uv1[0];
-            float v1 = uv1[1];
-
-            // 5a. Clip scanline
-
-            // Clip left
-            if (x0 < 0) {
-                float t = x0 / (x1 - x0);
-                x0 = 0;
-                u0 = u0 - d[0] * t;
-                v0 = v0 - d[1] * t;
+    // UV at the center of pixel 0, 0 and UV step along each axis
+    mfloat_t origin[VEC3_SIZE] = {0.5f, 0.5f, 1};
+    mfloat_t step_x[VEC3_SIZE] = {1, 0, 0};
+    mfloat_t step_y[VEC3_SIZE] = {0, 1, 0};
+
+    vec3_multiply_mat3(origin, origin, inverse);
+    vec3_multiply_mat3(step_x, step_x, inverse);
+    vec3_multiply_mat3(step_y, step_y, inverse);
+
+    double width = (double)texture->width * AFFINE_ONE;
+    double height = (double)texture->height * AFFINE_ONE;
+
+    double values[6] = {
+        step_x[0] * width,
+        step_y[0] * width,
+        origin[0] * width,
+        step_x[1] * height,
+        step_y[1] * height,
+        origin[1] * height
+    };
+
+    // Also rejects the infinities and NaNs of singular matrices
+    for (int i = 0; i < 6; i++) {
+        if (!(fabs(values[i]) < AFFINE_LIMIT)) return false;
+    }
+
+    affine->texture = texture;
+    affine->wrap = wrap;
+    affine->s_x = llround(values[0]);
+    affine->s_y = llround(values[1]);
+    affine->s_c = llround(values[2]);
+    affine->t_x = llround(values[3]);
+    affine->t_y = llround(values[4]);
+    affine->t_c = llround(values[5]);
+
+    return true;
+}
+
+/**
+ * Narrow x0, x1 to the pixels where step * x + start is in [0, limit).
+ *
+ * @return true if any pixels remain, false otherwise
+ */
+static bool affine_range_clip(int64_t step, int64_t start, int64_t limit, int* x0, int* x1) {
+    int64_t first = *x0;
+    int64_t last = *x1;
+
+    if (step > 0) {
+        first = MAX(first, ceil_div(-start, step));
+        last = MIN(last, floor_div(limit - 1 - start, step));
+    }
+    else if (step < 0) {
+        first = MAX(first, ceil_div(start - limit + 1, -step));
+        last = MIN(last, floor_div(start, -step));
+    }
+    else if (start < 0 || start >= limit) {
+        return false;
+    }
+
+    *x0 = first;
+    *x1 = last;
+
+    return first <= last;
+}
+
+/**
+ * Texel index of a fixed-point coordinate, rounding towards negative
+ * infinity.
+ */
+static inline int64_t affine_texel(int64_t value) {
+    return value >= 0 ? value / AFFINE_ONE : -((-value + AFFINE_ONE - 1) / AFFINE_ONE);
+}
+
+/**
+ * Draw pixels x0 to x1 inclusive of row y. The span must already be clipped
+ * to the drawable region.
+ */
+static void affine_span(texture_t* destination, affine_t* affine, int x0, int x1, int y) {
+    texture_t* texture = affine->texture;
+
+    // Copied to locals since pixel writes could alias them
+    const color_t* pixels = texture->pixels;
+    int width = texture->width;
+    int height = texture->height;
+    int stride = texture->stride;
+    color_t transparent = transparent_color;
+    const blend_table_t* blend = blend_table;
+
+    int64_t s_x = affine->s_x;
+    int64_t t_x = affine->t_x;
+    int64_t s_row = affine->s_y * y + affine->s_c;
+    int64_t t_row = affine->t_y * y + affine->t_c;
+
+    color_t* row = destination->pixels + y * destination->stride;
+
+    switch (affine->wrap) {
+        case TEXTURE_WRAP_BORDER: {
+            // Only pixels sampling inside the texture are drawn, so the span
+            // is narrowed once and texels are read without checks
+            if (!affine_range_clip(s_x, s_row, (int64_t)width << AFFINE_FRACTION_BITS, &x0, &x1)) return;
+            if (!affine_range_clip(t_x, t_row, (int64_t)height << AFFINE_FRACTION_BITS, &x0, &x1)) return;
+
+            int64_t s = s_row + s_x * x0;
+            int64_t t = t_row + t_x * x0;
+
+            for (int x = x0; x <= x1; x++) {
+                color_t c = pixels[(t >> AFFINE_FRACTION_BITS) * stride + (s >> AFFINE_FRACTION_BITS)];
+                if (c != transparent) row[x] = blend ? blend->colors[c][row[x]] : c;
+
+                s += s_x;
+                t += t_x;
+            }
+            break;
+        }
+
+        case TEXTURE_WRAP_REPEAT: {
+            int64_t s = s_row + s_x * x0;
+            int64_t t = t_row + t_x * x0;
+
+            // Power of two sizes wrap with a mask. Unsigned shifts keep the
+            // low bits of negative coordinates.
+            if ((width & (width - 1)) == 0 && (height & (height - 1)) == 0) {
+                uint64_t s_mask = width - 1;
+                uint64_t t_mask = height - 1;
+
+                for (int x = x0; x <= x1; x++) {
+                    uint64_t sx = ((uint64_t)s >> AFFINE_FRACTION_BITS) & s_mask;
+                    uint64_t sy = ((uint64_t)t >> AFFINE_FRACTION_BITS) & t_mask;
+                    color_t c = pixels[sy * stride + sx];
+                    if (c != transparent) row[x] = blend ? blend->colors[c][row[x]] : c;
+
+                    s += s_x;
+                    t += t_x;
+                }
+                break;
+            }
+
+            for (int x = x0; x <= x1; x++) {
+                int64_t sx = affine_texel(s) % width;
+                int64_t sy = affine_texel(t) % height;
+                if (sx < 0) sx += width;
+                if (sy < 0) sy += height;
+
+                color_t c = pixels[sy * stride + sx];
+                if (c != transparent) row[x] = blend ? blend->colors[c][row[x]] : c;
+
+                s += s_x;
+                t += t_x;
+            }
+            break;
+        }
+
+        case TEXTURE_WRAP_CLAMP: {
+            int64_t s = s_row + s_x * x0;
+            int64_t t = t_row + t_x * x0;
+
+            for (int x = x0; x <= x1; x++) {
+                int64_t sx = MIN(MAX(affine_texel(s), 0), width - 1);
+                int64_t sy = MIN(MAX(affine_texel(t), 0), height - 1);
+
+                color_t c = pixels[sy * stride + sx];
+                if (c != transparent) row[x] = blend ? blend->colors[c][row[x]] : c;
+
+                s += s_x;
+                t += t_x;
             }
+            break;
+        }
+    }
+}
 
-            // Clip right
-            float w = max_width - 1;
-            if (x1 > w) {
-                float t = (x1 - w) / (x1 - x0);
-                x1 = w;
-                u1 = u1 - d[0] * t;
-                v1 = v1 - d[1] * t;
+void graphics_draw_affine_texture(texture_t* destination, texture_t* source, mfloat_t* matrix, texture_wrap_t wrap) {
+    if (source->width <= 0 || source->height <= 0) return;
+
+    rect_t bounds;
+    if (!drawable_bounds_get(destination, &bounds)) return;
+
+    affine_t affine;
+    if (!affine_init(&affine, source, matrix, wrap)) return;
+
+    int left = bounds.x;
+    int top = bounds.y;
+    int right = bounds.x + bounds.width - 1;
+    int bottom = bounds.y + bounds.height - 1;
+
+    // With a border nothing is drawn outside the transformed texture, so
+    // only its bounding box needs to be walked
+    if (wrap == TEXTURE_WRAP_BORDER) {
+        mfloat_t corners[4][VEC3_SIZE] = {
+            {0, 0, 1},
+            {0, 1, 1},
+            {1, 1, 1},
+            {1, 0, 1}
+        };
+
+        mfloat_t min[VEC3_SIZE];
+        mfloat_t max[VEC3_SIZE];
+
+        for (int i = 0; i < 4; i++) {
+            vec3_multiply_mat3(corners[i], corners[i], matrix);
+
+            if (i == 0) {
+                vec3_assign(min, corners[i]);
+                vec3_assign(max, corners[i]);
             }
 
-            // 5b. Draw scanline
-            graphics_draw_textured_line(
-                destination,
-                x0, y,
-                u0, v0,
-                x1, y,
-                u1, v1,
-                source
-            );
+            vec3_min(min, min, corners[i]);
+            vec3_max(max, max, corners[i]);
         }
 
-        // 5c. Increment UV coords
-        vec3_add(uv0, uv0, inc);
-        vec3_add(uv1, uv1, inc);
+        vec3_floor(min, min);
+        vec3_floor(max, max);
+
+        if (!(min[0] <= right && max[0] >= left && min[1] <= bottom && max[1] >= top)) return;
+
+        if (min[0] > left) left = min[0];
+        if (min[1] > top) top = min[1];
+        if (max[0] < right) right = max[0];
+        if (max[1] < bottom) bottom = max[1];
+    }
+
+    for (int y = top; y <= bottom; y++) {
+        affine_span(destination, &affine, left, right, y);
     }
 }
 
@@ -1144,6 +3603,14 @@ int graphics_draw_transparent_color_get(void) {
     return transparent_color;
 }
 
+void graphics_draw_blend_table_set(blend_table_t* table) {
+    blend_table = table;
+}
+
+blend_table_t* graphics_draw_blend_table_get(void) {
+    return blend_table;
+}
+
 void graphics_draw_clipping_rectangle_set(rect_t* rect) {
     texture_t* render_texture = graphics_render_texture_get();
 
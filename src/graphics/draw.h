@@ -3,8 +3,34 @@
 
 #include <mathc/mathc.h>
 
+#include "blend.h"
+#include "sprite_batch.h"
 #include "types.h"
 
+/**
+ * Rule deciding which regions of a self-intersecting polygon are filled.
+ *
+ * FILL_RULE_EVEN_ODD fills regions enclosed by an odd number of edges.
+ * FILL_RULE_NON_ZERO fills regions the outline winds around at least once.
+ */
+typedef enum {
+    FILL_RULE_EVEN_ODD,
+    FILL_RULE_NON_ZERO
+} fill_rule_t;
+
+/**
+ * How texture coordinates outside of a texture are sampled.
+ *
+ * TEXTURE_WRAP_BORDER draws nothing outside of the texture.
+ * TEXTURE_WRAP_CLAMP repeats the texture's edge texels.
+ * TEXTURE_WRAP_REPEAT tiles the texture.
+ */
+typedef enum {
+    TEXTURE_WRAP_BORDER,
+    TEXTURE_WRAP_CLAMP,
+    TEXTURE_WRAP_REPEAT
+} texture_wrap_t;
+
 /**
  * Draw pixel at x, y with given color
  *
@@ -58,7 +84,64 @@ void graphics_draw_pattern_line(texture_t* destination, int x0, int y0, int x1,
 void graphics_draw_textured_line(texture_t* destination, int x0, int y0, float u0, float v0, int x1, int y1, float u1, float v1, texture_t* texture_map);
 
 /**
- * Draw bezier curve
+ * Draw quadratic bezier curve. Curves are split into as few line segments
+ * as keep them within a quarter pixel of the true curve, and each pixel is
+ * drawn once.
+ *
+ * @param destination Texture to draw to
+ * @param x0 Start anchor point x-coordinate
+ * @param y0 Start anchor point y-coordinate
+ * @param x1 Control point x-coordinate
+ * @param y1 Control point y-coordinate
+ * @param x2 End anchor point x-coordinate
+ * @param y2 End anchor point y-coordinate
+ * @param color Curve color
+ */
+void graphics_draw_quadratic_bezier(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, color_t color);
+
+/**
+ * Draw quadratic bezier curve with given pattern.
+ *
+ * @param destination Texture to draw to
+ * @param x0 Start anchor point x-coordinate
+ * @param y0 Start anchor point y-coordinate
+ * @param x1 Control point x-coordinate
+ * @param y1 Control point y-coordinate
+ * @param x2 End anchor point x-coordinate
+ * @param y2 End anchor point y-coordinate
+ * @param pattern Texture to use as a pattern
+ * @param offset_x Pattern x-axis offset
+ * @param offset_y Pattern y-axis offset
+ */
+void graphics_draw_pattern_quadratic_bezier(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, texture_t* pattern, int pattern_offset_x, int pattern_offset_y);
+
+/**
+ * Draw list of quadratic bezier curves. Curves starting where the previous
+ * one ended are drawn as one continuous stroke.
+ *
+ * @param destination Texture to draw to
+ * @param points Interleaved x, y coordinates, three points per curve
+ * @param count Number of points. Leftover points are ignored.
+ * @param color Curve color
+ */
+void graphics_draw_quadratic_beziers(texture_t* destination, const int* points, int count, color_t color);
+
+/**
+ * Draw list of quadratic bezier curves with given pattern.
+ *
+ * @param destination Texture to draw to
+ * @param points Interleaved x, y coordinates, three points per curve
+ * @param count Number of points. Leftover points are ignored.
+ * @param pattern Texture to use as a pattern
+ * @param offset_x Pattern x-axis offset
+ * @param offset_y Pattern y-axis offset
+ */
+void graphics_draw_pattern_quadratic_beziers(texture_t* destination, const int* points, int count, texture_t* pattern, int pattern_offset_x, int pattern_offset_y);
+
+/**
+ * Draw bezier curve. Curves are split into as few line segments as keep
+ * them within a quarter pixel of the true curve, and each pixel is drawn
+ * once.
  *
  * @param destination Texture to draw to
  * @param x0 Start anchor point x-coordinate
@@ -91,6 +174,29 @@ void graphics_draw_bezier(texture_t* destination, int x0, int y0, int x1, int y1
  */
 void graphics_draw_pattern_bezier(texture_t* destination, int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3, texture_t* pattern, int pattern_offset_x, int pattern_offset_y);
 
+/**
+ * Draw list of bezier curves. Curves starting where the previous one ended
+ * are drawn as one continuous stroke.
+ *
+ * @param destination Texture to draw to
+ * @param points Interleaved x, y coordinates, four points per curve
+ * @param count Number of points. Leftover points are ignored.
+ * @param color Curve color
+ */
+void graphics_draw_beziers(texture_t* destination, const int* points, int count, color_t color);
+
+/**
+ * Draw list of bezier curves with given pattern.
+ *
+ * @param destination Texture to draw to
+ * @param points Interleaved x, y coordinates, four points per curve
+ * @param count Number of points. Leftover points are ignored.
+ * @param pattern Texture to use as a pattern
+ * @param offset_x Pattern x-axis offset
+ * @param offset_y Pattern y-axis offset
+ */
+void graphics_draw_pattern_beziers(texture_t* destination, const int* points, int count, texture_t* pattern, int pattern_offset_x, int pattern_offset_y);
+
 /**
  * Draw rectangle.
  *
@@ -143,6 +249,85 @@ void graphics_draw_filled_rectangle(texture_t* destination, int x, int y, int wi
  */
 void graphics_draw_filled_pattern_rectangle(texture_t* destination, int x, int y, int width, int height, texture_t* pattern, int pattern_offset_x, int pattern_offset_y);
 
+/**
+ * Draw rectangle with rounded corners.
+ *
+ * @param destination Texture to draw to
+ * @param x Rect top left x-coordinate
+ * @param y Rect top left y-coordinate
+ * @param width Rect width
+ * @param height Rect height
+ * @param radius Corner radius, limited to what fits in the rectangle
+ * @param color Line color
+ */
+void graphics_draw_rounded_rectangle(texture_t* destination, int x, int y, int width, int height, int radius, color_t color);
+
+/**
+ * Draw rectangle with rounded corners with given pattern.
+ *
+ * @param destination Texture to draw to
+ * @param x Rect top left x-coordinate
+ * @param y Rect top left y-coordinate
+ * @param width Rect width
+ * @param height Rect height
+ * @param radius Corner radius, limited to what fits in the rectangle
+ * @param pattern Texture to use as a pattern
+ * @param offset_x Pattern x-axis offset
+ * @param offset_y Pattern y-axis offset
+ */
+void graphics_draw_pattern_rounded_rectangle(texture_t* destination, int x, int y, int width, int height, int radius, texture_t* pattern, int pattern_offset_x, int pattern_offset_y);
+
+/**
+ * Draw filled rectangle with rounded corners.
+ *
+ * @param destination Texture to draw to
+ * @param x Rect top left x-coordinate
+ * @param y Rect top left y-coordinate
+ * @param width Rect width
+ * @param height Rect height
+ * @param radius Corner radius, limited to what fits in the rectangle
+ * @param color Fill color
+ */
+void graphics_draw_filled_rounded_rectangle(texture_t* destination, int x, int y, int width, int height, int radius, color_t color);
+
+/**
+ * Draw filled rectangle with rounded corners with given pattern.
+ *
+ * @param destination Texture to draw to
+ * @param x Rect top left x-coordinate
+ * @param y Rect top left y-coordinate
+ * @param width Rect width
+ * @param height Rect height
+ * @param radius Corner radius, limited to what fits in the rectangle
+ * @param pattern Texture to use as a pattern
+ * @param offset_x Pattern x-axis offset
+ * @param offset_y Pattern y-axis offset
+ */
+void graphics_draw_filled_pattern_rounded_rectangle(texture_t* destination, int x, int y, int width, int height, int radius, texture_t* pattern, int pattern_offset_x, int pattern_offset_y);
+
+/**
+ * Fill region of pixels sharing the color at x, y and connected to it
+ * horizontally or vertically. The region ends at the clipping rectangle.
+ *
+ * @param destination Texture to draw to
+ * @param x Start x-coordinate
+ * @param y Start y-coordinate
+ * @param color Fill color
+ */
+void graphics_draw_flood_fill(texture_t* destination, int x, int y, color_t color);
+
+/**
+ * Fill region of pixels sharing the color at x, y with given pattern.
+ *
+ * @param destination Texture to draw to
+ * @param x Start x-coordinate
+ * @param y Start y-coordinate
+ * @param pattern Texture to use as a pattern
+ * @param offset_x Pattern x-axis offset
+ * @param offset_y Pattern y-axis offset
+ */
+void graphics_draw_pattern_flood_fill(texture_t* destination, int x, int y, texture_t* pattern, int pattern_offset_x, int pattern_offset_y);
+
 /**
  * Draw circle.
  *
@@ -191,6 +376,122 @@ void graphics_draw_filled_circle(texture_t* destination, int x, int y, int radiu
  */
 void graphics_draw_filled_pattern_circle(texture_t* destination, int x, int y, int radius, texture_t* pattern, int pattern_offset_x, int pattern_offset_y);
 
+/**
+ * Draw ellipse.
+ *
+ * @param destination Texture to draw to
+ * @param x Ellipse center x-coordinate
+ * @param y Ellipse center y-coordinate
+ * @param radius_x Ellipse radius along the x-axis
+ * @param radius_y Ellipse radius along the y-axis
+ * @param color Line color
+ */
+void graphics_draw_ellipse(texture_t* destination, int x, int y, int radius_x, int radius_y, color_t color);
+
+/**
+ * Draw ellipse with given pattern.
+ *
+ * @param destination Texture to draw to
+ * @param x Ellipse center x-coordinate
+ * @param y Ellipse center y-coordinate
+ * @param radius_x Ellipse radius along the x-axis
+ * @param radius_y Ellipse radius along the y-axis
+ * @param pattern Texture to use as a pattern
+ * @param offset_x Pattern x-axis offset
+ * @param offset_y Pattern y-axis offset
+ */
+void graphics_draw_pattern_ellipse(texture_t* destination, int x, int y, int radius_x, int radius_y, texture_t* pattern, int pattern_offset_x, int pattern_offset_y);
+
+/**
+ * Draw filled ellipse.
+ *
+ * @param destination Texture to draw to
+ * @param x Ellipse center x-coordinate
+ * @param y Ellipse center y-coordinate
+ * @param radius_x Ellipse radius along the x-axis
+ * @param radius_y Ellipse radius along the y-axis
+ * @param color Fill color
+ */
+void graphics_draw_filled_ellipse(texture_t* destination, int x, int y, int radius_x, int radius_y, color_t color);
+
+/**
+ * Draw filled ellipse with given pattern.
+ *
+ * @param destination Texture to draw to
+ * @param x Ellipse center x-coordinate
+ * @param y Ellipse center y-coordinate
+ * @param radius_x Ellipse radius along the x-axis
+ * @param radius_y Ellipse radius along the y-axis
+ * @param pattern Texture to use as a pattern
+ * @param offset_x Pattern x-axis offset
+ * @param offset_y Pattern y-axis offset
+ */
+void graphics_draw_filled_pattern_ellipse(texture_t* destination, int x, int y, int radius_x, int radius_y, texture_t* pattern, int pattern_offset_x, int pattern_offset_y);
+
+/**
+ * Draw arc.
+ * Angles go clockwise from the positive x-axis. Arcs spanning a full
+ * turn or more draw the whole circle.
+ *
+ * @param destination Texture to draw to
+ * @param x Arc center x-coordinate
+ * @param y Arc center y-coordinate
+ * @param radius Arc radius
+ * @param start_angle Start angle in radians
+ * @param end_angle End angle in radians
+ * @param color Line color
+ */
+void graphics_draw_arc(texture_t* destination, int x, int y, int radius, float start_angle, float end_angle, color_t color);
+
+/**
+ * Draw arc with given pattern.
+ * Angles go clockwise from the positive x-axis. Arcs spanning a full
+ * turn or more draw the whole circle.
+ *
+ * @param destination Texture to draw to
+ * @param x Arc center x-coordinate
+ * @param y Arc center y-coordinate
+ * @param radius Arc radius
+ * @param start_angle Start angle in radians
+ * @param end_angle End angle in radians
+ * @param pattern Texture to use as a pattern
+ * @param offset_x Pattern x-axis offset
+ * @param offset_y Pattern y-axis offset
+ */
+void graphics_draw_pattern_arc(texture_t* destination, int x, int y, int radius, float start_angle, float end_angle, texture_t* pattern, int pattern_offset_x, int pattern_offset_y);
+
+/**
+ * Draw arc filled to its center, like a slice of pie.
+ * Angles go clockwise from the positive x-axis. Arcs spanning a full
+ * turn or more draw the whole circle.
+ *
+ * @param destination Texture to draw to
+ * @param x Arc center x-coordinate
+ * @param y Arc center y-coordinate
+ * @param radius Arc radius
+ * @param start_angle Start angle in radians
+ * @param end_angle End angle in radians
+ * @param color Fill color
+ */
+void graphics_draw_filled_arc(texture_t* destination, int x, int y, int radius, float start_angle, float end_angle, color_t color);
+
+/**
+ * Draw arc filled to its center with given pattern.
+ * Angles go clockwise from the positive x-axis. Arcs spanning a full
+ * turn or more draw the whole circle.
+ *
+ * @param destination Texture to draw to
+ * @param x Arc center x-coordinate
+ * @param y Arc center y-coordinate
+ * @param radius Arc radius
+ * @param start_angle Start angle in radians
+ * @param end_angle End angle in radians
+ * @param pattern Texture to use as a pattern
+ * @param offset_x Pattern x-axis offset
+ * @param offset_y Pattern y-axis offset
+ */
+void graphics_draw_filled_pattern_arc(texture_t* destination, int x, int y, int radius, float start_angle, float end_angle, texture_t* pattern, int pattern_offset_x, int pattern_offset_y);
+
 /**
  * Draw text.
  *
@@ -201,6 +502,28 @@ void graphics_draw_filled_pattern_circle(texture_t* destination, int x, int y, i
  */
 void graphics_draw_text(texture_t* destination, const char* message, int x, int y);
 
+/**
+ * Draw text with given colors instead of the draw palette. Either color is
+ * skipped if it is the transparent color.
+ *
+ * @param destination Texture to draw to
+ * @param message Text to draw
+ * @param x Text top-left x-coordinate
+ * @param y Text top-left y-coordinate
+ * @param foreground Foreground color
+ * @param background Background color
+ */
+void graphics_draw_colored_text(texture_t* destination, const char* message, int x, int y, color_t foreground, color_t background);
+
+/**
+ * Set font used to draw text. The font is a texture of 8x8 glyphs ordered
+ * left to right, top to bottom. Non-zero pixels are drawn in the foreground
+ * color and zero pixels in the background color.
+ *
+ * @param font Texture to read glyphs from
+ */
+void graphics_draw_font_set(texture_t* font);
+
 /**
  * Draw triangle.
  *
@@ -373,6 +696,91 @@ void graphics_draw_filled_pattern_quad(texture_t* destination, int x0, int y0, i
  */
 void graphics_draw_textured_quad(texture_t* destination, int x0, int y0, float u0, float v0, int x1, int y1, float u1, float v1, int x2, int y2, float u2, float v2, int x3, int y3, float u3, float v3, texture_t* texture_map);
 
+/**
+ * Draw open line through given points. Joints shared by consecutive
+ * segments and repeated points are drawn once. A single point draws a pixel.
+ *
+ * @param destination Texture to draw to
+ * @param points Interleaved x, y coordinates
+ * @param count Number of points
+ * @param color Line color
+ */
+void graphics_draw_polyline(texture_t* destination, const int* points, int count, color_t color);
+
+/**
+ * Draw open line through given points with given pattern.
+ *
+ * @param destination Texture to draw to
+ * @param points Interleaved x, y coordinates
+ * @param count Number of points
+ * @param pattern Texture to use as a pattern
+ * @param offset_x Pattern x-axis offset
+ * @param offset_y Pattern y-axis offset
+ */
+void graphics_draw_pattern_polyline(texture_t* destination, const int* points, int count, texture_t* pattern, int pattern_offset_x, int pattern_offset_y);
+
+/**
+ * Draw closed polygon outline. Each vertex is drawn once.
+ *
+ * @param destination Texture to draw to
+ * @param points Interleaved x, y vertex coordinates
+ * @param count Number of vertices
+ * @param color Line color
+ */
+void graphics_draw_polygon(texture_t* destination, const int* points, int count, color_t color);
+
+/**
+ * Draw closed polygon outline with given pattern.
+ *
+ * @param destination Texture to draw to
+ * @param points Interleaved x, y vertex coordinates
+ * @param count Number of vertices
+ * @param pattern Texture to use as a pattern
+ * @param offset_x Pattern x-axis offset
+ * @param offset_y Pattern y-axis offset
+ */
+void graphics_draw_pattern_polygon(texture_t* destination, const int* points, int count, texture_t* pattern, int pattern_offset_x, int pattern_offset_y);
+
+/**
+ * Draw filled polygon. Polygons can be concave and self-intersecting. Pixels
+ * are covered when their center is inside, with centers exactly on an edge
+ * covered by left edges only, same as triangles.
+ *
+ * @param destination Texture to draw to
+ * @param points Interleaved x, y vertex coordinates
+ * @param count Number of vertices
+ * @param color Fill color
+ * @param rule Fill rule
+ */
+void graphics_draw_filled_polygon(texture_t* destination, const int* points, int count, color_t color, fill_rule_t rule);
+
+/**
+ * Draw filled polygon with given pattern.
+ *
+ * @param destination Texture to draw to
+ * @param points Interleaved x, y vertex coordinates
+ * @param count Number of vertices
+ * @param pattern Texture to use as a pattern
+ * @param offset_x Pattern x-axis offset
+ * @param offset_y Pattern y-axis offset
+ * @param rule Fill rule
+ */
+void graphics_draw_filled_pattern_polygon(texture_t* destination, const int* points, int count, texture_t* pattern, int pattern_offset_x, int pattern_offset_y, fill_rule_t rule);
+
+/**
+ * Draw filled polygon using affine texture mapping. Texture coordinates are
+ * mapped with the affine transform that best fits the vertices, which is
+ * exact when the UVs are an affine transform of the vertex positions.
+ *
+ * @param destination Texture to draw to
+ * @param points Interleaved x, y vertex coordinates
+ * @param coordinates Interleaved u, v texture coordinates for each vertex
+ * @param count Number of vertices
+ * @param texture_map Texture to map onto polygon
+ * @param rule Fill rule
+ */
+void graphics_draw_textured_polygon(texture_t* destination, const int* points, const float* coordinates, int count, texture_t* texture_map, fill_rule_t rule);
+
 /**
  * Draw source texture to destination texture.
  *
@@ -386,13 +794,41 @@ void graphics_draw_textured_quad(texture_t* destination, int x0, int y0, float u
 void graphics_draw_texture(texture_t* destination, texture_t* source, int x, int y, int width, int height);
 
 /**
- * Draw source texture to destination texture using given matrix.
+ * Draw compiled sprite to destination texture. Only the sprite's opaque runs
+ * are drawn, remapped through the draw palette.
+ *
+ * @param destination Texture to draw to
+ * @param sprite Sprite to draw
+ * @param x Sprite x-coordinate on destination
+ * @param y Sprite y-coordinate on destination
+ * @param flip_x Mirror sprite horizontally
+ * @param flip_y Mirror sprite vertically
+ */
+void graphics_draw_sprite(texture_t* destination, sprite_t* sprite, int x, int y, bool flip_x, bool flip_y);
+
+/**
+ * Draw every sprite in a batch in depth order. Each sprite is clipped once
+ * and copied a row at a time unless mirrored. Sprites with a palette offset
+ * add it to their colors, other than the transparent color, before the draw
+ * palette remaps them.
+ *
+ * @param destination Texture to draw to
+ * @param batch Sprites to draw. Sorted by depth if it isn't already.
+ */
+void graphics_draw_sprite_batch(texture_t* destination, sprite_batch_t* batch);
+
+/**
+ * Draw source texture to destination texture using given matrix. Each pixel
+ * samples the texel under its center, stepping texture coordinates across
+ * spans in 16.16 fixed point.
  *
  * @param destination Texture to draw to
  * @param source Texture to draw
  * @param matrix Affine transformation to apply to texture when drawing
+ * @param wrap How texels outside of the source are sampled. Clamped and
+ * repeated textures fill the whole drawable region.
  */
-void graphics_draw_affine_texture(texture_t* destination, texture_t* source, mfloat_t* matrix);
+void graphics_draw_affine_texture(texture_t* destination, texture_t* source, mfloat_t* matrix, texture_wrap_t wrap);
 
 /**
  * Get draw palette.
@@ -427,6 +863,23 @@ void graphics_draw_transparent_color_set(int color);
  */
 int graphics_draw_transparent_color_get(void);
 
+/**
+ * Set blend table. Pixels drawn by primitives, textures and sprites are
+ * combined with the destination through the table instead of replacing it.
+ * Text is drawn as is. Transparent pixels are still skipped.
+ *
+ * @param table Table to blend with, NULL to stop blending. Must stay valid
+ * while set.
+ */
+void graphics_draw_blend_table_set(blend_table_t* table);
+
+/**
+ * Get blend table.
+ *
+ * @return Current blend table, NULL if not blending
+ */
+blend_table_t* graphics_draw_blend_table_get(void);
+
 /**
  * Sets clipping rectangle which defines drawable area.
  *
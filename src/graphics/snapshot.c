@@ -0,0 +1,185 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "snapshot.h"
+#include "../graphics.h"
+#include "../log.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+/**
+ * Region of texture covered by tile at given grid position.
+ */
+static rect_t tile_rect_get(snapshot_t* snapshot, int column, int row) {
+    int x = column * SNAPSHOT_TILE_SIZE;
+    int y = row * SNAPSHOT_TILE_SIZE;
+
+    rect_t rect = {
+        x,
+        y,
+        MIN(SNAPSHOT_TILE_SIZE, snapshot->width - x),
+        MIN(SNAPSHOT_TILE_SIZE, snapshot->height - y)
+    };
+
+    return rect;
+}
+
+/**
+ * Check if tile holds the pixels of texture region.
+ */
+static bool tile_equals(snapshot_tile_t* tile, texture_t* texture, rect_t* rect) {
+    for (int y = 0; y < rect->height; y++) {
+        color_t* row = texture->pixels + (rect->y + y) * texture->stride + rect->x;
+
+        if (memcmp(tile->pixels + y * SNAPSHOT_TILE_SIZE, row, rect->width) != 0) return false;
+    }
+
+    return true;
+}
+
+/**
+ * Create tile from texture region.
+ *
+ * @return New tile if successful, NULL otherwise
+ */
+static snapshot_tile_t* tile_new(texture_t* texture, rect_t* rect) {
+    // Zeroed so the padding of edge tiles has defined contents
+    snapshot_tile_t* tile = (snapshot_tile_t*)calloc(1, sizeof(snapshot_tile_t));
+    if (!tile) return NULL;
+
+    tile->references = 1;
+
+    for (int y = 0; y < rect->height; y++) {
+        color_t* row = texture->pixels + (rect->y + y) * texture->stride + rect->x;
+
+        memcpy(tile->pixels + y * SNAPSHOT_TILE_SIZE, row, rect->width);
+    }
+
+    return tile;
+}
+
+static void tile_release(snapshot_tile_t* tile) {
+    if (!tile) return;
+    if (--tile->references > 0) return;
+
+    free(tile);
+}
+
+snapshot_t* graphics_snapshot_new(texture_t* texture, snapshot_t* previous) {
+    snapshot_t* snapshot = (snapshot_t*)malloc(sizeof(snapshot_t));
+
+    if (!snapshot) {
+        log_error("Failed to create snapshot");
+        return NULL;
+    }
+
+    snapshot->width = texture->width;
+    snapshot->height = texture->height;
+    snapshot->columns = (texture->width + SNAPSHOT_TILE_SIZE - 1) / SNAPSHOT_TILE_SIZE;
+    snapshot->rows = (texture->height + SNAPSHOT_TILE_SIZE - 1) / SNAPSHOT_TILE_SIZE;
+
+    size_t count = (size_t)snapshot->columns * snapshot->rows;
+    snapshot->tiles = (snapshot_tile_t**)calloc(count ? count : 1, sizeof(snapshot_tile_t*));
+
+    if (!snapshot->tiles) {
+        free(snapshot);
+
+        log_error("Failed to create snapshot");
+        return NULL;
+    }
+
+    if (previous && (previous->width != snapshot->width || previous->height != snapshot->height)) {
+        previous = NULL;
+    }
+
+    for (int row = 0; row < snapshot->rows; row++) {
+        for (int column = 0; column < snapshot->columns; column++) {
+            size_t index = (size_t)row * snapshot->columns + column;
+            rect_t rect = tile_rect_get(snapshot, column, row);
+
+            snapshot_tile_t* tile = previous ? previous->tiles[index] : NULL;
+
+            if (tile && tile_equals(tile, texture, &rect)) {
+                tile->references++;
+            }
+            else {
+                tile = tile_new(texture, &rect);
+            }
+
+            if (!tile) {
+                graphics_snapshot_free(snapshot);
+
+                log_error("Failed to create snapshot");
+                return NULL;
+            }
+
+            snapshot->tiles[index] = tile;
+        }
+    }
+
+    return snapshot;
+}
+
+void graphics_snapshot_free(snapshot_t* snapshot) {
+    // Tiles after a failed allocation are still NULL
+    size_t count = (size_t)snapshot->columns * snapshot->rows;
+
+    for (size_t i = 0; i < count; i++) {
+        tile_release(snapshot->tiles[i]);
+    }
+
+    free(snapshot->tiles);
+    free(snapshot);
+    snapshot = NULL;
+}
+
+size_t graphics_snapshot_sizeof(snapshot_t* snapshot) {
+    size_t count = (size_t)snapshot->columns * snapshot->rows;
+    size_t size = sizeof(snapshot_t) + count * sizeof(snapshot_tile_t*);
+
+    for (size_t i = 0; i < count; i++) {
+        size += sizeof(snapshot_tile_t) / snapshot->tiles[i]->references;
+    }
+
+    return size;
+}
+
+/**
+ * Copy snapshot tiles to texture of the same size.
+ */
+static void snapshot_copy(snapshot_t* snapshot, texture_t* texture) {
+    for (int row = 0; row < snapshot->rows; row++) {
+        for (int column = 0; column < snapshot->columns; column++) {
+            snapshot_tile_t* tile = snapshot->tiles[(size_t)row * snapshot->columns + column];
+            rect_t rect = tile_rect_get(snapshot, column, row);
+
+            for (int y = 0; y < rect.height; y++) {
+                color_t* destination = texture->pixels + (rect.y + y) * texture->stride + rect.x;
+
+                memcpy(destination, tile->pixels + y * SNAPSHOT_TILE_SIZE, rect.width);
+            }
+        }
+    }
+}
+
+texture_t* graphics_snapshot_texture_new(snapshot_t* snapshot) {
+    // Every pixel is overwritten, so there's no need to zero it first
+    texture_t* texture = graphics_texture_acquire(snapshot->width, snapshot->height);
+    if (!texture) return NULL;
+
+    snapshot_copy(snapshot, texture);
+
+    return texture;
+}
+
+bool graphics_snapshot_restore(snapshot_t* snapshot, texture_t* texture) {
+    if (texture->width != snapshot->width || texture->height != snapshot->height) {
+        log_error("Snapshot size does not match texture size");
+        return false;
+    }
+
+    snapshot_copy(snapshot, texture);
+    graphics_dirty_rectangle_add(texture, NULL);
+
+    return true;
+}
@@ -0,0 +1,81 @@
+#ifndef GRAPHICS_SNAPSHOT_H
+#define GRAPHICS_SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "../graphics/types.h"
+
+/**
+ * Width and height in pixels of the tiles snapshots are stored in.
+ */
+#define SNAPSHOT_TILE_SIZE 16
+
+/**
+ * Tile of snapshot pixels. Tiles are immutable once made, so snapshots with
+ * the same pixels in a tile share it. Tiles on the right and bottom edges
+ * are zero padded.
+ */
+typedef struct {
+    int references;
+    color_t pixels[SNAPSHOT_TILE_SIZE * SNAPSHOT_TILE_SIZE];
+} snapshot_tile_t;
+
+/**
+ * Read-only copy of a texture's pixels, stored as a grid of shared tiles.
+ */
+typedef struct {
+    int width;
+    int height;
+    int columns;
+    int rows;
+    snapshot_tile_t** tiles;
+} snapshot_t;
+
+/**
+ * Take a snapshot of texture. Tiles with the same pixels as the previous
+ * snapshot are shared with it instead of copied, so a series of snapshots
+ * of a texture only stores the tiles that changed in between.
+ *
+ * @param texture Texture to take snapshot of
+ * @param previous Snapshot to share tiles with, or NULL. Ignored if its size
+ * differs from the texture's.
+ * @return New snapshot if successful, NULL otherwise
+ */
+snapshot_t* graphics_snapshot_new(texture_t* texture, snapshot_t* previous);
+
+/**
+ * Frees a snapshot. Tiles are freed once no snapshot uses them.
+ *
+ * @param snapshot Snapshot to free
+ */
+void graphics_snapshot_free(snapshot_t* snapshot);
+
+/**
+ * Get size of snapshot struct including its tiles. Shared tiles are divided
+ * evenly between the snapshots using them.
+ *
+ * @param snapshot Snapshot to get size of
+ * @return Size of given snapshot
+ */
+size_t graphics_snapshot_sizeof(snapshot_t* snapshot);
+
+/**
+ * Create a new texture with the pixels of snapshot.
+ *
+ * @param snapshot Snapshot to copy
+ * @return New texture if successful, NULL otherwise
+ */
+texture_t* graphics_snapshot_texture_new(snapshot_t* snapshot);
+
+/**
+ * Copy pixels of snapshot back to a texture of the same size. Marks the
+ * texture as dirty.
+ *
+ * @param snapshot Snapshot to copy
+ * @param texture Texture to copy to
+ * @return true if successful, false if the sizes differ
+ */
+bool graphics_snapshot_restore(snapshot_t* snapshot, texture_t* texture);
+
+#endif
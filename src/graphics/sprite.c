@@ -0,0 +1,100 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "sprite.h"
+#include "../log.h"
+
+/**
+ * Get end of opaque run starting at given offset in row.
+ */
+static int run_end_get(const color_t* row, int x, int width, color_t transparent) {
+    while (x < width && row[x] != transparent) {
+        x++;
+    }
+
+    return x;
+}
+
+sprite_t* graphics_sprite_new(texture_t* texture, color_t transparent) {
+    int width = texture->width > 0 ? texture->width : 0;
+    int height = texture->height > 0 ? texture->height : 0;
+
+    // Count runs and opaque pixels so everything fits in one allocation
+    size_t run_count = 0;
+    size_t pixel_count = 0;
+
+    for (int y = 0; y < height; y++) {
+        const color_t* row = texture->pixels + y * texture->stride;
+
+        for (int x = 0; x < width; x++) {
+            if (row[x] == transparent) continue;
+
+            int end = run_end_get(row, x, width, transparent);
+            run_count++;
+            pixel_count += end - x;
+            x = end;
+        }
+    }
+
+    size_t size = sizeof(sprite_t) +
+                  run_count * sizeof(sprite_run_t) +
+                  (height + 1) * sizeof(int) +
+                  pixel_count * sizeof(color_t);
+
+    sprite_t* sprite = (sprite_t*)malloc(size);
+
+    if (!sprite) {
+        log_error("Failed to create sprite");
+        return NULL;
+    }
+
+    sprite->width = width;
+    sprite->height = height;
+    sprite->transparent = transparent;
+    sprite->runs = (sprite_run_t*)(sprite + 1);
+    sprite->rows = (int*)(sprite->runs + run_count);
+    sprite->pixels = (color_t*)(sprite->rows + height + 1);
+
+    int run = 0;
+    int offset = 0;
+
+    for (int y = 0; y < height; y++) {
+        const color_t* row = texture->pixels + y * texture->stride;
+        sprite->rows[y] = run;
+
+        for (int x = 0; x < width; x++) {
+            if (row[x] == transparent) continue;
+
+            int end = run_end_get(row, x, width, transparent);
+
+            sprite->runs[run++] = (sprite_run_t) {x, end - x, offset};
+            memcpy(sprite->pixels + offset, row + x, end - x);
+            offset += end - x;
+            x = end;
+        }
+    }
+
+    sprite->rows[height] = run;
+
+    return sprite;
+}
+
+void graphics_sprite_free(sprite_t* sprite) {
+    free(sprite);
+    sprite = NULL;
+}
+
+size_t graphics_sprite_sizeof(sprite_t* sprite) {
+    size_t run_count = sprite->rows[sprite->height];
+    size_t pixel_count = 0;
+
+    if (run_count > 0) {
+        sprite_run_t* last = &sprite->runs[run_count - 1];
+        pixel_count = last->offset + last->length;
+    }
+
+    return sizeof(sprite_t) +
+           run_count * sizeof(sprite_run_t) +
+           (sprite->height + 1) * sizeof(int) +
+           pixel_count * sizeof(color_t);
+}
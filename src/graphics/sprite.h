@@ -0,0 +1,34 @@
+#ifndef GRAPHICS_SPRITE_H
+#define GRAPHICS_SPRITE_H
+
+#include <stddef.h>
+
+#include "../graphics/types.h"
+
+/**
+ * Compile texture into a sprite. Pixels matching the transparent color are
+ * dropped and the remaining pixels are stored as runs per row, so drawing
+ * never reads them again. The sprite keeps its own copy of the pixels.
+ *
+ * @param texture Texture to compile
+ * @param transparent Color to drop
+ * @return New sprite if successful, NULL otherwise
+ */
+sprite_t* graphics_sprite_new(texture_t* texture, color_t transparent);
+
+/**
+ * Frees a sprite.
+ *
+ * @param sprite Sprite to free
+ */
+void graphics_sprite_free(sprite_t* sprite);
+
+/**
+ * Get size of sprite struct including size of runs and pixel data.
+ *
+ * @param sprite Sprite to get size of
+ * @return Size of given sprite
+ */
+size_t graphics_sprite_sizeof(sprite_t* sprite);
+
+#endif
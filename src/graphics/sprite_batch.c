@@ -0,0 +1,177 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "sprite_batch.h"
+#include "../log.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+/**
+ * Get radix sort key for depth. Flipping the sign bit orders negative
+ * depths before positive ones when compared unsigned.
+ */
+static inline uint32_t depth_key_get(int depth) {
+    return (uint32_t)depth ^ 0x80000000u;
+}
+
+sprite_batch_t* graphics_sprite_batch_new(void) {
+    sprite_batch_t* batch = (sprite_batch_t*)calloc(1, sizeof(sprite_batch_t));
+
+    if (!batch) {
+        log_error("Failed to create sprite batch");
+        return NULL;
+    }
+
+    return batch;
+}
+
+void graphics_sprite_batch_free(sprite_batch_t* batch) {
+    free(batch->entries);
+    free(batch->order);
+    free(batch->scratch);
+    free(batch);
+    batch = NULL;
+}
+
+void graphics_sprite_batch_clear(sprite_batch_t* batch) {
+    batch->count = 0;
+    batch->sorted = false;
+}
+
+/**
+ * Grow batch arrays to hold at least given number of sprites. Capacity is
+ * only updated once every array has grown.
+ */
+static bool reserve(sprite_batch_t* batch, size_t required) {
+    if (required <= batch->capacity) return true;
+
+    size_t capacity = batch->capacity ? batch->capacity : 64;
+    while (capacity < required) {
+        capacity *= 2;
+    }
+
+    sprite_batch_entry_t* entries = realloc(batch->entries, capacity * sizeof(sprite_batch_entry_t));
+    if (!entries) return false;
+    batch->entries = entries;
+
+    uint32_t* order = realloc(batch->order, capacity * sizeof(uint32_t));
+    if (!order) return false;
+    batch->order = order;
+
+    uint32_t* scratch = realloc(batch->scratch, capacity * sizeof(uint32_t));
+    if (!scratch) return false;
+    batch->scratch = scratch;
+
+    batch->capacity = capacity;
+
+    return true;
+}
+
+bool graphics_sprite_batch_add(sprite_batch_t* batch, sprite_batch_entry_t* entry) {
+    // Indices are stored as 32 bits
+    if (batch->count >= UINT32_MAX || !reserve(batch, batch->count + 1)) {
+        log_error("Failed to add sprite to batch");
+        return false;
+    }
+
+    batch->entries[batch->count++] = *entry;
+    batch->sorted = false;
+
+    return true;
+}
+
+bool graphics_sprite_batch_sort(sprite_batch_t* batch) {
+    if (batch->sorted) return true;
+
+    size_t count = batch->count;
+    sprite_batch_entry_t* entries = batch->entries;
+
+    // Histograms for all four bytes of the key are counted in one pass
+    size_t histograms[4][256];
+    memset(histograms, 0, sizeof(histograms));
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t key = depth_key_get(entries[i].depth);
+
+        histograms[0][key & 0xFF]++;
+        histograms[1][(key >> 8) & 0xFF]++;
+        histograms[2][(key >> 16) & 0xFF]++;
+        histograms[3][key >> 24]++;
+
+        batch->order[i] = i;
+    }
+
+    uint32_t* source = batch->order;
+    uint32_t* destination = batch->scratch;
+
+    // Least significant byte first. Each pass is stable, so sprites of equal
+    // depth keep the order they were added in.
+    for (int pass = 0; pass < 4; pass++) {
+        size_t* histogram = histograms[pass];
+        int shift = pass * 8;
+
+        // Skip bytes every key shares, which is most of them for small depths
+        if (count == 0 || histogram[(depth_key_get(entries[0].depth) >> shift) & 0xFF] == count) continue;
+
+        size_t offset = 0;
+
+        for (int i = 0; i < 256; i++) {
+            size_t bucket = histogram[i];
+            histogram[i] = offset;
+            offset += bucket;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            uint32_t index = source[i];
+            uint32_t digit = (depth_key_get(entries[index].depth) >> shift) & 0xFF;
+
+            destination[histogram[digit]++] = index;
+        }
+
+        uint32_t* swap = source;
+        source = destination;
+        destination = swap;
+    }
+
+    // Sorted indices end up in whichever array the last pass wrote
+    if (source != batch->order) {
+        batch->scratch = batch->order;
+        batch->order = source;
+    }
+
+    batch->sorted = true;
+
+    return true;
+}
+
+bool graphics_sprite_batch_bounds_get(sprite_batch_t* batch, rect_t* rect) {
+    if (batch->count == 0) return false;
+
+    int64_t left = INT64_MAX;
+    int64_t top = INT64_MAX;
+    int64_t right = INT64_MIN;
+    int64_t bottom = INT64_MIN;
+
+    for (size_t i = 0; i < batch->count; i++) {
+        sprite_batch_entry_t* entry = &batch->entries[i];
+
+        left = MIN(left, entry->x);
+        top = MIN(top, entry->y);
+        right = MAX(right, (int64_t)entry->x + entry->source.width);
+        bottom = MAX(bottom, (int64_t)entry->y + entry->source.height);
+    }
+
+    // Keep the size representable
+    left = MAX(left, INT32_MIN / 2);
+    top = MAX(top, INT32_MIN / 2);
+    right = MIN(right, INT32_MAX / 2);
+    bottom = MIN(bottom, INT32_MAX / 2);
+
+    rect->x = left;
+    rect->y = top;
+    rect->width = right > left ? right - left : 0;
+    rect->height = bottom > top ? bottom - top : 0;
+
+    return rect->width > 0 && rect->height > 0;
+}
@@ -0,0 +1,89 @@
+#ifndef GRAPHICS_SPRITE_BATCH_H
+#define GRAPHICS_SPRITE_BATCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../graphics/types.h"
+
+/**
+ * A single sprite in a batch. Drawn from the source region of the texture
+ * with its top left corner at x, y.
+ */
+typedef struct {
+    texture_t* texture;
+    rect_t source;
+    int x;
+    int y;
+    int depth;
+    uint8_t palette_offset;
+    bool flip_x;
+    bool flip_y;
+} sprite_batch_entry_t;
+
+/**
+ * List of sprites drawn together in one call. Sprites are drawn in order of
+ * increasing depth, and sprites of equal depth in the order they were added.
+ */
+typedef struct {
+    sprite_batch_entry_t* entries;
+    size_t count;
+    size_t capacity;
+
+    // Entry indices in drawing order, valid while sorted is set
+    uint32_t* order;
+    uint32_t* scratch;
+    bool sorted;
+} sprite_batch_t;
+
+/**
+ * Create a new empty sprite batch.
+ *
+ * @return New sprite batch if successful, NULL otherwise
+ */
+sprite_batch_t* graphics_sprite_batch_new(void);
+
+/**
+ * Frees a sprite batch. Textures are not freed.
+ *
+ * @param batch Sprite batch to free
+ */
+void graphics_sprite_batch_free(sprite_batch_t* batch);
+
+/**
+ * Remove all sprites from batch, keeping its memory for reuse.
+ *
+ * @param batch Sprite batch to clear
+ */
+void graphics_sprite_batch_clear(sprite_batch_t* batch);
+
+/**
+ * Add sprite to batch. The entry is copied, and its texture must stay valid
+ * while the batch is drawn.
+ *
+ * @param batch Sprite batch to add to
+ * @param entry Sprite to add
+ * @return true if successful, false otherwise
+ */
+bool graphics_sprite_batch_add(sprite_batch_t* batch, sprite_batch_entry_t* entry);
+
+/**
+ * Sort sprites into drawing order with a radix sort on depth. Does nothing
+ * if the batch is already sorted.
+ *
+ * @param batch Sprite batch to sort
+ * @return true if successful, false otherwise
+ */
+bool graphics_sprite_batch_sort(sprite_batch_t* batch);
+
+/**
+ * Get region covered by all sprites in batch.
+ *
+ * @param batch Sprite batch
+ * @param rect Covered region
+ * @return true if batch has any sprites, false otherwise
+ */
+bool graphics_sprite_batch_bounds_get(sprite_batch_t* batch, rect_t* rect);
+
+#endif
@@ -1,51 +1,439 @@
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "blit.h"
 #include "texture.h"
 #include "../graphics.h"
 #include "../log.h"
 
-texture_t* graphics_texture_new(int width, int height, const color_t* pixels) {
-    texture_t* texture = (texture_t*)malloc(sizeof(texture_t));
+/**
+ * Free texture blocks of one size, linked through their first bytes.
+ */
+typedef struct pool_block {
+    struct pool_block* next;
+} pool_block_t;
+
+typedef struct {
+    size_t size;
+    pool_block_t* blocks;
+
+    // Pool tick of last take or give, to find the least recently used bucket
+    uint64_t used;
+} pool_bucket_t;
+
+static pool_bucket_t pool_buckets[TEXTURE_POOL_BUCKETS];
+static texture_pool_stats_t pool_stats = {.capacity = TEXTURE_POOL_DEFAULT_CAPACITY};
+static uint64_t pool_tick = 0;
+
+/**
+ * Free every block in bucket.
+ */
+static void pool_bucket_evict(pool_bucket_t* bucket) {
+    while (bucket->blocks) {
+        pool_block_t* block = bucket->blocks;
+        bucket->blocks = block->next;
+
+        pool_stats.count--;
+        pool_stats.size -= bucket->size;
+
+        free(block);
+    }
+}
 
-    if (!texture) {
-        log_error("Failed to create texture");
+/**
+ * Get least recently used bucket holding blocks, other than the excluded one.
+ *
+ * @return Bucket if any other bucket holds blocks, NULL otherwise
+ */
+static pool_bucket_t* pool_bucket_lru_get(pool_bucket_t* excluded) {
+    pool_bucket_t* lru = NULL;
+
+    for (int i = 0; i < TEXTURE_POOL_BUCKETS; i++) {
+        pool_bucket_t* bucket = &pool_buckets[i];
+        if (bucket == excluded || !bucket->blocks) continue;
+
+        if (!lru || bucket->used < lru->used) {
+            lru = bucket;
+        }
+    }
+
+    return lru;
+}
+
+/**
+ * Take a free block of given size from the pool.
+ *
+ * @return Block if the pool had one, NULL otherwise
+ */
+static void* pool_take(size_t size) {
+    for (int i = 0; i < TEXTURE_POOL_BUCKETS; i++) {
+        pool_bucket_t* bucket = &pool_buckets[i];
+        if (bucket->size != size || !bucket->blocks) continue;
+
+        pool_block_t* block = bucket->blocks;
+        bucket->blocks = block->next;
+        bucket->used = ++pool_tick;
+
+        pool_stats.hits++;
+        pool_stats.count--;
+        pool_stats.size -= size;
+
+        return block;
+    }
+
+    pool_stats.misses++;
+
+    return NULL;
+}
+
+/**
+ * Give a block of given size to the pool. Sizes that haven't been used for
+ * the longest are freed to make room, so the pool follows the sizes in use.
+ *
+ * @return true if the pool kept the block, false if it's larger than the
+ * pool's capacity
+ */
+static bool pool_give(void* block, size_t size) {
+    if (size > pool_stats.capacity) return false;
+
+    pool_bucket_t* target = NULL;
+
+    for (int i = 0; i < TEXTURE_POOL_BUCKETS; i++) {
+        pool_bucket_t* bucket = &pool_buckets[i];
+
+        if (bucket->blocks && bucket->size == size) {
+            target = bucket;
+            break;
+        }
+
+        if (!bucket->blocks && !target) {
+            target = bucket;
+        }
+    }
+
+    if (!target) {
+        target = pool_bucket_lru_get(NULL);
+        pool_bucket_evict(target);
+    }
+
+    while (size > pool_stats.capacity - pool_stats.size) {
+        pool_bucket_t* lru = pool_bucket_lru_get(target);
+
+        // Only blocks of this size are left, so keep those instead
+        if (!lru) return false;
+
+        pool_bucket_evict(lru);
+    }
+
+    pool_block_t* head = (pool_block_t*)block;
+    head->next = target->blocks;
+
+    target->size = size;
+    target->blocks = head;
+    target->used = ++pool_tick;
+
+    pool_stats.count++;
+    pool_stats.size += size;
+
+    return true;
+}
+
+/**
+ * Get row stride for given width, padded to a whole number of alignment
+ * blocks.
+ */
+static size_t texture_stride_get(int width) {
+    return ((size_t)width + TEXTURE_ALIGNMENT - 1) / TEXTURE_ALIGNMENT * TEXTURE_ALIGNMENT;
+}
+
+/**
+ * Get size of the single block holding a texture's struct and pixels. The
+ * pixels start at the first aligned address past the struct.
+ */
+static size_t texture_block_size_get(size_t stride, int height) {
+    return sizeof(texture_t) + TEXTURE_ALIGNMENT - 1 + stride * height;
+}
+
+/**
+ * Allocate texture struct and pixels in one block, reusing a pooled block of
+ * the same size if there is one.
+ *
+ * @param zero Zero pixels if true, leave them uninitialized otherwise
+ * @return New texture if successful, NULL otherwise
+ */
+static texture_t* texture_alloc(int width, int height, bool zero) {
+    if (width < 0 || height < 0) {
+        log_error("Invalid texture size %ix%i", width, height);
         return NULL;
     }
 
-    texture->pixels = (color_t*)malloc(width * height * sizeof(color_t));
+    size_t stride = texture_stride_get(width);
 
-    if (!texture->pixels) {
-        log_error("Failed to create texture pixels");
+    if (stride > INT32_MAX || (height > 0 && stride > (SIZE_MAX - sizeof(texture_t) - TEXTURE_ALIGNMENT) / height)) {
+        log_error("Invalid texture size %ix%i", width, height);
         return NULL;
     }
 
+    size_t size = texture_block_size_get(stride, height);
+    texture_t* texture = (texture_t*)pool_take(size);
+
+    if (texture) {
+        if (zero) memset(texture, 0, size);
+    }
+    else {
+        texture = (texture_t*)(zero ? calloc(1, size) : malloc(size));
+    }
+
+    if (!texture) {
+        log_error("Failed to create texture");
+        return NULL;
+    }
+
+    uintptr_t pixels = (uintptr_t)(texture + 1);
+    pixels = (pixels + TEXTURE_ALIGNMENT - 1) & ~(uintptr_t)(TEXTURE_ALIGNMENT - 1);
+
     texture->width = width;
     texture->height = height;
-    texture->stride = width;
+    texture->stride = stride;
     texture->is_subtexture = false;
-    memset(texture->pixels, 0, width * height);
+    texture->pixels = (color_t*)pixels;
+    texture->mipmap = NULL;
+
+    return texture;
+}
+
+texture_t* graphics_texture_new(int width, int height, const color_t* pixels) {
+    texture_t* texture = texture_alloc(width, height, !pixels);
+    if (!texture) return NULL;
 
     if (pixels) {
-        size_t size = width * height * sizeof(color_t);
-        memmove(texture->pixels, pixels, size);
+        // Source rows are packed, and padding is zeroed so the whole block
+        // has defined contents
+        for (int y = 0; y < height; y++) {
+            color_t* row = texture->pixels + y * texture->stride;
+
+            memcpy(row, pixels + (size_t)y * width, width * sizeof(color_t));
+            memset(row + width, 0, (texture->stride - width) * sizeof(color_t));
+        }
     }
 
     return texture;
 }
 
-void graphics_texture_free(texture_t* texture) {
-    if (!texture->is_subtexture) {
-        free(texture->pixels);
-        texture->pixels = NULL;
+texture_t* graphics_texture_acquire(int width, int height) {
+    return texture_alloc(width, height, false);
+}
+
+texture_t* graphics_texture_bitmask_new(uint64_t bits, color_t foreground, color_t background) {
+    texture_t* texture = graphics_texture_new(8, 8, NULL);
+    if (!texture) return NULL;
+
+    for (int i = 0; i < 64; i++) {
+        texture->pixels[i / 8 * texture->stride + i % 8] = (bits >> (63 - i)) & 1 ? foreground : background;
     }
 
+    return texture;
+}
+
+void graphics_texture_free(texture_t* texture) {
+    if (!texture) return;
+
+    graphics_texture_mipmaps_free(texture);
+
+    // Pixels of whole textures are in the same block, so the block can be
+    // pooled as is
+    if (!texture->is_subtexture && pool_give(texture, graphics_texture_sizeof(texture))) return;
+
     free(texture);
     texture = NULL;
 }
 
+void graphics_texture_pool_capacity_set(size_t capacity) {
+    pool_stats.capacity = capacity;
+
+    while (pool_stats.size > capacity) {
+        pool_bucket_evict(pool_bucket_lru_get(NULL));
+    }
+}
+
+void graphics_texture_pool_stats_get(texture_pool_stats_t* stats) {
+    *stats = pool_stats;
+}
+
+void graphics_texture_pool_clear(void) {
+    size_t capacity = pool_stats.capacity;
+
+    graphics_texture_pool_capacity_set(0);
+    pool_stats.capacity = capacity;
+}
+
 size_t graphics_texture_sizeof(texture_t* texture) {
-    return sizeof(texture_t) + texture->width * texture->height * sizeof(color_t);;
+    size_t size = texture->mipmap ? graphics_texture_sizeof(texture->mipmap) : 0;
+
+    if (texture->is_subtexture) return size + sizeof(texture_t);
+
+    return size + texture_block_size_get(texture->stride, texture->height);
+}
+
+/**
+ * Get the color of a block that is nearest to the average of its opaque
+ * colors. The block is transparent if most of it is.
+ */
+static color_t block_nearest_get(color_t* colors, int count, uint32_t* palette, color_t transparent) {
+    int sum[3] = {0, 0, 0};
+    int opaque = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (colors[i] == transparent) continue;
+
+        for (int channel = 0; channel < 3; channel++) {
+            sum[channel] += (palette[colors[i]] >> (channel * 8)) & 0xFF;
+        }
+
+        opaque++;
+    }
+
+    if (opaque * 2 < count) return transparent;
+
+    color_t nearest = transparent;
+    int nearest_distance = INT32_MAX;
+
+    for (int i = 0; i < count; i++) {
+        if (colors[i] == transparent) continue;
+
+        // Compared at opaque times the scale to keep the average exact
+        int distance = 0;
+
+        for (int channel = 0; channel < 3; channel++) {
+            int delta = (int)((palette[colors[i]] >> (channel * 8)) & 0xFF) * opaque - sum[channel];
+            distance += delta * delta;
+        }
+
+        if (distance < nearest_distance) {
+            nearest = colors[i];
+            nearest_distance = distance;
+        }
+    }
+
+    return nearest;
+}
+
+/**
+ * Get the most common color of a block. Ties go to the color found first.
+ */
+static color_t block_majority_get(color_t* colors, int count) {
+    color_t majority = colors[0];
+    int majority_count = 0;
+
+    for (int i = 0; i < count; i++) {
+        int matches = 0;
+
+        for (int j = 0; j < count; j++) {
+            matches += colors[j] == colors[i];
+        }
+
+        if (matches > majority_count) {
+            majority = colors[i];
+            majority_count = matches;
+        }
+    }
+
+    return majority;
+}
+
+/**
+ * Create the next smaller mip level of texture.
+ *
+ * @return New texture if successful, NULL otherwise
+ */
+static texture_t* mipmap_new(texture_t* texture, mipmap_filter_t filter) {
+    int width = (texture->width + 1) / 2;
+    int height = (texture->height + 1) / 2;
+
+    // Every pixel is overwritten, so there's no need to zero it first
+    texture_t* mipmap = graphics_texture_acquire(width, height);
+    if (!mipmap) return NULL;
+
+    uint32_t* palette = graphics_palette_get();
+    color_t transparent = graphics_draw_transparent_color_get();
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            // Blocks on odd right and bottom edges are cut short
+            int block_width = x * 2 + 1 < texture->width ? 2 : 1;
+            int block_height = y * 2 + 1 < texture->height ? 2 : 1;
+            color_t colors[4];
+            int count = 0;
+
+            for (int j = 0; j < block_height; j++) {
+                for (int i = 0; i < block_width; i++) {
+                    colors[count++] = texture->pixels[(y * 2 + j) * texture->stride + x * 2 + i];
+                }
+            }
+
+            color_t color = filter == MIPMAP_NEAREST ?
+                block_nearest_get(colors, count, palette, transparent) :
+                block_majority_get(colors, count);
+
+            mipmap->pixels[y * mipmap->stride + x] = color;
+        }
+    }
+
+    return mipmap;
+}
+
+bool graphics_texture_mipmaps_build(texture_t* texture, mipmap_filter_t filter) {
+    graphics_texture_mipmaps_free(texture);
+
+    texture_t* level = texture;
+
+    while (level->width > 1 || level->height > 1) {
+        level->mipmap = mipmap_new(level, filter);
+
+        if (!level->mipmap) {
+            graphics_texture_mipmaps_free(texture);
+
+            log_error("Failed to create texture mip chain");
+            return false;
+        }
+
+        level = level->mipmap;
+    }
+
+    return true;
+}
+
+void graphics_texture_mipmaps_free(texture_t* texture) {
+    // Freeing a level frees the rest of the chain after it
+    graphics_texture_free(texture->mipmap);
+    texture->mipmap = NULL;
+}
+
+int graphics_texture_mipmap_level_get(texture_t* texture, float step) {
+    int level = 0;
+
+    for (texture_t* mipmap = texture->mipmap; mipmap && step >= 2.0f; mipmap = mipmap->mipmap) {
+        step *= 0.5f;
+        level++;
+    }
+
+    return level;
+}
+
+texture_t* graphics_texture_mipmap_get(texture_t* texture, int level) {
+    for (int i = 0; i < level && texture->mipmap; i++) {
+        texture = texture->mipmap;
+    }
+
+    return texture;
+}
+
+color_t graphics_texture_mipmap_pixel_get(texture_t* texture, texture_t* mipmap, int level, int x, int y) {
+    if (x < 0 || x >= texture->width) return graphics_draw_transparent_color_get();
+    if (y < 0 || y >= texture->height) return graphics_draw_transparent_color_get();
+
+    return mipmap->pixels[(y >> level) * mipmap->stride + (x >> level)];
 }
 
 color_t* graphics_texture_pixels_get(texture_t* texture) {
@@ -61,19 +449,18 @@ int graphics_texture_height_get(texture_t* texture) {
 }
 
 texture_t* graphics_texture_copy(texture_t* texture) {
-    texture_t* copy = graphics_texture_new(
-        texture->width,
-        texture->height,
-        NULL
-    );
+    // Every row is overwritten, so there's no need to zero it first
+    texture_t* copy = texture_alloc(texture->width, texture->height, false);
+    if (!copy) return NULL;
 
     size_t size = copy->width * sizeof(color_t);
+    size_t padding = (copy->stride - copy->width) * sizeof(color_t);
+
     for (int i = 0; i < copy->height; i++) {
-        memmove(
-            copy->pixels + i * copy->stride,
-            texture->pixels + i * texture->stride,
-            size
-        );
+        color_t* row = copy->pixels + i * copy->stride;
+
+        memcpy(row, texture->pixels + i * texture->stride, size);
+        memset(row + copy->width, 0, padding);
     }
 
     return copy;
@@ -87,6 +474,8 @@ void graphics_texture_clear(texture_t* texture, color_t color) {
     for (int i = 0; i < texture->height; i++) {
         memset(texture->pixels + i * texture->stride, color, size);
     }
+
+    graphics_dirty_rectangle_add(texture, NULL);
 }
 
 texture_t* graphics_texture_sub(texture_t* texture, rect_t* rect) {
@@ -111,6 +500,7 @@ texture_t* graphics_texture_sub(texture_t* texture, rect_t* rect) {
     sub_texture->height = rect->height;
     sub_texture->stride = texture->stride;
     sub_texture->is_subtexture = true;
+    sub_texture->mipmap = NULL;
 
     size_t offset = rect->x + rect->y * texture->stride;
 
@@ -119,6 +509,18 @@ texture_t* graphics_texture_sub(texture_t* texture, rect_t* rect) {
     return sub_texture;
 }
 
+bool graphics_texture_overlaps(texture_t* a, texture_t* b) {
+    if (!a || !b) return false;
+    if (a->width <= 0 || a->height <= 0 || b->width <= 0 || b->height <= 0) return false;
+
+    uintptr_t a_start = (uintptr_t)a->pixels;
+    uintptr_t a_end = (uintptr_t)(a->pixels + (a->height - 1) * a->stride + a->width);
+    uintptr_t b_start = (uintptr_t)b->pixels;
+    uintptr_t b_end = (uintptr_t)(b->pixels + (b->height - 1) * b->stride + b->width);
+
+    return a_start < b_end && b_start < a_end;
+}
+
 void graphics_texture_pixel_set(texture_t* texture, int x, int y, color_t color) {
     if (x < 0 || x >= texture->width) return;
     if (y < 0 || y >= texture->height) return;
@@ -133,13 +535,17 @@ color_t graphics_texture_pixel_get(texture_t* texture, int x, int y) {
     return texture->pixels[y * texture->stride + x];
 }
 
-static void texture_blit_func(texture_t* source_texture, texture_t* destination_texture, int sx, int sy, int dx, int dy) {
-    color_t pixel = graphics_texture_pixel_get(source_texture, sx, sy);
-    if (pixel == graphics_draw_transparent_color_get()) return;
+void graphics_texture_blit(texture_t* source_texture, texture_t* destination_texture, rect_t* source_rect, rect_t* destination_rect) {
+    if (!destination_texture) {
+        destination_texture = graphics_render_texture_get();
+    }
 
-    graphics_texture_pixel_set(destination_texture, dx, dy, pixel);
-}
+    rect_t bounds = {0, 0, destination_texture->width, destination_texture->height};
+    blit_t blit = {
+        .mode = BLIT_KEYED,
+        .transparent = graphics_draw_transparent_color_get()
+    };
 
-void graphics_texture_blit(texture_t* source_texture, texture_t* destination_texture, rect_t* source_rect, rect_t* destination_rect) {
-    graphics_blit(source_texture, destination_texture, source_rect, destination_rect, texture_blit_func);
+    graphics_blit_rect(destination_texture, &bounds, source_texture, source_rect, destination_rect, &blit);
+    graphics_dirty_rectangle_add(destination_texture, destination_rect);
 }
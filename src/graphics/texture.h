@@ -7,24 +7,173 @@
 #include "../graphics/types.h"
 
 /**
- * Create a new texture.
+ * Alignment in bytes of texture rows. Textures made by graphics_texture_new
+ * or graphics_texture_copy start every row on this alignment and pad their
+ * stride to a multiple of it, so whole vectors can be read and written up
+ * to the end of the stride. Subtextures share their parent's rows and have
+ * no padding of their own.
+ */
+#define TEXTURE_ALIGNMENT 64
+
+/**
+ * Default number of bytes the texture pool may hold. Freed textures are
+ * kept in the pool and handed out again to new textures of the same size,
+ * which saves a malloc and free for textures recreated every frame.
+ */
+#define TEXTURE_POOL_DEFAULT_CAPACITY (16 * 1024 * 1024)
+
+/**
+ * Number of distinct block sizes the texture pool holds at once. When the
+ * pool runs out of sizes or capacity, the textures of the least recently
+ * used size are freed.
+ */
+#define TEXTURE_POOL_BUCKETS 32
+
+/**
+ * Texture pool counters. Hits and misses count every texture allocation
+ * since start.
+ */
+typedef struct {
+    size_t hits;
+    size_t misses;
+
+    // Textures held by the pool and their total size in bytes
+    size_t count;
+    size_t size;
+    size_t capacity;
+} texture_pool_stats_t;
+
+/**
+ * Filter used to downsample texture mip levels. Both only produce colors
+ * found in the level they downsample, so shade tables and palette effects
+ * keep working on every level.
+ */
+typedef enum {
+    // Color of each 2x2 block nearest to the average of its colors
+    MIPMAP_NEAREST,
+
+    // Most common color of each 2x2 block
+    MIPMAP_MAJORITY
+} mipmap_filter_t;
+
+/**
+ * Create a new texture. The texture struct and its pixels are allocated as
+ * a single block, taken from the texture pool if it has one of the right
+ * size. The pool is not thread safe, so textures are created and freed on
+ * the main thread only.
  *
  * @param width Width of texture in pixels
  * @param height Height of texture in pixels
- * @param pixels Pixel data to copy or NULL
+ * @param pixels Pixel data to copy, with rows packed width pixels apart, or
+ * NULL to zero the texture
  * @return New texture if successful, NULL otherwise
  */
 texture_t* graphics_texture_new(int width, int height, const color_t* pixels);
 
 /**
- * Frees a texture.
+ * Create a new texture without initializing its pixels. Cheaper than
+ * graphics_texture_new for textures that are cleared or drawn over
+ * entirely before use, such as off-screen render targets.
  *
- * @param texture Texture to free
+ * @param width Width of texture in pixels
+ * @param height Height of texture in pixels
+ * @return New texture if successful, NULL otherwise
+ */
+texture_t* graphics_texture_acquire(int width, int height);
+
+/**
+ * Create a new 8x8 texture from a 1bpp bitmask. Useful as a dither pattern.
+ *
+ * @param bits Bitmask rows. The first row is the most significant byte and
+ * the leftmost pixel of a row is its most significant bit.
+ * @param foreground Color for set bits
+ * @param background Color for clear bits
+ * @return New texture if successful, NULL otherwise
+ */
+texture_t* graphics_texture_bitmask_new(uint64_t bits, color_t foreground, color_t background);
+
+/**
+ * Build mip chain for texture, replacing any existing chain. Each level is
+ * half the size of the one before, rounded up, down to 1x1. Levels are not
+ * updated when the texture changes, so the chain must be rebuilt after.
+ *
+ * @param texture Texture to build mip chain for
+ * @param filter Downsampling filter. MIPMAP_NEAREST uses the current
+ * palette, and both treat the current transparent color as transparent.
+ * @return true if successful, false otherwise
+ */
+bool graphics_texture_mipmaps_build(texture_t* texture, mipmap_filter_t filter);
+
+/**
+ * Free mip chain of texture.
+ *
+ * @param texture Texture to free mip chain of
+ */
+void graphics_texture_mipmaps_free(texture_t* texture);
+
+/**
+ * Get mip level to sample for given texel step. A level is used once one
+ * pixel steps over at least one of its texels.
+ *
+ * @param texture Texture to sample
+ * @param step Full resolution texels per pixel
+ * @return Mip level, 0 for full resolution or if texture has no chain
+ */
+int graphics_texture_mipmap_level_get(texture_t* texture, float step);
+
+/**
+ * Get texture of mip level.
+ *
+ * @param texture Texture to get mip level of
+ * @param level Mip level, as given by graphics_texture_mipmap_level_get
+ * @return Texture of mip level, texture itself for level 0
+ */
+texture_t* graphics_texture_mipmap_get(texture_t* texture, int level);
+
+/**
+ * Get pixel color from a mip level. Coordinates are in full resolution
+ * texels, and are checked against the full resolution texture.
+ *
+ * @param texture Full resolution texture
+ * @param mipmap Texture of mip level
+ * @param level Mip level
+ * @param x Pixel x-coordinate
+ * @param y Pixel y-coordinate
+ * @return Color at given coordinates
+ */
+color_t graphics_texture_mipmap_pixel_get(texture_t* texture, texture_t* mipmap, int level, int x, int y);
+
+/**
+ * Frees a texture and its mip chain. Whole textures are returned to the
+ * texture pool while it is under capacity.
+ *
+ * @param texture Texture to free. May be NULL.
  */
 void graphics_texture_free(texture_t* texture);
 
 /**
- * Get size of texture struct including size of pixel data
+ * Set number of bytes the texture pool may hold. Pooled textures of the
+ * least recently used sizes are freed until the pool is within capacity.
+ *
+ * @param capacity Capacity in bytes, 0 to disable pooling
+ */
+void graphics_texture_pool_capacity_set(size_t capacity);
+
+/**
+ * Get texture pool counters.
+ *
+ * @param stats Counters
+ */
+void graphics_texture_pool_stats_get(texture_pool_stats_t* stats);
+
+/**
+ * Free every pooled texture. Capacity is kept.
+ */
+void graphics_texture_pool_clear(void);
+
+/**
+ * Get size of texture struct including size of pixel data, row padding and
+ * mip chain. Subtextures only count their struct and mip chain.
  *
  * @param texture Texture to get size of
  * @return Size of given texture
@@ -32,7 +181,7 @@ void graphics_texture_free(texture_t* texture);
 size_t graphics_texture_sizeof(texture_t* texture);
 
 /**
- * Get pointer to texture pixels.
+ * Get pointer to texture pixels. Rows are stride pixels apart.
  *
  * @param texture Texture to get pixels for
  * @return Pointer to texture pixels
@@ -56,7 +205,7 @@ int graphics_texture_width_get(texture_t* texture);
 int graphics_texture_height_get(texture_t* texture);
 
 /**
- * Copy given texture
+ * Copy given texture. The mip chain is not copied.
  *
  * @param texture Texture to copy
  * @return texture_t* New texture if successful, NULL otherwise
@@ -64,7 +213,7 @@ int graphics_texture_height_get(texture_t* texture);
 texture_t* graphics_texture_copy(texture_t* texture);
 
 /**
- * Fill entire texture with color.
+ * Fill entire texture with color. Marks the texture as dirty.
  *
  * @param texture Texture to fill
  * @param color Fill color
@@ -81,7 +230,18 @@ void graphics_texture_clear(texture_t* texture, color_t color);
 texture_t* graphics_texture_sub(texture_t* texture, rect_t* rect);
 
 /**
- * Set pixel color.
+ * Check if the pixels of two textures may share memory, for example a
+ * texture and one of its subtextures.
+ *
+ * @param a Texture to check. May be NULL.
+ * @param b Texture to check. May be NULL.
+ * @return true if pixel memory overlaps, false otherwise
+ */
+bool graphics_texture_overlaps(texture_t* a, texture_t* b);
+
+/**
+ * Set pixel color. Safe to call from draw threads, so the pixel is not
+ * marked as dirty.
  *
  * @param texture Texture to set pixel
  * @param x Pixel x-coordinate
@@ -101,7 +261,8 @@ void graphics_texture_pixel_set(texture_t* texture, int x, int y, color_t color)
 color_t graphics_texture_pixel_get(texture_t* texture, int x, int y);
 
 /**
- * Copy a portion of one texture to another.
+ * Copy a portion of one texture to another. Marks the destination region
+ * as dirty.
  *
  * @param source_texture Texture to copy from
  * @param destination_texture Texture to copy to
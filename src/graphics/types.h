@@ -13,12 +13,38 @@ typedef struct {
 
 typedef uint8_t color_t;
 
-typedef struct {
+typedef struct texture_t {
     int width;
     int height;
     int stride;
     bool is_subtexture;
     color_t* pixels;
+
+    // Next smaller mip level, owned by this texture. NULL if none.
+    struct texture_t* mipmap;
 } texture_t;
 
+/**
+ * Horizontal run of opaque pixels in a sprite row.
+ */
+typedef struct {
+    int x;
+    int length;
+    int offset;
+} sprite_run_t;
+
+/**
+ * Texture compiled to runs of opaque pixels. Runs of row y are
+ * runs[rows[y]] up to runs[rows[y + 1]], ordered by x, and their pixels are
+ * stored back to back starting at pixels[run.offset].
+ */
+typedef struct {
+    int width;
+    int height;
+    color_t transparent;
+    int* rows;
+    sprite_run_t* runs;
+    color_t* pixels;
+} sprite_t;
+
 #endif
\ No newline at end of file
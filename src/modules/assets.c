@@ -40,6 +40,35 @@ static int modules_assets_texture_get(lua_State* L) {
     return 1;
 }
 
+/**
+ * Get sprite compiled from texture for given filename and frame. Sprites
+ * are compiled the first time they are requested, with color 0 as the
+ * transparent color.
+ * @function get_sprite
+ * @tparam string filename Name of texture asset to look for
+ * @tparam ?integer frame Index of frame (default 1)
+ * @treturn texture.sprite Sprite userdata if found, nil otherwise.
+ */
+static int modules_assets_sprite_get(lua_State* L) {
+    const char* texture_name = luaL_checkstring(L, 1);
+    int frame = (int)luaL_optnumber(L, 2, 1);
+    sprite_t* sprite = assets_sprite_get(texture_name, frame - 1);
+
+    if (sprite) {
+        lua_pushsprite(L, sprite);
+    }
+    else {
+        if (assets_texture_get(texture_name, 0)) {
+            luaL_error(L, "bad frame: %d for asset: %s", frame, texture_name);
+        }
+        else {
+            luaL_error(L, "missing asset: %s", texture_name);
+        }
+    }
+
+    return 1;
+}
+
 /**
  * Get sound for given filename
  * @function get_sound
@@ -62,6 +91,7 @@ static int modules_assets_sound_get(lua_State* L) {
 
 static const struct luaL_Reg modules_asset_functions[] = {
     {"get_texture", modules_assets_texture_get},
+    {"get_sprite", modules_assets_sprite_get},
     {"get_sound", modules_assets_sound_get},
     {NULL, NULL}
 };
@@ -3,19 +3,81 @@
  * @module draw
  */
 
+#include <stdbool.h>
+#include <stdlib.h>
+
 #include <lua/lua.h>
 #include <lua/lauxlib.h>
 #include <lua/lualib.h>
 
 #include "draw.h"
+#include "float_array.h"
+#include "luautils.h"
 #include "matrix3.h"
 #include "texture.h"
 #include "../assets.h"
+#include "../collections/float_array.h"
 #include "../graphics.h"
+#include "../threads.h"
 
 static texture_t* draw_render_texture_get(void);
 static void draw_render_texture_set(texture_t* texture);
 
+/**
+ * Reads draw function arguments starting at given stack index into a command.
+ */
+typedef void (*draw_check_func_t)(lua_State* L, int index, command_t* command);
+
+static void draw_command_execute(command_t* command) {
+    graphics_command_execute(command, draw_render_texture_get());
+}
+
+/**
+ * Read integer arguments starting at given stack index.
+ */
+static void draw_check_ints(lua_State* L, int index, command_t* command, int count) {
+    for (int i = 0; i < count; i++) {
+        command->ints[i] = (int)luaL_checknumber(L, index + i);
+    }
+}
+
+/**
+ * Read interleaved x, y, u, v vertex arguments starting at given stack index.
+ */
+static void draw_check_vertices(lua_State* L, int index, command_t* command, int count) {
+    for (int i = 0; i < count; i++) {
+        command->ints[i * 2] = (int)luaL_checknumber(L, index + i * 4);
+        command->ints[i * 2 + 1] = (int)luaL_checknumber(L, index + i * 4 + 1);
+        command->floats[i * 2] = luaL_checknumber(L, index + i * 4 + 2);
+        command->floats[i * 2 + 1] = luaL_checknumber(L, index + i * 4 + 3);
+    }
+}
+
+/**
+ * Read either a color or a pattern with optional offsets at given stack index.
+ *
+ * @param count Number of integer arguments already read
+ * @param op Command to use for a color
+ * @param pattern_op Command to use for a pattern
+ */
+static void draw_check_color_or_pattern(lua_State* L, int index, command_t* command, int count, command_op_t op, command_op_t pattern_op) {
+    if (lua_isnumber(L, index)) {
+        command->op = op;
+        command->ints[count] = (int)luaL_checknumber(L, index);
+    }
+    else {
+        command->op = pattern_op;
+        command->texture = luaL_checktexture(L, index);
+        command->ints[count] = (int)luaL_optnumber(L, index + 1, 0);
+        command->ints[count + 1] = (int)luaL_optnumber(L, index + 2, 0);
+    }
+}
+
+static void draw_check_pixel(lua_State* L, int index, command_t* command) {
+    command->op = COMMAND_PIXEL;
+    draw_check_ints(L, index, command, 3);
+}
+
 /**
  * Draw a pixel at given position and color.
  * @function pixel
@@ -24,18 +86,21 @@ static void draw_render_texture_set(texture_t* texture);
  * @tparam integer color Pixel color
  */
 static int modules_draw_pixel(lua_State* L) {
-    int x = (int)luaL_checknumber(L, 1);
-    int y = (int)luaL_checknumber(L, 2);
-    int color = (int)luaL_checknumber(L, 3);
+    command_t command;
+    draw_check_pixel(L, 1, &command);
 
     lua_settop(L, 0);
 
-    texture_t* render_texture = draw_render_texture_get();
-    graphics_draw_pixel(render_texture, x, y, color);
+    draw_command_execute(&command);
 
     return 0;
 }
 
+static void draw_check_line(lua_State* L, int index, command_t* command) {
+    draw_check_ints(L, index, command, 4);
+    draw_check_color_or_pattern(L, index + 4, command, 4, COMMAND_LINE, COMMAND_PATTERN_LINE);
+}
+
 /**
  * Draw a line between given position and color.
  * @function line
@@ -46,29 +111,22 @@ static int modules_draw_pixel(lua_State* L) {
  * @tparam integer color Line color
  */
 static int modules_draw_line(lua_State* L) {
-    int x0 = (int)luaL_checknumber(L, 1);
-    int y0 = (int)luaL_checknumber(L, 2);
-    int x1 = (int)luaL_checknumber(L, 3);
-    int y1 = (int)luaL_checknumber(L, 4);
-
-    texture_t* render_texture = draw_render_texture_get();
-
-    if (lua_isnumber(L, 5)) {
-        int color = (int)luaL_checknumber(L, 5);
-        graphics_draw_line(render_texture, x0, y0, x1, y1, color);
-    }
-    else {
-        texture_t* pattern = luaL_checktexture(L, 5);
-        int offset_x = (int)luaL_optnumber(L, 6, 0);
-        int offset_y = (int)luaL_optnumber(L, 7, 0);
-        graphics_draw_pattern_line(render_texture, x0, y0, x1, y1, pattern, offset_x, offset_y);
-    }
+    command_t command;
+    draw_check_line(L, 1, &command);
 
     lua_settop(L, 0);
 
+    draw_command_execute(&command);
+
     return 0;
 }
 
+static void draw_check_textured_line(lua_State* L, int index, command_t* command) {
+    command->op = COMMAND_TEXTURED_LINE;
+    draw_check_vertices(L, index, command, 2);
+    command->texture = luaL_checktexture(L, index + 8);
+}
+
 /**
  * Draw line using affine texture mapping.
  * @function textured_line
@@ -83,24 +141,21 @@ static int modules_draw_line(lua_State* L) {
  * @tparam texture.texture texture Texture to map onto line
  */
 static int modules_draw_textured_line(lua_State* L) {
-    int x0 = (int)luaL_checknumber(L, 1);
-    int y0 = (int)luaL_checknumber(L, 2);
-    float u0 = luaL_checknumber(L, 3);
-    float v0 = luaL_checknumber(L, 4);
-    int x1 = (int)luaL_checknumber(L, 5);
-    int y1 = (int)luaL_checknumber(L, 6);
-    float u1 = luaL_checknumber(L, 7);
-    float v1 = luaL_checknumber(L, 8);
-    texture_t* texture = luaL_checktexture(L, 9);
+    command_t command;
+    draw_check_textured_line(L, 1, &command);
 
     lua_settop(L, 0);
 
-    texture_t* render_texture = draw_render_texture_get();
-    graphics_draw_textured_line(render_texture, x0, y0, u0, v0, x1, y1, u1, v1, texture);
+    draw_command_execute(&command);
 
     return 0;
 }
 
+static void draw_check_bezier(lua_State* L, int index, command_t* command) {
+    draw_check_ints(L, index, command, 8);
+    draw_check_color_or_pattern(L, index + 8, command, 8, COMMAND_BEZIER, COMMAND_PATTERN_BEZIER);
+}
+
 /**
  * Draw a bezier curve with the given anchor and control points, and color.
  * @function bezier
@@ -115,33 +170,48 @@ static int modules_draw_textured_line(lua_State* L) {
  * @tparam integer color Line color
  */
 static int modules_draw_bezier(lua_State* L) {
-    int x0 = (int)luaL_checknumber(L, 1);
-    int y0 = (int)luaL_checknumber(L, 2);
-    int x1 = (int)luaL_checknumber(L, 3);
-    int y1 = (int)luaL_checknumber(L, 4);
-    int x2 = (int)luaL_checknumber(L, 5);
-    int y2 = (int)luaL_checknumber(L, 6);
-    int x3 = (int)luaL_checknumber(L, 7);
-    int y3 = (int)luaL_checknumber(L, 8);
+    command_t command;
+    draw_check_bezier(L, 1, &command);
 
-    texture_t* render_texture = draw_render_texture_get();
+    lua_settop(L, 0);
 
-    if (lua_isnumber(L, 9)) {
-        int color = (int)luaL_checknumber(L, 9);
-        graphics_draw_bezier(render_texture, x0, y0, x1, y1, x2, y2, x3, y3, color);
-    }
-    else {
-        texture_t* pattern = luaL_checktexture(L, 9);
-        int offset_x = (int)luaL_optnumber(L, 10, 0);
-        int offset_y = (int)luaL_optnumber(L, 11, 0);
-        graphics_draw_pattern_bezier(render_texture, x0, y0, x1, y1, x2, y2, x3, y3, pattern, offset_x, offset_y);
-    }
+    draw_command_execute(&command);
+
+    return 0;
+}
+
+static void draw_check_quadratic_bezier(lua_State* L, int index, command_t* command) {
+    draw_check_ints(L, index, command, 6);
+    draw_check_color_or_pattern(L, index + 6, command, 6, COMMAND_QUADRATIC_BEZIER, COMMAND_PATTERN_QUADRATIC_BEZIER);
+}
+
+/**
+ * Draw a quadratic bezier curve with the given anchor and control points, and color.
+ * @function quadratic_bezier
+ * @tparam integer x0 Start anchor point x-coordinate
+ * @tparam integer y0 Start anchor point y-coordinate
+ * @tparam integer x1 Control point x-coordinate
+ * @tparam integer y1 Control point y-coordinate
+ * @tparam integer x2 End anchor point x-coordinate
+ * @tparam integer y2 End anchor point y-coordinate
+ * @tparam integer color Line color
+ */
+static int modules_draw_quadratic_bezier(lua_State* L) {
+    command_t command;
+    draw_check_quadratic_bezier(L, 1, &command);
 
     lua_settop(L, 0);
 
+    draw_command_execute(&command);
+
     return 0;
 }
 
+static void draw_check_rectangle(lua_State* L, int index, command_t* command) {
+    draw_check_ints(L, index, command, 4);
+    draw_check_color_or_pattern(L, index + 4, command, 4, COMMAND_RECTANGLE, COMMAND_PATTERN_RECTANGLE);
+}
+
 /**
  * Draw rectangle.
  * @function rectangle
@@ -152,29 +222,21 @@ static int modules_draw_bezier(lua_State* L) {
  * @tparam integer color Line color
  */
 static int modules_draw_rectangle(lua_State* L) {
-    int x = (int)luaL_checknumber(L, 1);
-    int y = (int)luaL_checknumber(L, 2);
-    int width = (int)luaL_checknumber(L, 3);
-    int height = (int)luaL_checknumber(L, 4);
-
-    texture_t* render_texture = draw_render_texture_get();
-
-    if (lua_isnumber(L, 5)) {
-        int color = (int)luaL_checknumber(L, 5);
-        graphics_draw_rectangle(render_texture, x, y, width, height, color);
-    }
-    else {
-        texture_t* pattern = luaL_checktexture(L, 5);
-        int offset_x = (int)luaL_optnumber(L, 6, 0);
-        int offset_y = (int)luaL_optnumber(L, 7, 0);
-        graphics_draw_pattern_rectangle(render_texture, x, y, width, height, pattern, offset_x, offset_y);
-    }
+    command_t command;
+    draw_check_rectangle(L, 1, &command);
 
     lua_settop(L, 0);
 
+    draw_command_execute(&command);
+
     return 0;
 }
 
+static void draw_check_filled_rectangle(lua_State* L, int index, command_t* command) {
+    draw_check_ints(L, index, command, 4);
+    draw_check_color_or_pattern(L, index + 4, command, 4, COMMAND_FILLED_RECTANGLE, COMMAND_FILLED_PATTERN_RECTANGLE);
+}
+
 /**
  * Draw filled rectangle.
  * @function filled_rectangle
@@ -185,29 +247,97 @@ static int modules_draw_rectangle(lua_State* L) {
  * @tparam integer color Fill color
  */
 static int modules_draw_filled_rectangle(lua_State* L) {
-    int x = (int)luaL_checknumber(L, 1);
-    int y = (int)luaL_checknumber(L, 2);
-    int width = (int)luaL_checknumber(L, 3);
-    int height = (int)luaL_checknumber(L, 4);
+    command_t command;
+    draw_check_filled_rectangle(L, 1, &command);
 
-    texture_t* render_texture = draw_render_texture_get();
+    lua_settop(L, 0);
 
-    if (lua_isnumber(L, 5)) {
-        int color = (int)luaL_checknumber(L, 5);
-        graphics_draw_filled_rectangle(render_texture, x, y, width, height, color);
-    }
-    else {
-        texture_t* pattern = luaL_checktexture(L, 5);
-        int offset_x = (int)luaL_optnumber(L, 6, 0);
-        int offset_y = (int)luaL_optnumber(L, 7, 0);
-        graphics_draw_filled_pattern_rectangle(render_texture, x, y, width, height, pattern, offset_x, offset_y);
-    }
+    draw_command_execute(&command);
+
+    return 0;
+}
+
+static void draw_check_rounded_rectangle(lua_State* L, int index, command_t* command) {
+    draw_check_ints(L, index, command, 5);
+    draw_check_color_or_pattern(L, index + 5, command, 5, COMMAND_ROUNDED_RECTANGLE, COMMAND_PATTERN_ROUNDED_RECTANGLE);
+}
+
+/**
+ * Draw rectangle with rounded corners.
+ * @function rounded_rectangle
+ * @tparam integer x Rect top left x-coordinate
+ * @tparam integer y Rect top left y-coordinate
+ * @tparam integer width Rect width
+ * @tparam integer height Rect height
+ * @tparam integer radius Corner radius, limited to what fits in the rectangle
+ * @tparam integer color Line color
+ */
+static int modules_draw_rounded_rectangle(lua_State* L) {
+    command_t command;
+    draw_check_rounded_rectangle(L, 1, &command);
 
     lua_settop(L, 0);
 
+    draw_command_execute(&command);
+
+    return 0;
+}
+
+static void draw_check_filled_rounded_rectangle(lua_State* L, int index, command_t* command) {
+    draw_check_ints(L, index, command, 5);
+    draw_check_color_or_pattern(L, index + 5, command, 5, COMMAND_FILLED_ROUNDED_RECTANGLE, COMMAND_FILLED_PATTERN_ROUNDED_RECTANGLE);
+}
+
+/**
+ * Draw filled rectangle with rounded corners.
+ * @function filled_rounded_rectangle
+ * @tparam integer x Rect top left x-coordinate
+ * @tparam integer y Rect top left y-coordinate
+ * @tparam integer width Rect width
+ * @tparam integer height Rect height
+ * @tparam integer radius Corner radius, limited to what fits in the rectangle
+ * @tparam integer color Fill color
+ */
+static int modules_draw_filled_rounded_rectangle(lua_State* L) {
+    command_t command;
+    draw_check_filled_rounded_rectangle(L, 1, &command);
+
+    lua_settop(L, 0);
+
+    draw_command_execute(&command);
+
+    return 0;
+}
+
+static void draw_check_flood_fill(lua_State* L, int index, command_t* command) {
+    draw_check_ints(L, index, command, 2);
+    draw_check_color_or_pattern(L, index + 2, command, 2, COMMAND_FLOOD_FILL, COMMAND_PATTERN_FLOOD_FILL);
+}
+
+/**
+ * Fill region of pixels sharing the color at given position and connected
+ * to it horizontally or vertically. The region ends at the clipping rectangle.
+ * @function flood_fill
+ * @tparam integer x Start x-coordinate
+ * @tparam integer y Start y-coordinate
+ * @tparam integer color Fill color
+ */
+static int modules_draw_flood_fill(lua_State* L) {
+    command_t command;
+    draw_check_flood_fill(L, 1, &command);
+
+    lua_settop(L, 0);
+
+    draw_command_execute(&command);
+
     return 0;
 }
 
+static void draw_check_circle(lua_State* L, int index, command_t* command) {
+    draw_check_ints(L, index, command, 3);
+    draw_check_color_or_pattern(L, index + 3, command, 3, COMMAND_CIRCLE, COMMAND_PATTERN_CIRCLE);
+}
+
 /**
  * Draw circle
  * @function circle
@@ -217,28 +347,21 @@ static int modules_draw_filled_rectangle(lua_State* L) {
  * @tparam integer color Line color
  */
 static int modules_draw_circle(lua_State* L) {
-    int x = (int)luaL_checknumber(L, 1);
-    int y = (int)luaL_checknumber(L, 2);
-    int radius = (int)luaL_checknumber(L, 3);
-
-    texture_t* render_texture = draw_render_texture_get();
-
-    if (lua_isnumber(L, 4)) {
-        int color = (int)luaL_checknumber(L, 4);
-        graphics_draw_circle(render_texture, x, y, radius, color);
-    }
-    else {
-        texture_t* pattern = luaL_checktexture(L, 4);
-        int offset_x = (int)luaL_optnumber(L, 5, 0);
-        int offset_y = (int)luaL_optnumber(L, 6, 0);
-        graphics_draw_pattern_circle(render_texture, x, y, radius, pattern, offset_x, offset_y);
-    }
+    command_t command;
+    draw_check_circle(L, 1, &command);
 
     lua_settop(L, 0);
 
+    draw_command_execute(&command);
+
     return 0;
 }
 
+static void draw_check_filled_circle(lua_State* L, int index, command_t* command) {
+    draw_check_ints(L, index, command, 3);
+    draw_check_color_or_pattern(L, index + 3, command, 3, COMMAND_FILLED_CIRCLE, COMMAND_FILLED_PATTERN_CIRCLE);
+}
+
 /**
  * Draw filled circle
  * @function filled_circle
@@ -248,25 +371,120 @@ static int modules_draw_circle(lua_State* L) {
  * @tparam integer color Fill color
  */
 static int modules_draw_filled_circle(lua_State* L) {
-    int x = (int)luaL_checknumber(L, 1);
-    int y = (int)luaL_checknumber(L, 2);
-    int radius = (int)luaL_checknumber(L, 3);
+    command_t command;
+    draw_check_filled_circle(L, 1, &command);
 
-    texture_t* render_texture = draw_render_texture_get();
+    lua_settop(L, 0);
 
-    if (lua_isnumber(L, 4)) {
-        int color = (int)luaL_checknumber(L, 4);
-        graphics_draw_filled_circle(render_texture, x, y, radius, color);
-    }
-    else {
-        texture_t* pattern = luaL_checktexture(L, 4);
-        int offset_x = (int)luaL_optnumber(L, 5, 0);
-        int offset_y = (int)luaL_optnumber(L, 6, 0);
-        graphics_draw_filled_pattern_circle(render_texture, x, y, radius, pattern, offset_x, offset_y);
-    }
+    draw_command_execute(&command);
+
+    return 0;
+}
+
+static void draw_check_ellipse(lua_State* L, int index, command_t* command) {
+    draw_check_ints(L, index, command, 4);
+    draw_check_color_or_pattern(L, index + 4, command, 4, COMMAND_ELLIPSE, COMMAND_PATTERN_ELLIPSE);
+}
+
+/**
+ * Draw ellipse.
+ * @function ellipse
+ * @tparam integer x Ellipse center x-coordinate
+ * @tparam integer y Ellipse center y-coordinate
+ * @tparam integer radius_x Ellipse radius along the x-axis
+ * @tparam integer radius_y Ellipse radius along the y-axis
+ * @tparam integer color Line color
+ */
+static int modules_draw_ellipse(lua_State* L) {
+    command_t command;
+    draw_check_ellipse(L, 1, &command);
+
+    lua_settop(L, 0);
+
+    draw_command_execute(&command);
+
+    return 0;
+}
+
+static void draw_check_filled_ellipse(lua_State* L, int index, command_t* command) {
+    draw_check_ints(L, index, command, 4);
+    draw_check_color_or_pattern(L, index + 4, command, 4, COMMAND_FILLED_ELLIPSE, COMMAND_FILLED_PATTERN_ELLIPSE);
+}
+
+/**
+ * Draw filled ellipse.
+ * @function filled_ellipse
+ * @tparam integer x Ellipse center x-coordinate
+ * @tparam integer y Ellipse center y-coordinate
+ * @tparam integer radius_x Ellipse radius along the x-axis
+ * @tparam integer radius_y Ellipse radius along the y-axis
+ * @tparam integer color Fill color
+ */
+static int modules_draw_filled_ellipse(lua_State* L) {
+    command_t command;
+    draw_check_filled_ellipse(L, 1, &command);
+
+    lua_settop(L, 0);
+
+    draw_command_execute(&command);
+
+    return 0;
+}
+
+static void draw_check_arc(lua_State* L, int index, command_t* command) {
+    draw_check_ints(L, index, command, 3);
+    command->floats[0] = luaL_checknumber(L, index + 3);
+    command->floats[1] = luaL_checknumber(L, index + 4);
+    draw_check_color_or_pattern(L, index + 5, command, 3, COMMAND_ARC, COMMAND_PATTERN_ARC);
+}
+
+/**
+ * Draw arc of a circle. Angles go clockwise from the positive x-axis, and arcs
+ * spanning a full turn or more draw the whole circle.
+ * @function arc
+ * @tparam integer x Arc center x-coordinate
+ * @tparam integer y Arc center y-coordinate
+ * @tparam integer radius Arc radius
+ * @tparam number start_angle Start angle in radians
+ * @tparam number end_angle End angle in radians
+ * @tparam integer color Line color
+ */
+static int modules_draw_arc(lua_State* L) {
+    command_t command;
+    draw_check_arc(L, 1, &command);
+
+    lua_settop(L, 0);
+
+    draw_command_execute(&command);
+
+    return 0;
+}
+
+static void draw_check_filled_arc(lua_State* L, int index, command_t* command) {
+    draw_check_ints(L, index, command, 3);
+    command->floats[0] = luaL_checknumber(L, index + 3);
+    command->floats[1] = luaL_checknumber(L, index + 4);
+    draw_check_color_or_pattern(L, index + 5, command, 3, COMMAND_FILLED_ARC, COMMAND_FILLED_PATTERN_ARC);
+}
+
+/**
+ * Draw arc filled to its center, like a slice of pie. Same angles as draw.arc.
+ * @function filled_arc
+ * @tparam integer x Arc center x-coordinate
+ * @tparam integer y Arc center y-coordinate
+ * @tparam integer radius Arc radius
+ * @tparam number start_angle Start angle in radians
+ * @tparam number end_angle End angle in radians
+ * @tparam integer color Fill color
+ */
+static int modules_draw_filled_arc(lua_State* L) {
+    command_t command;
+    draw_check_filled_arc(L, 1, &command);
 
     lua_settop(L, 0);
 
+    draw_command_execute(&command);
+
     return 0;
 }
 
@@ -286,6 +504,17 @@ static int modules_clear_screen(lua_State* L) {
     return 0;
 }
 
+static void draw_check_text(lua_State* L, int index, command_t* command) {
+    command->op = COMMAND_TEXT;
+    command->string = luaL_checkstring(L, index);
+    command->ints[0] = (int)luaL_checknumber(L, index + 1);
+    command->ints[1] = (int)luaL_checknumber(L, index + 2);
+
+    // Negative colors use current palette when drawn
+    command->ints[2] = (int)luaL_optnumber(L, index + 3, -1);
+    command->ints[3] = (int)luaL_optnumber(L, index + 4, -1);
+}
+
 /**
  * Draw text to screen.
  * @function text
@@ -296,31 +525,21 @@ static int modules_clear_screen(lua_State* L) {
  * @tparam ?integer background Background color
  */
 static int modules_draw_text(lua_State* L) {
-    color_t* palette = graphics_draw_palette_get();
+    command_t command;
+    draw_check_text(L, 1, &command);
 
-    const char* message = (const char*)luaL_checkstring(L, 1);
-    int x = (int)luaL_checknumber(L, 2);
-    int y = (int)luaL_checknumber(L, 3);
-    int fg = (int)luaL_optnumber(L, 4, palette[1]);
-    int bg = (int)luaL_optnumber(L, 5, palette[0]);
+    draw_command_execute(&command);
 
     lua_settop(L, 0);
 
-    int bg_old = palette[0];
-    int fg_old = palette[1];
-
-    palette[0] = bg;
-    palette[1] = fg;
-
-    texture_t* render_texture = draw_render_texture_get();
-    graphics_draw_text(render_texture, message, x, y);
-
-    palette[0] = bg_old;
-    palette[1] = fg_old;
-
     return 0;
 }
 
+static void draw_check_triangle(lua_State* L, int index, command_t* command) {
+    draw_check_ints(L, index, command, 6);
+    draw_check_color_or_pattern(L, index + 6, command, 6, COMMAND_TRIANGLE, COMMAND_PATTERN_TRIANGLE);
+}
+
 /**
  * Draw triangle.
  * @function triangle
@@ -333,31 +552,21 @@ static int modules_draw_text(lua_State* L) {
  * @tparam integer color Line color
  */
 static int modules_draw_triangle(lua_State* L) {
-    int x0 = (int)luaL_checknumber(L, 1);
-    int y0 = (int)luaL_checknumber(L, 2);
-    int x1 = (int)luaL_checknumber(L, 3);
-    int y1 = (int)luaL_checknumber(L, 4);
-    int x2 = (int)luaL_checknumber(L, 5);
-    int y2 = (int)luaL_checknumber(L, 6);
-
-    texture_t* render_texture = draw_render_texture_get();
-
-    if (lua_isnumber(L, 7)) {
-        int color = (int)luaL_checknumber(L, 7);
-        graphics_draw_triangle(render_texture, x0, y0, x1, y1, x2, y2, color);
-    }
-    else {
-        texture_t* pattern = luaL_checktexture(L, 7);
-        int offset_x = (int)luaL_optnumber(L, 8, 0);
-        int offset_y = (int)luaL_optnumber(L, 9, 0);
-        graphics_draw_pattern_triangle(render_texture, x0, y0, x1, y1, x2, y2, pattern, offset_x, offset_y);
-    }
+    command_t command;
+    draw_check_triangle(L, 1, &command);
 
     lua_settop(L, 0);
 
+    draw_command_execute(&command);
+
     return 0;
 }
 
+static void draw_check_filled_triangle(lua_State* L, int index, command_t* command) {
+    draw_check_ints(L, index, command, 6);
+    draw_check_color_or_pattern(L, index + 6, command, 6, COMMAND_FILLED_TRIANGLE, COMMAND_FILLED_PATTERN_TRIANGLE);
+}
+
 /**
  * Draw filled triangle.
  * @function filled_triangle
@@ -370,31 +579,22 @@ static int modules_draw_triangle(lua_State* L) {
  * @tparam integer color Fill color
  */
 static int modules_draw_filled_triangle(lua_State* L) {
-    int x0 = (int)luaL_checknumber(L, 1);
-    int y0 = (int)luaL_checknumber(L, 2);
-    int x1 = (int)luaL_checknumber(L, 3);
-    int y1 = (int)luaL_checknumber(L, 4);
-    int x2 = (int)luaL_checknumber(L, 5);
-    int y2 = (int)luaL_checknumber(L, 6);
-
-    texture_t* render_texture = draw_render_texture_get();
-
-    if (lua_isnumber(L, 7)) {
-        int color = (int)luaL_checknumber(L, 7);
-        graphics_draw_filled_triangle(render_texture, x0, y0, x1, y1, x2, y2, color);
-    }
-    else {
-        texture_t* pattern = luaL_checktexture(L, 7);
-        int offset_x = (int)luaL_optnumber(L, 8, 0);
-        int offset_y = (int)luaL_optnumber(L, 9, 0);
-        graphics_draw_filled_pattern_triangle(render_texture, x0, y0, x1, y1, x2, y2, pattern, offset_x, offset_y);
-    }
+    command_t command;
+    draw_check_filled_triangle(L, 1, &command);
 
     lua_settop(L, 0);
 
+    draw_command_execute(&command);
+
     return 0;
 }
 
+static void draw_check_textured_triangle(lua_State* L, int index, command_t* command) {
+    command->op = COMMAND_TEXTURED_TRIANGLE;
+    draw_check_vertices(L, index, command, 3);
+    command->texture = luaL_checktexture(L, index + 12);
+}
+
 /**
  * Draw triangle using affine texture mapping.
  * @function textured_triangle
@@ -413,28 +613,21 @@ static int modules_draw_filled_triangle(lua_State* L) {
  * @tparam texture.texture texture Texture to map on triangle
  */
 static int modules_draw_textured_triangle(lua_State* L) {
-    int x0 = (int)luaL_checknumber(L, 1);
-    int y0 = (int)luaL_checknumber(L, 2);
-    float u0 = luaL_checknumber(L, 3);
-    float v0 = luaL_checknumber(L, 4);
-    int x1 = (int)luaL_checknumber(L, 5);
-    int y1 = (int)luaL_checknumber(L, 6);
-    float u1 = luaL_checknumber(L, 7);
-    float v1 = luaL_checknumber(L, 8);
-    int x2 = (int)luaL_checknumber(L, 9);
-    int y2 = (int)luaL_checknumber(L, 10);
-    float u2 = luaL_checknumber(L, 11);
-    float v2 = luaL_checknumber(L, 12);
-    texture_t* texture = luaL_checktexture(L, 13);
+    command_t command;
+    draw_check_textured_triangle(L, 1, &command);
 
     lua_settop(L, 0);
 
-    texture_t* render_texture = draw_render_texture_get();
-    graphics_draw_textured_triangle(render_texture, x0, y0, u0, v0, x1, y1, u1, v1, x2, y2, u2, v2, texture);
+    draw_command_execute(&command);
 
     return 0;
 }
 
+static void draw_check_quad(lua_State* L, int index, command_t* command) {
+    draw_check_ints(L, index, command, 8);
+    draw_check_color_or_pattern(L, index + 8, command, 8, COMMAND_QUAD, COMMAND_PATTERN_QUAD);
+}
+
 /**
  * Draw quad.
  * @function quad
@@ -449,33 +642,21 @@ static int modules_draw_textured_triangle(lua_State* L) {
  * @tparam integer color Line color
  */
 static int modules_draw_quad(lua_State* L) {
-    int x0 = (int)luaL_checknumber(L, 1);
-    int y0 = (int)luaL_checknumber(L, 2);
-    int x1 = (int)luaL_checknumber(L, 3);
-    int y1 = (int)luaL_checknumber(L, 4);
-    int x2 = (int)luaL_checknumber(L, 5);
-    int y2 = (int)luaL_checknumber(L, 6);
-    int x3 = (int)luaL_checknumber(L, 7);
-    int y3 = (int)luaL_checknumber(L, 8);
-
-    texture_t* render_texture = draw_render_texture_get();
-
-    if (lua_isnumber(L, 9)) {
-        int color = (int)luaL_checknumber(L, 9);
-        graphics_draw_quad(render_texture, x0, y0, x1, y1, x2, y2, x3, y3, color);
-    }
-    else {
-        texture_t* pattern = luaL_checktexture(L, 9);
-        int offset_x = (int)luaL_optnumber(L, 10, 0);
-        int offset_y = (int)luaL_optnumber(L, 11, 0);
-        graphics_draw_pattern_quad(render_texture, x0, y0, x1, y1, x2, y2, x3, y3, pattern, offset_x, offset_y);
-    }
+    command_t command;
+    draw_check_quad(L, 1, &command);
 
     lua_settop(L, 0);
 
+    draw_command_execute(&command);
+
     return 0;
 }
 
+static void draw_check_filled_quad(lua_State* L, int index, command_t* command) {
+    draw_check_ints(L, index, command, 8);
+    draw_check_color_or_pattern(L, index + 8, command, 8, COMMAND_FILLED_QUAD, COMMAND_FILLED_PATTERN_QUAD);
+}
+
 /**
  * Draw filled quad.
  * @function filled_quad
@@ -490,33 +671,22 @@ static int modules_draw_quad(lua_State* L) {
  * @tparam integer color Fill color
  */
 static int modules_draw_filled_quad(lua_State* L) {
-    int x0 = (int)luaL_checknumber(L, 1);
-    int y0 = (int)luaL_checknumber(L, 2);
-    int x1 = (int)luaL_checknumber(L, 3);
-    int y1 = (int)luaL_checknumber(L, 4);
-    int x2 = (int)luaL_checknumber(L, 5);
-    int y2 = (int)luaL_checknumber(L, 6);
-    int x3 = (int)luaL_checknumber(L, 7);
-    int y3 = (int)luaL_checknumber(L, 8);
-
-    texture_t* render_texture = draw_render_texture_get();
-
-    if (lua_isnumber(L, 9)) {
-        int color = (int)luaL_checknumber(L, 9);
-        graphics_draw_filled_quad(render_texture, x0, y0, x1, y1, x2, y2, x3, y3, color);
-    }
-    else {
-        texture_t* pattern = luaL_checktexture(L, 9);
-        int offset_x = (int)luaL_optnumber(L, 10, 0);
-        int offset_y = (int)luaL_optnumber(L, 11, 0);
-        graphics_draw_filled_pattern_quad(render_texture, x0, y0, x1, y1, x2, y2, x3, y3, pattern, offset_x, offset_y);
-    }
+    command_t command;
+    draw_check_filled_quad(L, 1, &command);
 
     lua_settop(L, 0);
 
+    draw_command_execute(&command);
+
     return 0;
 }
 
+static void draw_check_textured_quad(lua_State* L, int index, command_t* command) {
+    command->op = COMMAND_TEXTURED_QUAD;
+    draw_check_vertices(L, index, command, 4);
+    command->texture = luaL_checktexture(L, index + 16);
+}
+
 /**
  * Draw quad using affine texture mapping.
  * @function textured_quad
@@ -539,81 +709,345 @@ static int modules_draw_filled_quad(lua_State* L) {
  * @tparam texture.texture texture Texture to map onto quad
  */
 static int modules_draw_textured_quad(lua_State* L) {
-    int x0 = (int)luaL_checknumber(L, 1);
-    int y0 = (int)luaL_checknumber(L, 2);
-    float u0 = luaL_checknumber(L, 3);
-    float v0 = luaL_checknumber(L, 4);
-    int x1 = (int)luaL_checknumber(L, 5);
-    int y1 = (int)luaL_checknumber(L, 6);
-    float u1 = luaL_checknumber(L, 7);
-    float v1 = luaL_checknumber(L, 8);
-    int x2 = (int)luaL_checknumber(L, 9);
-    int y2 = (int)luaL_checknumber(L, 10);
-    float u2 = luaL_checknumber(L, 11);
-    float v2 = luaL_checknumber(L, 12);
-    int x3 = (int)luaL_checknumber(L, 13);
-    int y3 = (int)luaL_checknumber(L, 14);
-    float u3 = luaL_checknumber(L, 15);
-    float v3 = luaL_checknumber(L, 16);
-    texture_t* texture = luaL_checktexture(L, 17);
+    command_t command;
+    draw_check_textured_quad(L, 1, &command);
 
     lua_settop(L, 0);
 
-    texture_t* render_texture = draw_render_texture_get();
-    graphics_draw_textured_quad(render_texture, x0, y0, u0, v0, x1, y1, u1, v1, x2, y2, u2, v2, x3, y3, u3, v3, texture);
+    draw_command_execute(&command);
 
     return 0;
 }
 
-/**
- * Draw texture with affine transformation.
- * @function texture
- * @tparam texture.texture texture Texture to draw
- * @tparam matrix3.matrix3 matrix Affine transformation to use when drawing
- */
+// Vertices of the polygon being drawn. Batches copy them when recording and
+// immediate draws are done before the next polygon is read.
+static int* polygon_points = NULL;
+static float* polygon_coordinates = NULL;
+static size_t polygon_capacity = 0;
 
 /**
- * Draw texture.
- * @function texture
- * @tparam texture.texture texture Texture to draw
- * @tparam integer x Texture x-coordinate
- * @tparam integer y Texture y-coordinate
- * @tparam ?integer width Texture width
- * @tparam ?integer height Texture height
+ * Read polygon vertices from a table or floatarray at given stack index.
+ *
+ * @param stride Number of values per vertex. 2 for x, y or 4 for x, y, u, v.
  */
-static int modules_draw_texture(lua_State* L) {
-    texture_t* texture = luaL_checktexture(L, 1);
+static void draw_check_polygon_vertices(lua_State* L, int index, command_t* command, int stride) {
+    float_array_t* array = NULL;
+    size_t length = 0;
+
+    if (lua_type(L, index) == LUA_TUSERDATA) {
+        array = luaL_checkfloatarray(L, index);
+        length = array->size;
+    }
+    else {
+        luaL_checktype(L, index, LUA_TTABLE);
+        length = lua_rawlen(L, index);
+    }
+
+    if (length % stride != 0) {
+        luaL_argerror(L, index, "incomplete vertex");
+    }
 
-    if (lua_gettop(L) == 2) {
-        mfloat_t* matrix = luaL_checkmatrix3(L, 2);
+    size_t count = length / stride;
 
-        graphics_draw_affine_texture(
-            draw_render_texture_get(),
-            texture,
-            matrix
-        );
+    if (count > polygon_capacity) {
+        int* points = (int*)realloc(polygon_points, count * 2 * sizeof(int));
+        if (points) polygon_points = points;
 
-        return 0;
+        float* coordinates = (float*)realloc(polygon_coordinates, count * 2 * sizeof(float));
+        if (coordinates) polygon_coordinates = coordinates;
+
+        if (!points || !coordinates) {
+            luaL_error(L, "error reading polygon");
+        }
+
+        polygon_capacity = count;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        lua_Number value = 0;
+
+        if (array) {
+            value = array->data[i];
+        }
+        else {
+            int is_number = 0;
+            lua_rawgeti(L, index, i + 1);
+            value = lua_tonumberx(L, -1, &is_number);
+            lua_pop(L, 1);
+
+            if (!is_number) {
+                luaL_argerror(L, index, "vertex values must be numbers");
+            }
+        }
+
+        size_t vertex = i / stride;
+        size_t component = i % stride;
+
+        if (component < 2) {
+            polygon_points[vertex * 2 + component] = (int)value;
+        }
+        else {
+            polygon_coordinates[vertex * 2 + component - 2] = value;
+        }
+    }
+
+    command->points = polygon_points;
+    command->coordinates = stride == 4 ? polygon_coordinates : NULL;
+    command->point_count = count;
+}
+
+/**
+ * Read optional fill rule name at given stack index.
+ */
+static fill_rule_t draw_check_fill_rule(lua_State* L, int index) {
+    static const char* rules[] = {"evenodd", "nonzero", NULL};
+
+    return (fill_rule_t)luaL_checkoption(L, index, "evenodd", rules);
+}
+
+static void draw_check_polyline(lua_State* L, int index, command_t* command) {
+    draw_check_polygon_vertices(L, index, command, 2);
+    draw_check_color_or_pattern(L, index + 1, command, 0, COMMAND_POLYLINE, COMMAND_PATTERN_POLYLINE);
+}
+
+/**
+ * Draw open line through given points. Shared joints are drawn once.
+ * @function polyline
+ * @tparam table|floatarray.floatarray points Interleaved x, y coordinates
+ * @tparam integer color Line color
+ */
+static int modules_draw_polyline(lua_State* L) {
+    command_t command;
+    draw_check_polyline(L, 1, &command);
+
+    lua_settop(L, 0);
+
+    draw_command_execute(&command);
+
+    return 0;
+}
+
+/**
+ * Read list of curves with given number of points each at given stack index.
+ */
+static void draw_check_curves(lua_State* L, int index, command_t* command, int points_per_curve) {
+    draw_check_polygon_vertices(L, index, command, 2);
+
+    if (command->point_count % points_per_curve != 0) {
+        luaL_argerror(L, index, "incomplete curve");
+    }
+}
+
+static void draw_check_beziers(lua_State* L, int index, command_t* command) {
+    draw_check_curves(L, index, command, 4);
+    draw_check_color_or_pattern(L, index + 1, command, 0, COMMAND_BEZIERS, COMMAND_PATTERN_BEZIERS);
+}
+
+/**
+ * Draw list of bezier curves. Curves starting where the previous one ended
+ * are drawn as one continuous line.
+ * @function beziers
+ * @tparam table|floatarray.floatarray points Interleaved x, y coordinates, four anchor and control points per curve
+ * @tparam integer color Line color
+ */
+static int modules_draw_beziers(lua_State* L) {
+    command_t command;
+    draw_check_beziers(L, 1, &command);
+
+    lua_settop(L, 0);
+
+    draw_command_execute(&command);
+
+    return 0;
+}
+
+static void draw_check_quadratic_beziers(lua_State* L, int index, command_t* command) {
+    draw_check_curves(L, index, command, 3);
+    draw_check_color_or_pattern(L, index + 1, command, 0, COMMAND_QUADRATIC_BEZIERS, COMMAND_PATTERN_QUADRATIC_BEZIERS);
+}
+
+/**
+ * Draw list of quadratic bezier curves. Curves starting where the previous
+ * one ended are drawn as one continuous line.
+ * @function quadratic_beziers
+ * @tparam table|floatarray.floatarray points Interleaved x, y coordinates, three anchor and control points per curve
+ * @tparam integer color Line color
+ */
+static int modules_draw_quadratic_beziers(lua_State* L) {
+    command_t command;
+    draw_check_quadratic_beziers(L, 1, &command);
+
+    lua_settop(L, 0);
+
+    draw_command_execute(&command);
+
+    return 0;
+}
+
+static void draw_check_polygon(lua_State* L, int index, command_t* command) {
+    draw_check_polygon_vertices(L, index, command, 2);
+    draw_check_color_or_pattern(L, index + 1, command, 0, COMMAND_POLYGON, COMMAND_PATTERN_POLYGON);
+}
+
+/**
+ * Draw closed polygon outline.
+ * @function polygon
+ * @tparam table|floatarray.floatarray points Interleaved x, y vertex coordinates
+ * @tparam integer color Line color
+ */
+static int modules_draw_polygon(lua_State* L) {
+    command_t command;
+    draw_check_polygon(L, 1, &command);
+
+    lua_settop(L, 0);
+
+    draw_command_execute(&command);
+
+    return 0;
+}
+
+static void draw_check_filled_polygon(lua_State* L, int index, command_t* command) {
+    draw_check_polygon_vertices(L, index, command, 2);
+    draw_check_color_or_pattern(L, index + 1, command, 0, COMMAND_FILLED_POLYGON, COMMAND_FILLED_PATTERN_POLYGON);
+
+    // Fill rule follows the color, or the pattern and its offsets
+    if (command->op == COMMAND_FILLED_POLYGON) {
+        command->ints[1] = draw_check_fill_rule(L, index + 2);
+    }
+    else {
+        command->ints[2] = draw_check_fill_rule(L, index + 4);
+    }
+}
+
+/**
+ * Draw filled polygon. Polygons can be concave and self-intersecting.
+ * @function filled_polygon
+ * @tparam table|floatarray.floatarray points Interleaved x, y vertex coordinates
+ * @tparam integer color Fill color
+ * @tparam ?string rule Fill rule, either "evenodd" or "nonzero" (default "evenodd")
+ */
+static int modules_draw_filled_polygon(lua_State* L) {
+    command_t command;
+    draw_check_filled_polygon(L, 1, &command);
+
+    lua_settop(L, 0);
+
+    draw_command_execute(&command);
+
+    return 0;
+}
+
+static void draw_check_textured_polygon(lua_State* L, int index, command_t* command) {
+    command->op = COMMAND_TEXTURED_POLYGON;
+    draw_check_polygon_vertices(L, index, command, 4);
+    command->texture = luaL_checktexture(L, index + 1);
+    command->ints[0] = draw_check_fill_rule(L, index + 2);
+}
+
+/**
+ * Draw filled polygon using affine texture mapping. The mapping is the
+ * affine transform that best fits the vertices' texture coordinates.
+ * @function textured_polygon
+ * @tparam table|floatarray.floatarray vertices Interleaved x, y, u, v vertex values
+ * @tparam texture.texture texture Texture to map onto polygon
+ * @tparam ?string rule Fill rule, either "evenodd" or "nonzero" (default "evenodd")
+ */
+static int modules_draw_textured_polygon(lua_State* L) {
+    command_t command;
+    draw_check_textured_polygon(L, 1, &command);
+
+    lua_settop(L, 0);
+
+    draw_command_execute(&command);
+
+    return 0;
+}
+
+static void draw_check_texture(lua_State* L, int index, command_t* command) {
+    texture_t* texture = luaL_checktexture(L, index);
+    command->texture = texture;
+
+    if (lua_type(L, index + 1) == LUA_TUSERDATA) {
+        static const char* wraps[] = {"border", "clamp", "repeat", NULL};
+        mfloat_t* matrix = luaL_checkmatrix3(L, index + 1);
+
+        command->op = COMMAND_AFFINE_TEXTURE;
+        for (int i = 0; i < 9; i++) {
+            command->floats[i] = matrix[i];
+        }
+
+        command->ints[0] = luaL_checkoption(L, index + 2, "border", wraps);
+
+        return;
     }
 
-    int x = (int)luaL_checknumber(L, 2);
-    int y = (int)luaL_checknumber(L, 3);
-    int width = (int)luaL_optnumber(L, 4, graphics_texture_width_get(texture));
-    int height = (int)luaL_optnumber(L, 5, graphics_texture_height_get(texture));
+    command->op = COMMAND_TEXTURE;
+    command->ints[0] = (int)luaL_checknumber(L, index + 1);
+    command->ints[1] = (int)luaL_checknumber(L, index + 2);
+    command->ints[2] = (int)luaL_optnumber(L, index + 3, graphics_texture_width_get(texture));
+    command->ints[3] = (int)luaL_optnumber(L, index + 4, graphics_texture_height_get(texture));
+}
+
+/**
+ * Draw texture with affine transformation.
+ * @function texture
+ * @tparam texture.texture texture Texture to draw
+ * @tparam matrix3.matrix3 matrix Affine transformation to use when drawing
+ * @tparam ?string wrap How texels outside the texture are sampled. "border"
+ * draws only the texture, "clamp" repeats its edges and "repeat" tiles it.
+ * Clamp and repeat fill the clipping rectangle. (default "border")
+ */
+
+/**
+ * Draw texture.
+ * @function texture
+ * @tparam texture.texture texture Texture to draw
+ * @tparam integer x Texture x-coordinate
+ * @tparam integer y Texture y-coordinate
+ * @tparam ?integer width Texture width
+ * @tparam ?integer height Texture height
+ */
+static int modules_draw_texture(lua_State* L) {
+    command_t command;
+    draw_check_texture(L, 1, &command);
+
+    draw_command_execute(&command);
+
+    return 0;
+}
+
+static void draw_check_sprite(lua_State* L, int index, command_t* command) {
+    command->op = COMMAND_SPRITE;
+    command->sprite = luaL_checksprite(L, index);
+    command->ints[0] = (int)luaL_checknumber(L, index + 1);
+    command->ints[1] = (int)luaL_checknumber(L, index + 2);
+    command->ints[2] = lua_toboolean(L, index + 3);
+    command->ints[3] = lua_toboolean(L, index + 4);
+}
+
+/**
+ * Draw compiled sprite.
+ * @function sprite
+ * @tparam texture.sprite sprite Sprite to draw
+ * @tparam integer x Sprite x-coordinate
+ * @tparam integer y Sprite y-coordinate
+ * @tparam ?boolean flip_x Mirror sprite horizontally (default false)
+ * @tparam ?boolean flip_y Mirror sprite vertically (default false)
+ */
+static int modules_draw_sprite(lua_State* L) {
+    command_t command;
+    draw_check_sprite(L, 1, &command);
 
-    graphics_draw_texture(
-        draw_render_texture_get(),
-        texture,
-        x,
-        y,
-        width,
-        height
-    );
+    draw_command_execute(&command);
 
     return 0;
 }
 
 static texture_t* render_texture = NULL;
+
+// Registry reference keeping the render texture alive while it's in use
+static int render_texture_ref = LUA_NOREF;
+
 static texture_t* draw_render_texture_get(void) {
     if (!render_texture) {
         return graphics_render_texture_get();
@@ -626,6 +1060,8 @@ static void draw_render_texture_set(texture_t* texture) {
     render_texture = texture;
 }
 
+static thread_pool_t* thread_pool = NULL;
+
 /**
  * Set color for draw palette.
  * @function set_palette_color
@@ -656,6 +1092,129 @@ static int modules_draw_transparent_color_set(lua_State* L) {
     return 0;
 }
 
+// Builtin blend modes, in the same order as blend_op_t
+static const char* blend_modes[] = {"translucent", "add", "multiply", NULL};
+
+// Registry reference keeping the current blend table alive while it's in
+// use. LUA_NOREF if the table isn't owned by Lua.
+static int blend_table_ref = LUA_NOREF;
+
+/**
+ * Keep userdata at stack index alive by registry reference, releasing the
+ * value previously kept by it. Other values just release it.
+ */
+static void draw_anchor_set(lua_State* L, int* ref, int index) {
+    index = lua_absindex(L, index);
+
+    luaL_unref(L, LUA_REGISTRYINDEX, *ref);
+    *ref = LUA_NOREF;
+
+    if (lua_type(L, index) != LUA_TUSERDATA) return;
+
+    lua_pushvalue(L, index);
+    *ref = luaL_ref(L, LUA_REGISTRYINDEX);
+}
+
+static blend_table_t* luaL_checkblendtable(lua_State* L, int index) {
+    return (blend_table_t*)luaL_checkudata(L, index, "blend_table");
+}
+
+static void draw_check_blend_mode(lua_State* L, int index, command_t* command) {
+    command->op = COMMAND_BLEND_TABLE;
+    command->blend_table = NULL;
+
+    if (lua_isnoneornil(L, index)) return;
+
+    if (lua_type(L, index) == LUA_TUSERDATA) {
+        command->blend_table = luaL_checkblendtable(L, index);
+        return;
+    }
+
+    blend_op_t op = (blend_op_t)luaL_checkoption(L, index, NULL, blend_modes);
+    command->blend_table = graphics_blend_table_builtin_get(op);
+
+    if (!command->blend_table) {
+        luaL_error(L, "error creating blend table");
+    }
+}
+
+/**
+ * Sets how drawn pixels combine with the pixels already drawn. Colors are
+ * blended in RGB using the global palette and matched to the nearest palette
+ * color through a lookup table. Tables follow palette changes. Text is not
+ * blended and transparent pixels are still skipped.
+ * @function set_blend_mode
+ * @tparam ?string|blend_table mode "translucent" for 50% translucency, "add",
+ * "multiply" or a table from draw.new_blend_table. Nil to stop blending.
+ */
+static int modules_draw_blend_mode_set(lua_State* L) {
+    command_t command;
+    draw_check_blend_mode(L, 1, &command);
+
+    draw_command_execute(&command);
+    draw_anchor_set(L, &blend_table_ref, 1);
+
+    lua_settop(L, 0);
+
+    return 0;
+}
+
+/**
+ * Calls the Lua function at stack index 1 to blend two palette colors.
+ */
+static uint32_t draw_blend_lua(uint32_t source, uint32_t destination, void* data) {
+    lua_State* L = (lua_State*)data;
+
+    lua_pushvalue(L, 1);
+
+    for (int i = 0; i < 3; i++) {
+        lua_pushinteger(L, (source >> (i * 8)) & 0xFF);
+    }
+
+    for (int i = 0; i < 3; i++) {
+        lua_pushinteger(L, (destination >> (i * 8)) & 0xFF);
+    }
+
+    lua_call(L, 6, 3);
+
+    uint32_t color = 0xFF000000;
+
+    for (int i = 0; i < 3; i++) {
+        int value = (int)lua_tonumber(L, i - 3);
+        value = value < 0 ? 0 : value > 255 ? 255 : value;
+        color |= (uint32_t)value << (i * 8);
+    }
+
+    lua_pop(L, 3);
+
+    return color;
+}
+
+/**
+ * Creates a blend table for a custom operation. The function is called for
+ * every pair of global palette colors, so the table is built for the palette
+ * at the time of the call and does not follow later palette changes.
+ * @function new_blend_table
+ * @tparam function func Called with source r, g, b and destination r, g, b
+ * values in [0, 255], returns blended r, g, b values
+ * @treturn blend_table
+ */
+static int modules_draw_blend_table_new(lua_State* L) {
+    luaL_checktype(L, 1, LUA_TFUNCTION);
+    lua_settop(L, 1);
+
+    blend_table_t* table = (blend_table_t*)lua_newuserdatauv(L, sizeof(blend_table_t), 0);
+    luaL_setmetatable(L, "blend_table");
+
+    graphics_blend_table_build(table, graphics_palette_get(), draw_blend_lua, L);
+
+    table->func = NULL;
+    table->data = NULL;
+    table->palette_version = graphics_palette_version_get();
+
+    return 1;
+}
+
 /**
  * Sets clipping rectangle which defines drawable area.
  * @function set_clipping_rectangle
@@ -705,43 +1264,909 @@ static int modules_draw_render_texture_get(lua_State* L) {
 static int modules_draw_render_texture_set(lua_State* L) {
     if (lua_gettop(L) == 0 || lua_isnil(L, 1)) {
         draw_render_texture_set(NULL);
+        draw_anchor_set(L, &render_texture_ref, 1);
+
         return 0;
     }
 
     texture_t* texture = luaL_checktexture(L, 1);
     draw_render_texture_set(texture);
+    draw_anchor_set(L, &render_texture_ref, 1);
+
+    return 0;
+}
+
+/**
+ * Set number of worker threads used to draw submitted batches. The result is
+ * the same as drawing on a single thread.
+ * @function set_thread_count
+ * @tparam integer count Number of worker threads. Less than 2 draws batches
+ * on the calling thread.
+ */
+static int modules_draw_thread_count_set(lua_State* L) {
+    int count = (int)luaL_checknumber(L, 1);
+
+    lua_settop(L, 0);
+
+    threads_thread_pool_free(thread_pool);
+    thread_pool = NULL;
+
+    if (count > 1) {
+        thread_pool = threads_thread_pool_new(count);
+    }
 
     return 0;
 }
 
+/**
+ * Free module state when the Lua state closes, on shutdown and reload.
+ */
+static int modules_draw_close(lua_State* L) {
+    threads_thread_pool_free(thread_pool);
+    thread_pool = NULL;
 
-static const struct luaL_Reg modules_draw_functions[] = {
-    {"pixel", modules_draw_pixel},
-    {"line", modules_draw_line},
-    {"textured_line", modules_draw_textured_line},
-    {"bezier", modules_draw_bezier},
-    {"rectangle", modules_draw_rectangle},
-    {"filled_rectangle", modules_draw_filled_rectangle},
-    {"circle", modules_draw_circle},
-    {"filled_circle", modules_draw_filled_circle},
-    {"clear", modules_clear_screen},
-    {"text", modules_draw_text},
-    {"triangle", modules_draw_triangle},
-    {"filled_triangle", modules_draw_filled_triangle},
-    {"textured_triangle", modules_draw_textured_triangle},
-    {"quad", modules_draw_quad},
-    {"filled_quad", modules_draw_filled_quad},
-    {"textured_quad", modules_draw_textured_quad},
-    {"texture", modules_draw_texture},
-    {"set_palette_color", modules_draw_palette_color_set},
-    {"set_transparent_color", modules_draw_transparent_color_set},
-    {"set_clipping_rectangle", modules_draw_clipping_rectangle_set},
-    {"get_render_texture", modules_draw_render_texture_get},
-    {"set_render_texture", modules_draw_render_texture_set},
-    {NULL, NULL}
-};
+    // References belong to the closing state and its tables and textures
+    // are collected
+    graphics_draw_blend_table_set(NULL);
+    blend_table_ref = LUA_NOREF;
+
+    draw_render_texture_set(NULL);
+    render_texture_ref = LUA_NOREF;
+
+    return 0;
+}
+
+/**
+ * @type Batch
+ */
+
+static command_buffer_t* luaL_checkbatch(lua_State* L, int index) {
+    command_buffer_t** handle = NULL;
+    luaL_checktype(L, index, LUA_TUSERDATA);
+    handle = (command_buffer_t**)luaL_checkudata(L, index, "draw_batch");
+
+    return *handle;
+}
+
+/**
+ * Record a command into the batch at stack index 1. Textures and sprites
+ * used by the command are kept alive for as long as the batch references them.
+ */
+static int draw_batch_add(lua_State* L, draw_check_func_t check) {
+    command_buffer_t* buffer = luaL_checkbatch(L, 1);
+
+    command_t command;
+    check(L, 2, &command);
+
+    int top = lua_gettop(L);
+    lua_getiuservalue(L, 1, 1);
+    for (int i = 2; i <= top; i++) {
+        if (lua_type(L, i) == LUA_TUSERDATA) {
+            lua_pushvalue(L, i);
+            lua_pushboolean(L, true);
+            lua_rawset(L, -3);
+        }
+    }
+    lua_pop(L, 1);
+
+    if (!graphics_command_buffer_add(buffer, &command)) {
+        luaL_error(L, "error recording draw command");
+    }
+
+    lua_settop(L, 0);
+
+    return 0;
+}
+
+/**
+ * Creates an empty draw batch. Draw calls recorded into a batch run in a
+ * single call to Batch:submit and can be submitted again every frame without
+ * being recorded again.
+ * @function Batch.new
+ * @treturn Batch
+ */
+static int modules_draw_batch_new(lua_State* L) {
+    command_buffer_t** handle = (command_buffer_t**)lua_newuserdatauv(L, sizeof(command_buffer_t*), 1);
+    *handle = graphics_command_buffer_new();
+
+    if (!*handle) {
+        luaL_error(L, "error creating batch");
+        return 0;
+    }
+
+    luaL_setmetatable(L, "draw_batch");
+
+    lua_newtable(L);
+    lua_setiuservalue(L, -2, 1);
+
+    return 1;
+}
+
+static int modules_draw_batch_free(lua_State* L) {
+    command_buffer_t** handle = lua_touserdata(L, 1);
+    graphics_command_buffer_free(*handle);
+    *handle = NULL;
+
+    return 0;
+}
+
+/**
+ * Removes all recorded commands.
+ * @function Batch:reset
+ */
+static int modules_draw_batch_reset(lua_State* L) {
+    command_buffer_t* buffer = luaL_checkbatch(L, 1);
+    graphics_command_buffer_clear(buffer);
+
+    lua_newtable(L);
+    lua_setiuservalue(L, 1, 1);
+
+    lua_settop(L, 0);
+
+    return 0;
+}
+
+/**
+ * Keep the userdata used by the batch at stack index 1 that is pointer, or
+ * is the texture handle holding it, alive by registry reference. A batch
+ * only keeps its userdata alive until it's reset or collected, while state
+ * it changed remains in effect.
+ */
+static void draw_batch_anchor_set(lua_State* L, int* ref, void* pointer) {
+    lua_getiuservalue(L, 1, 1);
+    lua_pushnil(L);
+
+    while (lua_next(L, -2)) {
+        lua_pop(L, 1);
+
+        if (pointer && (lua_touserdata(L, -1) == pointer || lua_totexture(L, -1) == pointer)) {
+            draw_anchor_set(L, ref, -1);
+            lua_pop(L, 2);
+
+            return;
+        }
+    }
+
+    lua_pop(L, 1);
+
+    // Not owned by Lua, such as a builtin table or the graphics render
+    // texture, or NULL
+    lua_pushnil(L);
+    draw_anchor_set(L, ref, -1);
+    lua_pop(L, 1);
+}
+
+/**
+ * Executes all recorded commands in order, starting on the current render
+ * texture. Palette, transparency, blend mode, clipping and render texture
+ * changes recorded in the batch remain in effect afterwards. Drawing is split across
+ * worker threads if enabled with draw.set_thread_count.
+ * @function Batch:submit
+ */
+static int modules_draw_batch_submit(lua_State* L) {
+    command_buffer_t* buffer = luaL_checkbatch(L, 1);
+    blend_table_t* blend_table = graphics_draw_blend_table_get();
+
+    texture_t* texture = graphics_command_buffer_execute_parallel(buffer, render_texture, thread_pool);
+
+    if (texture != render_texture) {
+        draw_render_texture_set(texture);
+        draw_batch_anchor_set(L, &render_texture_ref, texture);
+    }
+
+    if (graphics_draw_blend_table_get() != blend_table) {
+        draw_batch_anchor_set(L, &blend_table_ref, graphics_draw_blend_table_get());
+    }
+
+    lua_settop(L, 0);
+
+    return 0;
+}
+
+/**
+ * Record pixel. Same arguments as draw.pixel.
+ * @function Batch:pixel
+ */
+static int modules_draw_batch_pixel(lua_State* L) {
+    return draw_batch_add(L, draw_check_pixel);
+}
+
+/**
+ * Record line. Same arguments as draw.line.
+ * @function Batch:line
+ */
+static int modules_draw_batch_line(lua_State* L) {
+    return draw_batch_add(L, draw_check_line);
+}
+
+/**
+ * Record textured line. Same arguments as draw.textured_line.
+ * @function Batch:textured_line
+ */
+static int modules_draw_batch_textured_line(lua_State* L) {
+    return draw_batch_add(L, draw_check_textured_line);
+}
+
+/**
+ * Record bezier curve. Same arguments as draw.bezier.
+ * @function Batch:bezier
+ */
+static int modules_draw_batch_bezier(lua_State* L) {
+    return draw_batch_add(L, draw_check_bezier);
+}
+
+/**
+ * Record quadratic bezier curve. Same arguments as draw.quadratic_bezier.
+ * @function Batch:quadratic_bezier
+ */
+static int modules_draw_batch_quadratic_bezier(lua_State* L) {
+    return draw_batch_add(L, draw_check_quadratic_bezier);
+}
+
+/**
+ * Record list of bezier curves. Same arguments as draw.beziers.
+ * @function Batch:beziers
+ */
+static int modules_draw_batch_beziers(lua_State* L) {
+    return draw_batch_add(L, draw_check_beziers);
+}
+
+/**
+ * Record list of quadratic bezier curves. Same arguments as draw.quadratic_beziers.
+ * @function Batch:quadratic_beziers
+ */
+static int modules_draw_batch_quadratic_beziers(lua_State* L) {
+    return draw_batch_add(L, draw_check_quadratic_beziers);
+}
+
+/**
+ * Record rectangle. Same arguments as draw.rectangle.
+ * @function Batch:rectangle
+ */
+static int modules_draw_batch_rectangle(lua_State* L) {
+    return draw_batch_add(L, draw_check_rectangle);
+}
+
+/**
+ * Record filled rectangle. Same arguments as draw.filled_rectangle.
+ * @function Batch:filled_rectangle
+ */
+static int modules_draw_batch_filled_rectangle(lua_State* L) {
+    return draw_batch_add(L, draw_check_filled_rectangle);
+}
+
+/**
+ * Record rounded rectangle. Same arguments as draw.rounded_rectangle.
+ * @function Batch:rounded_rectangle
+ */
+static int modules_draw_batch_rounded_rectangle(lua_State* L) {
+    return draw_batch_add(L, draw_check_rounded_rectangle);
+}
+
+/**
+ * Record filled rounded rectangle. Same arguments as draw.filled_rounded_rectangle.
+ * @function Batch:filled_rounded_rectangle
+ */
+static int modules_draw_batch_filled_rounded_rectangle(lua_State* L) {
+    return draw_batch_add(L, draw_check_filled_rounded_rectangle);
+}
+
+/**
+ * Record flood fill. Same arguments as draw.flood_fill.
+ * @function Batch:flood_fill
+ */
+static int modules_draw_batch_flood_fill(lua_State* L) {
+    return draw_batch_add(L, draw_check_flood_fill);
+}
+
+/**
+ * Record circle. Same arguments as draw.circle.
+ * @function Batch:circle
+ */
+static int modules_draw_batch_circle(lua_State* L) {
+    return draw_batch_add(L, draw_check_circle);
+}
+
+/**
+ * Record filled circle. Same arguments as draw.filled_circle.
+ * @function Batch:filled_circle
+ */
+static int modules_draw_batch_filled_circle(lua_State* L) {
+    return draw_batch_add(L, draw_check_filled_circle);
+}
+
+/**
+ * Record ellipse. Same arguments as draw.ellipse.
+ * @function Batch:ellipse
+ */
+static int modules_draw_batch_ellipse(lua_State* L) {
+    return draw_batch_add(L, draw_check_ellipse);
+}
+
+/**
+ * Record filled ellipse. Same arguments as draw.filled_ellipse.
+ * @function Batch:filled_ellipse
+ */
+static int modules_draw_batch_filled_ellipse(lua_State* L) {
+    return draw_batch_add(L, draw_check_filled_ellipse);
+}
+
+/**
+ * Record arc. Same arguments as draw.arc.
+ * @function Batch:arc
+ */
+static int modules_draw_batch_arc(lua_State* L) {
+    return draw_batch_add(L, draw_check_arc);
+}
+
+/**
+ * Record filled arc. Same arguments as draw.filled_arc.
+ * @function Batch:filled_arc
+ */
+static int modules_draw_batch_filled_arc(lua_State* L) {
+    return draw_batch_add(L, draw_check_filled_arc);
+}
+
+static void draw_check_clear(lua_State* L, int index, command_t* command) {
+    command->op = COMMAND_CLEAR;
+    draw_check_ints(L, index, command, 1);
+}
+
+/**
+ * Record clear. Same arguments as draw.clear.
+ * @function Batch:clear
+ */
+static int modules_draw_batch_clear(lua_State* L) {
+    return draw_batch_add(L, draw_check_clear);
+}
+
+/**
+ * Record text. Same arguments as draw.text.
+ * @function Batch:text
+ */
+static int modules_draw_batch_text(lua_State* L) {
+    return draw_batch_add(L, draw_check_text);
+}
+
+/**
+ * Record triangle. Same arguments as draw.triangle.
+ * @function Batch:triangle
+ */
+static int modules_draw_batch_triangle(lua_State* L) {
+    return draw_batch_add(L, draw_check_triangle);
+}
+
+/**
+ * Record filled triangle. Same arguments as draw.filled_triangle.
+ * @function Batch:filled_triangle
+ */
+static int modules_draw_batch_filled_triangle(lua_State* L) {
+    return draw_batch_add(L, draw_check_filled_triangle);
+}
+
+/**
+ * Record textured triangle. Same arguments as draw.textured_triangle.
+ * @function Batch:textured_triangle
+ */
+static int modules_draw_batch_textured_triangle(lua_State* L) {
+    return draw_batch_add(L, draw_check_textured_triangle);
+}
+
+/**
+ * Record quad. Same arguments as draw.quad.
+ * @function Batch:quad
+ */
+static int modules_draw_batch_quad(lua_State* L) {
+    return draw_batch_add(L, draw_check_quad);
+}
+
+/**
+ * Record filled quad. Same arguments as draw.filled_quad.
+ * @function Batch:filled_quad
+ */
+static int modules_draw_batch_filled_quad(lua_State* L) {
+    return draw_batch_add(L, draw_check_filled_quad);
+}
+
+/**
+ * Record textured quad. Same arguments as draw.textured_quad.
+ * @function Batch:textured_quad
+ */
+static int modules_draw_batch_textured_quad(lua_State* L) {
+    return draw_batch_add(L, draw_check_textured_quad);
+}
+
+/**
+ * Record polyline. Same arguments as draw.polyline.
+ * @function Batch:polyline
+ */
+static int modules_draw_batch_polyline(lua_State* L) {
+    return draw_batch_add(L, draw_check_polyline);
+}
+
+/**
+ * Record polygon. Same arguments as draw.polygon.
+ * @function Batch:polygon
+ */
+static int modules_draw_batch_polygon(lua_State* L) {
+    return draw_batch_add(L, draw_check_polygon);
+}
+
+/**
+ * Record filled polygon. Same arguments as draw.filled_polygon.
+ * @function Batch:filled_polygon
+ */
+static int modules_draw_batch_filled_polygon(lua_State* L) {
+    return draw_batch_add(L, draw_check_filled_polygon);
+}
+
+/**
+ * Record textured polygon. Same arguments as draw.textured_polygon.
+ * @function Batch:textured_polygon
+ */
+static int modules_draw_batch_textured_polygon(lua_State* L) {
+    return draw_batch_add(L, draw_check_textured_polygon);
+}
+
+/**
+ * Record texture. Same arguments as draw.texture.
+ * @function Batch:texture
+ */
+static int modules_draw_batch_texture(lua_State* L) {
+    return draw_batch_add(L, draw_check_texture);
+}
+
+/**
+ * Record sprite. Same arguments as draw.sprite.
+ * @function Batch:sprite
+ */
+static int modules_draw_batch_sprite(lua_State* L) {
+    return draw_batch_add(L, draw_check_sprite);
+}
+
+static void draw_check_palette_color(lua_State* L, int index, command_t* command) {
+    command->op = COMMAND_PALETTE_COLOR;
+    draw_check_ints(L, index, command, 2);
+}
+
+/**
+ * Record palette color change. Same arguments as draw.set_palette_color.
+ * @function Batch:set_palette_color
+ */
+static int modules_draw_batch_palette_color_set(lua_State* L) {
+    return draw_batch_add(L, draw_check_palette_color);
+}
+
+static void draw_check_transparent_color(lua_State* L, int index, command_t* command) {
+    command->op = COMMAND_TRANSPARENT_COLOR;
+    command->ints[0] = luaL_optinteger(L, index, -1);
+}
+
+/**
+ * Record transparent color change. Same arguments as draw.set_transparent_color.
+ * @function Batch:set_transparent_color
+ */
+static int modules_draw_batch_transparent_color_set(lua_State* L) {
+    return draw_batch_add(L, draw_check_transparent_color);
+}
+
+/**
+ * Record blend mode change. Same arguments as draw.set_blend_mode.
+ * @function Batch:set_blend_mode
+ */
+static int modules_draw_batch_blend_mode_set(lua_State* L) {
+    return draw_batch_add(L, draw_check_blend_mode);
+}
+
+static void draw_check_clipping_rectangle(lua_State* L, int index, command_t* command) {
+    if (lua_gettop(L) < index) {
+        command->op = COMMAND_CLIPPING_RECTANGLE_RESET;
+        return;
+    }
+
+    command->op = COMMAND_CLIPPING_RECTANGLE;
+    draw_check_ints(L, index, command, 4);
+}
+
+/**
+ * Record clipping rectangle change. Same arguments as draw.set_clipping_rectangle.
+ * @function Batch:set_clipping_rectangle
+ */
+static int modules_draw_batch_clipping_rectangle_set(lua_State* L) {
+    return draw_batch_add(L, draw_check_clipping_rectangle);
+}
+
+static void draw_check_render_texture(lua_State* L, int index, command_t* command) {
+    command->op = COMMAND_RENDER_TEXTURE;
+    command->texture = NULL;
+
+    if (!lua_isnoneornil(L, index)) {
+        command->texture = luaL_checktexture(L, index);
+    }
+}
+
+/**
+ * Record render texture change. Same arguments as draw.set_render_texture.
+ * @function Batch:set_render_texture
+ */
+static int modules_draw_batch_render_texture_set(lua_State* L) {
+    return draw_batch_add(L, draw_check_render_texture);
+}
+
+static int modules_draw_batch_meta_len(lua_State* L) {
+    command_buffer_t* buffer = luaL_checkbatch(L, 1);
+
+    lua_settop(L, 0);
+    lua_pushinteger(L, buffer->count);
+
+    return 1;
+}
+
+static int modules_draw_batch_meta_index(lua_State* L) {
+    luaL_checkbatch(L, 1);
+    const char* key = luaL_checkstring(L, 2);
+
+    lua_settop(L, 0);
+
+    luaL_requiref(L, "draw", NULL, false);
+    lua_getfield(L, -1, "Batch");
+    if (lua_type(L, -1) == LUA_TTABLE) {
+        lua_getfield(L, -1, key);
+    }
+    else {
+        lua_pushnil(L);
+    }
+
+    return 1;
+}
+
+/**
+ * @type SpriteBatch
+ */
+
+static sprite_batch_t* luaL_checkspritebatch(lua_State* L, int index) {
+    sprite_batch_t** handle = NULL;
+    luaL_checktype(L, index, LUA_TUSERDATA);
+    handle = (sprite_batch_t**)luaL_checkudata(L, index, "sprite_batch");
+
+    return *handle;
+}
+
+/**
+ * Creates an empty sprite batch. Sprites added to a batch are drawn in a
+ * single call to SpriteBatch:submit, sorted by depth.
+ * @function SpriteBatch.new
+ * @treturn SpriteBatch
+ */
+static int modules_draw_sprite_batch_new(lua_State* L) {
+    sprite_batch_t** handle = (sprite_batch_t**)lua_newuserdatauv(L, sizeof(sprite_batch_t*), 1);
+    *handle = graphics_sprite_batch_new();
+
+    if (!*handle) {
+        luaL_error(L, "error creating sprite batch");
+        return 0;
+    }
+
+    luaL_setmetatable(L, "sprite_batch");
+
+    lua_newtable(L);
+    lua_setiuservalue(L, -2, 1);
+
+    return 1;
+}
+
+static int modules_draw_sprite_batch_free(lua_State* L) {
+    sprite_batch_t** handle = lua_touserdata(L, 1);
+    graphics_sprite_batch_free(*handle);
+    *handle = NULL;
+
+    return 0;
+}
+
+/**
+ * Adds a sprite. Sprites of equal depth are drawn in the order they were
+ * added.
+ * @function SpriteBatch:add
+ * @tparam texture.texture texture Texture to draw from
+ * @tparam integer x Sprite x-coordinate
+ * @tparam integer y Sprite y-coordinate
+ * @tparam ?integer depth Sprites with greater depth are drawn on top (default 0)
+ * @tparam ?boolean flip_x Mirror sprite horizontally (default false)
+ * @tparam ?boolean flip_y Mirror sprite vertically (default false)
+ * @tparam ?integer palette_offset Added to sprite colors before the draw
+ * palette remaps them. The transparent color is left as is. (default 0)
+ * @tparam ?integer source_x Source region x-coordinate (default 0)
+ * @tparam ?integer source_y Source region y-coordinate (default 0)
+ * @tparam ?integer source_width Source region width (default texture width)
+ * @tparam ?integer source_height Source region height (default texture height)
+ */
+static int modules_draw_sprite_batch_add(lua_State* L) {
+    sprite_batch_t* batch = luaL_checkspritebatch(L, 1);
+    texture_t* texture = luaL_checktexture(L, 2);
+
+    sprite_batch_entry_t entry = {
+        .texture = texture,
+        .x = (int)luaL_checknumber(L, 3),
+        .y = (int)luaL_checknumber(L, 4),
+        .depth = (int)luaL_optnumber(L, 5, 0),
+        .flip_x = lua_toboolean(L, 6),
+        .flip_y = lua_toboolean(L, 7),
+        .palette_offset = (int)luaL_optnumber(L, 8, 0) & 0xFF
+    };
+
+    entry.source.x = (int)luaL_optnumber(L, 9, 0);
+    entry.source.y = (int)luaL_optnumber(L, 10, 0);
+    entry.source.width = (int)luaL_optnumber(L, 11, texture->width);
+    entry.source.height = (int)luaL_optnumber(L, 12, texture->height);
+
+    // Keep texture alive while the batch references it
+    lua_getiuservalue(L, 1, 1);
+    lua_pushvalue(L, 2);
+    lua_pushboolean(L, true);
+    lua_rawset(L, -3);
+
+    if (!graphics_sprite_batch_add(batch, &entry)) {
+        luaL_error(L, "error adding sprite");
+    }
+
+    lua_settop(L, 0);
+
+    return 0;
+}
+
+/**
+ * Removes all sprites.
+ * @function SpriteBatch:reset
+ */
+static int modules_draw_sprite_batch_reset(lua_State* L) {
+    sprite_batch_t* batch = luaL_checkspritebatch(L, 1);
+    graphics_sprite_batch_clear(batch);
+
+    lua_newtable(L);
+    lua_setiuservalue(L, 1, 1);
+
+    lua_settop(L, 0);
+
+    return 0;
+}
+
+/**
+ * Draws all sprites to the current render texture in depth order, using the
+ * current palette, transparency, blend mode and clipping rectangle.
+ * @function SpriteBatch:submit
+ */
+static int modules_draw_sprite_batch_submit(lua_State* L) {
+    sprite_batch_t* batch = luaL_checkspritebatch(L, 1);
+    texture_t* target = draw_render_texture_get();
+
+    rect_t rect;
+    if (graphics_sprite_batch_bounds_get(batch, &rect)) {
+        graphics_dirty_rectangle_add(target, &rect);
+    }
+
+    graphics_draw_sprite_batch(target, batch);
+
+    lua_settop(L, 0);
+
+    return 0;
+}
+
+static int modules_draw_sprite_batch_meta_len(lua_State* L) {
+    sprite_batch_t* batch = luaL_checkspritebatch(L, 1);
+
+    lua_settop(L, 0);
+    lua_pushinteger(L, batch->count);
+
+    return 1;
+}
+
+static int modules_draw_sprite_batch_meta_index(lua_State* L) {
+    luaL_checkspritebatch(L, 1);
+    const char* key = luaL_checkstring(L, 2);
+
+    lua_settop(L, 0);
+
+    luaL_requiref(L, "draw", NULL, false);
+    lua_getfield(L, -1, "SpriteBatch");
+    if (lua_type(L, -1) == LUA_TTABLE) {
+        lua_getfield(L, -1, key);
+    }
+    else {
+        lua_pushnil(L);
+    }
+
+    return 1;
+}
+
+static const char* modules_draw_sprite_batch_fields[] = {
+    "add",
+    "reset",
+    "submit",
+    NULL
+};
+
+static const struct luaL_Reg modules_draw_sprite_batch_functions[] = {
+    {"new", modules_draw_sprite_batch_new},
+    {"add", modules_draw_sprite_batch_add},
+    {"reset", modules_draw_sprite_batch_reset},
+    {"submit", modules_draw_sprite_batch_submit},
+    {NULL, NULL}
+};
+
+static const struct luaL_Reg modules_draw_sprite_batch_meta_functions[] = {
+    {"__index", modules_draw_sprite_batch_meta_index},
+    {"__len", modules_draw_sprite_batch_meta_len},
+    {"__gc", modules_draw_sprite_batch_free},
+    {NULL, NULL}
+};
+
+static const char* modules_draw_batch_fields[] = {
+    "reset",
+    "submit",
+    "pixel",
+    "line",
+    "textured_line",
+    "bezier",
+    "quadratic_bezier",
+    "beziers",
+    "quadratic_beziers",
+    "rectangle",
+    "filled_rectangle",
+    "rounded_rectangle",
+    "filled_rounded_rectangle",
+    "flood_fill",
+    "circle",
+    "filled_circle",
+    "ellipse",
+    "filled_ellipse",
+    "arc",
+    "filled_arc",
+    "clear",
+    "text",
+    "triangle",
+    "filled_triangle",
+    "textured_triangle",
+    "quad",
+    "filled_quad",
+    "textured_quad",
+    "polyline",
+    "polygon",
+    "filled_polygon",
+    "textured_polygon",
+    "texture",
+    "sprite",
+    "set_palette_color",
+    "set_transparent_color",
+    "set_blend_mode",
+    "set_clipping_rectangle",
+    "set_render_texture",
+    NULL
+};
+
+static const struct luaL_Reg modules_draw_batch_functions[] = {
+    {"new", modules_draw_batch_new},
+    {"reset", modules_draw_batch_reset},
+    {"submit", modules_draw_batch_submit},
+    {"pixel", modules_draw_batch_pixel},
+    {"line", modules_draw_batch_line},
+    {"textured_line", modules_draw_batch_textured_line},
+    {"bezier", modules_draw_batch_bezier},
+    {"quadratic_bezier", modules_draw_batch_quadratic_bezier},
+    {"beziers", modules_draw_batch_beziers},
+    {"quadratic_beziers", modules_draw_batch_quadratic_beziers},
+    {"rectangle", modules_draw_batch_rectangle},
+    {"filled_rectangle", modules_draw_batch_filled_rectangle},
+    {"rounded_rectangle", modules_draw_batch_rounded_rectangle},
+    {"filled_rounded_rectangle", modules_draw_batch_filled_rounded_rectangle},
+    {"flood_fill", modules_draw_batch_flood_fill},
+    {"circle", modules_draw_batch_circle},
+    {"filled_circle", modules_draw_batch_filled_circle},
+    {"ellipse", modules_draw_batch_ellipse},
+    {"filled_ellipse", modules_draw_batch_filled_ellipse},
+    {"arc", modules_draw_batch_arc},
+    {"filled_arc", modules_draw_batch_filled_arc},
+    {"clear", modules_draw_batch_clear},
+    {"text", modules_draw_batch_text},
+    {"triangle", modules_draw_batch_triangle},
+    {"filled_triangle", modules_draw_batch_filled_triangle},
+    {"textured_triangle", modules_draw_batch_textured_triangle},
+    {"quad", modules_draw_batch_quad},
+    {"filled_quad", modules_draw_batch_filled_quad},
+    {"textured_quad", modules_draw_batch_textured_quad},
+    {"polyline", modules_draw_batch_polyline},
+    {"polygon", modules_draw_batch_polygon},
+    {"filled_polygon", modules_draw_batch_filled_polygon},
+    {"textured_polygon", modules_draw_batch_textured_polygon},
+    {"texture", modules_draw_batch_texture},
+    {"sprite", modules_draw_batch_sprite},
+    {"set_palette_color", modules_draw_batch_palette_color_set},
+    {"set_transparent_color", modules_draw_batch_transparent_color_set},
+    {"set_blend_mode", modules_draw_batch_blend_mode_set},
+    {"set_clipping_rectangle", modules_draw_batch_clipping_rectangle_set},
+    {"set_render_texture", modules_draw_batch_render_texture_set},
+    {NULL, NULL}
+};
+
+static const struct luaL_Reg modules_draw_batch_meta_functions[] = {
+    {"__index", modules_draw_batch_meta_index},
+    {"__len", modules_draw_batch_meta_len},
+    {"__gc", modules_draw_batch_free},
+    {NULL, NULL}
+};
+
+static const struct luaL_Reg modules_draw_functions[] = {
+    {"pixel", modules_draw_pixel},
+    {"line", modules_draw_line},
+    {"textured_line", modules_draw_textured_line},
+    {"bezier", modules_draw_bezier},
+    {"quadratic_bezier", modules_draw_quadratic_bezier},
+    {"beziers", modules_draw_beziers},
+    {"quadratic_beziers", modules_draw_quadratic_beziers},
+    {"rectangle", modules_draw_rectangle},
+    {"filled_rectangle", modules_draw_filled_rectangle},
+    {"rounded_rectangle", modules_draw_rounded_rectangle},
+    {"filled_rounded_rectangle", modules_draw_filled_rounded_rectangle},
+    {"flood_fill", modules_draw_flood_fill},
+    {"circle", modules_draw_circle},
+    {"filled_circle", modules_draw_filled_circle},
+    {"ellipse", modules_draw_ellipse},
+    {"filled_ellipse", modules_draw_filled_ellipse},
+    {"arc", modules_draw_arc},
+    {"filled_arc", modules_draw_filled_arc},
+    {"clear", modules_clear_screen},
+    {"text", modules_draw_text},
+    {"triangle", modules_draw_triangle},
+    {"filled_triangle", modules_draw_filled_triangle},
+    {"textured_triangle", modules_draw_textured_triangle},
+    {"quad", modules_draw_quad},
+    {"filled_quad", modules_draw_filled_quad},
+    {"textured_quad", modules_draw_textured_quad},
+    {"polyline", modules_draw_polyline},
+    {"polygon", modules_draw_polygon},
+    {"filled_polygon", modules_draw_filled_polygon},
+    {"textured_polygon", modules_draw_textured_polygon},
+    {"texture", modules_draw_texture},
+    {"sprite", modules_draw_sprite},
+    {"set_palette_color", modules_draw_palette_color_set},
+    {"set_transparent_color", modules_draw_transparent_color_set},
+    {"set_blend_mode", modules_draw_blend_mode_set},
+    {"new_blend_table", modules_draw_blend_table_new},
+    {"set_clipping_rectangle", modules_draw_clipping_rectangle_set},
+    {"get_render_texture", modules_draw_render_texture_get},
+    {"set_render_texture", modules_draw_render_texture_set},
+    {"set_thread_count", modules_draw_thread_count_set},
+    {NULL, NULL}
+};
+
+int luaopen_draw(lua_State* L) {
+    luaL_newlib(L, modules_draw_functions);
+
+    // Module table is finalized when the Lua state closes
+    lua_newtable(L);
+    lua_pushcfunction(L, modules_draw_close);
+    lua_setfield(L, -2, "__gc");
+    lua_setmetatable(L, -2);
+
+    lua_pushstring(L, "Batch");
+    luaL_newlib(L, modules_draw_batch_functions);
+    lua_settable(L, -3);
+
+    lua_pushstring(L, "SpriteBatch");
+    luaL_newlib(L, modules_draw_sprite_batch_functions);
+    lua_settable(L, -3);
+
+    luaL_newmetatable(L, "draw_batch");
+    luaL_setfuncs(L, modules_draw_batch_meta_functions, 0);
+    lua_setdummyfields(L, modules_draw_batch_fields);
+    lua_pop(L, 1);
+
+    luaL_newmetatable(L, "sprite_batch");
+    luaL_setfuncs(L, modules_draw_sprite_batch_meta_functions, 0);
+    lua_setdummyfields(L, modules_draw_sprite_batch_fields);
+    lua_pop(L, 1);
+
+    luaL_newmetatable(L, "blend_table");
+    lua_pop(L, 1);
 
-int luaopen_draw(lua_State* L) {
-    luaL_newlib(L, modules_draw_functions);
     return 1;
 }
@@ -30,8 +30,7 @@ static int modules_graphics_pixel_set(lua_State* L) {
 
     lua_pop(L, -1);
 
-    texture_t* render_texture = graphics_render_texture_get();
-    graphics_texture_pixel_set(render_texture, x, y, color);
+    graphics_pixel_set(x, y, color);
 
     return 0;
 }
@@ -128,9 +127,7 @@ static int modules_graphics_palette_color_set(lua_State* L) {
 
     uint32_t color = a << 24 | b << 16 | g << 8 | r;
 
-    uint32_t* palette = NULL;
-    palette = graphics_palette_get();
-    palette[index] = color;
+    graphics_palette_color_set(index, color);
 
     return 0;
 }
@@ -20,6 +20,10 @@ texture_t* luaL_checktexture(lua_State* L, int index) {
     texture_t** handle = NULL;
     luaL_checktype(L, index, LUA_TUSERDATA);
 
+    if (luaL_testudata(L, index, "texture_released")) {
+        luaL_error(L, "attempt to use a released texture");
+    }
+
     // Ensure we have correct userdata
     handle = (texture_t**)luaL_testudata(L, index, "texture_nogc");
     if (!handle) {
@@ -48,6 +52,15 @@ texture_t* luaL_opttexture(lua_State* L, int index, texture_t* default_) {
     return *handle;
 }
 
+texture_t* lua_totexture(lua_State* L, int index) {
+    texture_t** handle = (texture_t**)luaL_testudata(L, index, "texture");
+    if (!handle) {
+        handle = (texture_t**)luaL_testudata(L, index, "texture_released");
+    }
+
+    return handle ? *handle : NULL;
+}
+
 int lua_newtexture(lua_State* L, int width, int height) {
     texture_t** handle = (texture_t**)lua_newuserdata(L, sizeof(texture_t*));
     *handle = graphics_texture_new(width, height, NULL);
@@ -72,6 +85,41 @@ int lua_pushtexture(lua_State* L, texture_t* texture) {
     return 1;
 }
 
+sprite_t* luaL_checksprite(lua_State* L, int index) {
+    sprite_t** handle = NULL;
+    luaL_checktype(L, index, LUA_TUSERDATA);
+
+    // Ensure we have correct userdata
+    handle = (sprite_t**)luaL_testudata(L, index, "sprite_nogc");
+    if (!handle) {
+        handle = (sprite_t**)luaL_checkudata(L, index, "sprite");
+    }
+
+    return *handle;
+}
+
+snapshot_t* luaL_checksnapshot(lua_State* L, int index) {
+    snapshot_t** handle = (snapshot_t**)luaL_checkudata(L, index, "snapshot");
+
+    return *handle;
+}
+
+int lua_pushsprite(lua_State* L, sprite_t* sprite) {
+    sprite_t** handle = (sprite_t**)lua_newuserdata(L, sizeof(sprite_t*));
+    *handle = sprite;
+    luaL_setmetatable(L, "sprite_nogc");
+
+    return 1;
+}
+
+static int sprite_gc(lua_State* L) {
+    sprite_t** sprite = lua_touserdata(L, 1);
+    graphics_sprite_free(*sprite);
+    *sprite = NULL;
+
+    return 0;
+}
+
 static int texture_gc(lua_State* L) {
     texture_t** texture = lua_touserdata(L, 1);
     graphics_texture_free(*texture);
@@ -91,7 +139,7 @@ static int modules_texture_meta_index(lua_State* L) {
 
         for (int i = 0; i < texture->width * texture->height; i++) {
             lua_pushinteger(L, i + 1);
-            lua_pushinteger(L, texture->pixels[i]);
+            lua_pushinteger(L, texture->pixels[i / texture->width * texture->stride + i % texture->width]);
             lua_settable(L, -3);
         }
     }
@@ -129,11 +177,13 @@ static int modules_texture_meta_newindex(lua_State* L) {
                 lua_pushinteger(L, index);
                 lua_gettable(L, 3);
 
-                texture->pixels[i] = (int)luaL_checknumber(L, -1);
+                texture->pixels[i / texture->width * texture->stride + i % texture->width] = (int)luaL_checknumber(L, -1);
 
                 lua_pop(L, 1);
             }
 
+            graphics_dirty_rectangle_add(texture, NULL);
+
             lua_settop(L, 0);
         }
         else {
@@ -192,6 +242,139 @@ static int modules_texture_new(lua_State* L) {
     return 1;
 }
 
+/**
+ * Get a texture for temporary use, such as an off-screen render target.
+ * Unlike new, the pixels are not cleared, so the texture must be cleared or
+ * drawn over entirely before use. Textures of the same size freed earlier
+ * are reused.
+ * @function acquire
+ * @tparam integer width Texture width
+ * @tparam integer height Texture height
+ * @treturn texture
+ */
+static int modules_texture_acquire(lua_State* L) {
+    int width = (int)luaL_checknumber(L, 1);
+    int height = (int)luaL_checknumber(L, 2);
+
+    lua_settop(L, 0);
+
+    texture_t** handle = (texture_t**)lua_newuserdata(L, sizeof(texture_t*));
+    *handle = graphics_texture_acquire(width, height);
+
+    if (!*handle) {
+        luaL_error(L, "error creating texture");
+        lua_settop(L, 0);
+
+        return 0;
+    }
+
+    luaL_setmetatable(L, "texture");
+
+    return 1;
+}
+
+/**
+ * Mark a texture as no longer used. Using it afterwards raises an error.
+ * Batches, sprite batches, the render texture and subtextures may still
+ * draw with it, so its memory returns to the texture pool only once it's
+ * garbage collected.
+ * @function release
+ * @tparam texture.texture texture Texture to release
+ */
+static int modules_texture_release(lua_State* L) {
+    if (!luaL_testudata(L, 1, "texture_released")) {
+        luaL_checkudata(L, 1, "texture");
+    }
+
+    lua_settop(L, 1);
+    luaL_setmetatable(L, "texture_released");
+
+    lua_settop(L, 0);
+
+    return 0;
+}
+
+/**
+ * Get texture pool statistics. Hits and misses count every texture
+ * allocation since start.
+ * @function get_pool_stats
+ * @treturn table Table with fields hits, misses, count (textures held by the
+ * pool), size and capacity (in bytes)
+ */
+static int modules_texture_pool_stats_get(lua_State* L) {
+    texture_pool_stats_t stats;
+    graphics_texture_pool_stats_get(&stats);
+
+    lua_settop(L, 0);
+
+    lua_createtable(L, 0, 5);
+
+    lua_pushinteger(L, stats.hits);
+    lua_setfield(L, -2, "hits");
+
+    lua_pushinteger(L, stats.misses);
+    lua_setfield(L, -2, "misses");
+
+    lua_pushinteger(L, stats.count);
+    lua_setfield(L, -2, "count");
+
+    lua_pushinteger(L, stats.size);
+    lua_setfield(L, -2, "size");
+
+    lua_pushinteger(L, stats.capacity);
+    lua_setfield(L, -2, "capacity");
+
+    return 1;
+}
+
+/**
+ * Set number of bytes the texture pool may hold. Pooled textures over the
+ * new capacity are freed.
+ * @function set_pool_capacity
+ * @tparam integer capacity Capacity in bytes, 0 to disable pooling
+ */
+static int modules_texture_pool_capacity_set(lua_State* L) {
+    lua_Integer capacity = luaL_checkinteger(L, 1);
+    luaL_argcheck(L, capacity >= 0, 1, "capacity must not be negative");
+
+    lua_settop(L, 0);
+
+    graphics_texture_pool_capacity_set((size_t)capacity);
+
+    return 0;
+}
+
+/**
+ * Create new 8x8 texture from a 1bpp bitmask. Useful as a dither pattern.
+ * @function new_bitmask
+ * @tparam integer bits Bitmask rows. The first row is the most significant
+ * byte and the leftmost pixel of a row is its most significant bit.
+ * @tparam integer foreground Color for set bits
+ * @tparam integer background Color for clear bits
+ * @treturn texture
+ */
+static int modules_texture_bitmask_new(lua_State* L) {
+    uint64_t bits = (uint64_t)luaL_checkinteger(L, 1);
+    color_t foreground = (color_t)luaL_checknumber(L, 2);
+    color_t background = (color_t)luaL_checknumber(L, 3);
+
+    lua_settop(L, 0);
+
+    texture_t** handle = (texture_t**)lua_newuserdata(L, sizeof(texture_t*));
+    *handle = graphics_texture_bitmask_new(bits, foreground, background);
+
+    if (!*handle) {
+        luaL_error(L, "error creating texture");
+        lua_settop(L, 0);
+
+        return 0;
+    }
+
+    luaL_setmetatable(L, "texture");
+
+    return 1;
+}
+
 /**
  * @type texture
  */
@@ -237,7 +420,7 @@ static int modules_texture_sub(lua_State* L) {
     int w = (int)luaL_checknumber(L, 4);
     int h = (int)luaL_checknumber(L, 5);
 
-    lua_pop(L, -1);
+    lua_settop(L, 1);
 
     rect_t rect = {x, y, w, h};
 
@@ -253,6 +436,10 @@ static int modules_texture_sub(lua_State* L) {
 
     luaL_setmetatable(L, "texture");
 
+    // Source pixels must outlive the subtexture
+    lua_pushvalue(L, 1);
+    lua_setiuservalue(L, -2, 1);
+
     return 1;
 }
 
@@ -289,6 +476,9 @@ static int modules_texture_pixel_set(lua_State* L) {
 
     graphics_texture_pixel_set(texture, x, y, color);
 
+    rect_t rect = {x, y, 1, 1};
+    graphics_dirty_rectangle_add(texture, &rect);
+
     return 0;
 }
 
@@ -387,6 +577,111 @@ static int modules_texture_blit(lua_State* L) {
     return 0;
 }
 
+/**
+ * Compile this texture into a sprite. Pixels matching the transparent color
+ * are dropped and the rest are stored as runs, so drawing the sprite skips
+ * transparent areas entirely. Later changes to this texture do not affect
+ * the sprite.
+ * @function compile
+ * @tparam ?integer transparent Color to drop (default current transparent color)
+ * @treturn sprite
+ */
+static int modules_texture_compile(lua_State* L) {
+    texture_t* texture = luaL_checktexture(L, 1);
+    color_t transparent = (color_t)luaL_optinteger(L, 2, graphics_draw_transparent_color_get());
+
+    lua_settop(L, 0);
+
+    sprite_t** handle = (sprite_t**)lua_newuserdata(L, sizeof(sprite_t*));
+    *handle = graphics_sprite_new(texture, transparent);
+
+    if (!*handle) {
+        luaL_error(L, "error compiling texture");
+        lua_settop(L, 0);
+
+        return 0;
+    }
+
+    luaL_setmetatable(L, "sprite");
+
+    return 1;
+}
+
+/**
+ * Build mip chain for this texture, replacing any existing one. The raycaster
+ * and mode7 renderers sample distant surfaces from smaller levels of the
+ * chain, which reads less memory and shimmers less. Each level is half the
+ * size of the one before. Levels are not updated when the texture changes,
+ * so the chain must be rebuilt after.
+ * @function build_mipmaps
+ * @tparam ?string filter "majority" picks the most common color of each 2x2
+ * block, "nearest" the color nearest to the block's average color in the
+ * current palette (default "majority")
+ */
+static int modules_texture_mipmaps_build(lua_State* L) {
+    static const char* filters[] = {"nearest", "majority", NULL};
+
+    texture_t* texture = luaL_checktexture(L, 1);
+    mipmap_filter_t filter = (mipmap_filter_t)luaL_checkoption(L, 2, "majority", filters);
+
+    lua_settop(L, 0);
+
+    if (!graphics_texture_mipmaps_build(texture, filter)) {
+        luaL_error(L, "error building mipmaps");
+    }
+
+    return 0;
+}
+
+/**
+ * Free mip chain of this texture.
+ * @function remove_mipmaps
+ */
+static int modules_texture_mipmaps_remove(lua_State* L) {
+    texture_t* texture = luaL_checktexture(L, 1);
+
+    lua_settop(L, 0);
+
+    graphics_texture_mipmaps_free(texture);
+
+    return 0;
+}
+
+/**
+ * Take a read-only snapshot of this texture. Snapshots are stored in tiles,
+ * and tiles with the same pixels as the previous snapshot are shared with
+ * it, so a series of snapshots of a texture only stores what changed in
+ * between. Cheaper than copy for recording frames or undo history.
+ * @function snapshot
+ * @tparam ?snapshot previous Snapshot to share tiles with, usually the last
+ * one taken of this texture
+ * @treturn snapshot
+ */
+static int modules_texture_snapshot(lua_State* L) {
+    texture_t* texture = luaL_checktexture(L, 1);
+    snapshot_t* previous = NULL;
+
+    if (!lua_isnoneornil(L, 2)) {
+        previous = luaL_checksnapshot(L, 2);
+    }
+
+    lua_settop(L, 0);
+
+    snapshot_t** handle = (snapshot_t**)lua_newuserdata(L, sizeof(snapshot_t*));
+    *handle = graphics_snapshot_new(texture, previous);
+
+    if (!*handle) {
+        luaL_error(L, "error creating snapshot");
+        lua_settop(L, 0);
+
+        return 0;
+    }
+
+    luaL_setmetatable(L, "snapshot");
+
+    return 1;
+}
+
 /**
  * An array copy of pixel indices.
  * @tfield {integer,...} pixels
@@ -408,6 +703,11 @@ static const char* modules_texture_fields[] = {
     "clear",
     "clear",
     "blit",
+    "compile",
+    "snapshot",
+    "build_mipmaps",
+    "remove_mipmaps",
+    "release",
     "pixels",
     "width",
     "height",
@@ -416,12 +716,21 @@ static const char* modules_texture_fields[] = {
 
 static const struct luaL_Reg modules_texture_functions[] = {
     {"new", modules_texture_new},
+    {"new_bitmask", modules_texture_bitmask_new},
+    {"acquire", modules_texture_acquire},
+    {"release", modules_texture_release},
+    {"get_pool_stats", modules_texture_pool_stats_get},
+    {"set_pool_capacity", modules_texture_pool_capacity_set},
     {"copy", modules_texture_copy},
     {"sub", modules_texture_sub},
     {"clear", modules_texture_clear},
     {"set_pixel", modules_texture_pixel_set},
     {"get_pixel", modules_texture_pixel_get},
     {"blit", modules_texture_blit},
+    {"compile", modules_texture_compile},
+    {"snapshot", modules_texture_snapshot},
+    {"build_mipmaps", modules_texture_mipmaps_build},
+    {"remove_mipmaps", modules_texture_mipmaps_remove},
     {NULL, NULL}
 };
 
@@ -432,6 +741,162 @@ static const struct luaL_Reg modules_texture_meta_functions[] = {
     {NULL, NULL}
 };
 
+/**
+ * @type sprite
+ */
+
+/**
+ * Sprite width in pixels.
+ * @tfield integer width (read-only)
+ */
+
+/**
+ * Sprite height in pixels.
+ * @tfield integer height (read-only)
+ */
+
+static int modules_sprite_meta_index(lua_State* L) {
+    sprite_t* sprite = luaL_checksprite(L, 1);
+    const char* key = luaL_checkstring(L, 2);
+
+    lua_settop(L, 0);
+
+    if (strcmp(key, "width") == 0) {
+        lua_pushinteger(L, sprite->width);
+    }
+    else if (strcmp(key, "height") == 0) {
+        lua_pushinteger(L, sprite->height);
+    }
+    else {
+        lua_pushnil(L);
+    }
+
+    return 1;
+}
+
+static const char* modules_sprite_fields[] = {
+    "width",
+    "height",
+    NULL
+};
+
+static const struct luaL_Reg modules_sprite_meta_functions[] = {
+    {"__index", modules_sprite_meta_index},
+    {NULL, NULL}
+};
+
+/**
+ * @type snapshot
+ */
+
+static int snapshot_gc(lua_State* L) {
+    snapshot_t** snapshot = lua_touserdata(L, 1);
+    graphics_snapshot_free(*snapshot);
+    *snapshot = NULL;
+
+    return 0;
+}
+
+/**
+ * Returns a new texture with the pixels of this snapshot.
+ * @function to_texture
+ * @treturn texture
+ */
+static int modules_snapshot_texture_new(lua_State* L) {
+    snapshot_t* snapshot = luaL_checksnapshot(L, 1);
+
+    lua_settop(L, 0);
+
+    texture_t** handle = (texture_t**)lua_newuserdata(L, sizeof(texture_t*));
+    *handle = graphics_snapshot_texture_new(snapshot);
+
+    if (!*handle) {
+        luaL_error(L, "error creating texture");
+        lua_settop(L, 0);
+
+        return 0;
+    }
+
+    luaL_setmetatable(L, "texture");
+
+    return 1;
+}
+
+/**
+ * Copy pixels of this snapshot back to a texture of the same size.
+ * @function restore
+ * @tparam texture.texture texture Texture to copy to
+ */
+static int modules_snapshot_restore(lua_State* L) {
+    snapshot_t* snapshot = luaL_checksnapshot(L, 1);
+    texture_t* texture = luaL_checktexture(L, 2);
+
+    lua_settop(L, 0);
+
+    if (!graphics_snapshot_restore(snapshot, texture)) {
+        luaL_error(L, "snapshot size does not match texture size");
+    }
+
+    return 0;
+}
+
+/**
+ * Snapshot width in pixels.
+ * @tfield integer width (read-only)
+ */
+
+/**
+ * Snapshot height in pixels.
+ * @tfield integer height (read-only)
+ */
+
+static const struct luaL_Reg modules_snapshot_functions[] = {
+    {"to_texture", modules_snapshot_texture_new},
+    {"restore", modules_snapshot_restore},
+    {NULL, NULL}
+};
+
+static int modules_snapshot_meta_index(lua_State* L) {
+    snapshot_t* snapshot = luaL_checksnapshot(L, 1);
+    const char* key = luaL_checkstring(L, 2);
+
+    lua_settop(L, 0);
+
+    if (strcmp(key, "width") == 0) {
+        lua_pushinteger(L, snapshot->width);
+        return 1;
+    }
+
+    if (strcmp(key, "height") == 0) {
+        lua_pushinteger(L, snapshot->height);
+        return 1;
+    }
+
+    for (const luaL_Reg* function = modules_snapshot_functions; function->name; function++) {
+        if (strcmp(key, function->name) == 0) {
+            lua_pushcfunction(L, function->func);
+            return 1;
+        }
+    }
+
+    lua_pushnil(L);
+
+    return 1;
+}
+
+static const char* modules_snapshot_fields[] = {
+    "to_texture",
+    "restore",
+    "width",
+    "height",
+    NULL
+};
+
+static const struct luaL_Reg modules_snapshot_meta_functions[] = {
+    {"__index", modules_snapshot_meta_index},
+    {NULL, NULL}
+};
+
 int luaopen_texture(lua_State* L) {
     luaL_newlib(L, modules_texture_functions);
 
@@ -446,6 +911,18 @@ int luaopen_texture(lua_State* L) {
 
     lua_pop(L, 1);
 
+    // Push texture_released userdata metatable. Methods raise an error, but
+    // the texture is only freed once collected.
+    luaL_newmetatable(L, "texture_released");
+    luaL_setfuncs(L, modules_texture_meta_functions, 0);
+    lua_setdummyfields(L, modules_texture_fields);
+
+    lua_pushstring(L, "__gc");
+    lua_pushcfunction(L, texture_gc);
+    lua_settable(L, -3);
+
+    lua_pop(L, 1);
+
     // Push texture_nogc userdata metatable
     luaL_newmetatable(L, "texture_nogc");
     luaL_setfuncs(L, modules_texture_meta_functions, 0);
@@ -453,5 +930,34 @@ int luaopen_texture(lua_State* L) {
 
     lua_pop(L, 1);
 
+    // Push sprite userdata metatable
+    luaL_newmetatable(L, "sprite");
+    luaL_setfuncs(L, modules_sprite_meta_functions, 0);
+    lua_setdummyfields(L, modules_sprite_fields);
+
+    lua_pushstring(L, "__gc");
+    lua_pushcfunction(L, sprite_gc);
+    lua_settable(L, -3);
+
+    lua_pop(L, 1);
+
+    // Push sprite_nogc userdata metatable
+    luaL_newmetatable(L, "sprite_nogc");
+    luaL_setfuncs(L, modules_sprite_meta_functions, 0);
+    lua_setdummyfields(L, modules_sprite_fields);
+
+    lua_pop(L, 1);
+
+    // Push snapshot userdata metatable
+    luaL_newmetatable(L, "snapshot");
+    luaL_setfuncs(L, modules_snapshot_meta_functions, 0);
+    lua_setdummyfields(L, modules_snapshot_fields);
+
+    lua_pushstring(L, "__gc");
+    lua_pushcfunction(L, snapshot_gc);
+    lua_settable(L, -3);
+
+    lua_pop(L, 1);
+
     return 1;
 }
@@ -11,12 +11,24 @@ texture_t* luaL_checktexture(lua_State* L, int index);
 /* If function argument is a texture, return it. If argument is absent or nil, return default_. Otherwise raises an error. */
 texture_t* luaL_opttexture(lua_State* L, int index, texture_t* default_);
 
+/* If value at index is a texture owned by Lua, including released ones, return it. Otherwise return NULL. */
+texture_t* lua_totexture(lua_State* L, int index);
+
 /* Creates and pushes on the stack a new texture userdata. */
 int lua_newtexture(lua_State* L, int width, int height);
 
 /* Pushes a texture onto the stack. Created userdata will not be garbage collected. */
 int lua_pushtexture(lua_State* L, texture_t* texture);
 
+/* Checks whether the function argument arg is a sprite and returns a sprite_t*. */
+sprite_t* luaL_checksprite(lua_State* L, int index);
+
+/* Pushes a sprite onto the stack. Created userdata will not be garbage collected. */
+int lua_pushsprite(lua_State* L, sprite_t* sprite);
+
+/* Checks whether the function argument arg is a snapshot and returns a snapshot_t*. */
+snapshot_t* luaL_checksnapshot(lua_State* L, int index);
+
 int luaopen_texture(lua_State* L);
 
 #endif
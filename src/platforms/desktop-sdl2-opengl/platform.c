@@ -113,9 +113,22 @@ void platform_draw(void) {
     texture_t* render_texture = graphics_render_texture_get();
     uint32_t* palette = graphics_palette_get();
 
+    // Only the region changed since last frame needs converting and uploading
+    rect_t dirty;
+    bool is_dirty = graphics_dirty_rectangle_get(&dirty);
+
     // Convert core render buffer from indexed to rgba pixels
-    for (int i = 0; i < render_texture->width * render_texture->height; i++) {
-        pixels[i] = palette[render_texture->pixels[i]];
+    if (is_dirty) {
+        for (int y = dirty.y; y < dirty.y + dirty.height; y++) {
+            color_t* source = render_texture->pixels + y * render_texture->stride + dirty.x;
+            uint32_t* destination = pixels + y * render_texture->width + dirty.x;
+
+            for (int x = 0; x < dirty.width; x++) {
+                destination[x] = palette[source[x]];
+            }
+        }
+
+        graphics_dirty_rectangle_clear();
     }
 
     // Maintain aspect ratio and center in window
@@ -155,17 +168,20 @@ void platform_draw(void) {
 
     glUseProgram(shader_program);
 
-    glTexSubImage2D(
-        GL_TEXTURE_2D,          // target
-        0,                      // level
-        0,                      // x offset
-        0,                      // y offset
-        render_texture->width,  // width
-        render_texture->height, // height
-        GL_RGBA,                // format
-        GL_UNSIGNED_BYTE,       // type,
-        pixels
-    );
+    // Upload whole rows so no unpack row length is needed
+    if (is_dirty) {
+        glTexSubImage2D(
+            GL_TEXTURE_2D,                          // target
+            0,                                      // level
+            0,                                      // x offset
+            dirty.y,                                // y offset
+            render_texture->width,                  // width
+            dirty.height,                           // height
+            GL_RGBA,                                // format
+            GL_UNSIGNED_BYTE,                       // type,
+            pixels + dirty.y * render_texture->width
+        );
+    }
 
     glBindTexture(GL_TEXTURE_2D, texture);
 
@@ -201,6 +217,9 @@ bool platform_handle_event(event_t* event) {
         sdl_pixels_resize(width, height);
         opengl_init(width, height);
 
+        // New frame buffer starts out empty
+        graphics_dirty_rectangle_add(graphics_render_texture_get(), NULL);
+
         return true;
     }
 
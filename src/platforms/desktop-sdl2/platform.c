@@ -85,9 +85,22 @@ void platform_draw(void) {
     texture_t* render_texture = graphics_render_texture_get();
     uint32_t* palette = graphics_palette_get();
 
+    // Only the region changed since last frame needs converting and uploading
+    rect_t dirty;
+    bool is_dirty = graphics_dirty_rectangle_get(&dirty);
+
     // Convert core render buffer from indexed to rgba pixels
-    for (int i = 0; i < render_texture->width * render_texture->height; i++) {
-        pixels[i] = palette[render_texture->pixels[i]];
+    if (is_dirty) {
+        for (int y = dirty.y; y < dirty.y + dirty.height; y++) {
+            color_t* source = render_texture->pixels + y * render_texture->stride + dirty.x;
+            uint32_t* destination = pixels + y * render_texture->width + dirty.x;
+
+            for (int x = 0; x < dirty.width; x++) {
+                destination[x] = palette[source[x]];
+            }
+        }
+
+        graphics_dirty_rectangle_clear();
     }
 
     // Maintain aspect ratio and center in window
@@ -116,12 +129,16 @@ void platform_draw(void) {
     display_rect.x = (window_width - display_rect.w) / 2;
     display_rect.y = (window_height - display_rect.h) / 2;
 
-    SDL_UpdateTexture(
-        render_buffer_texture,
-        NULL,
-        pixels,
-        render_texture->width * sizeof(uint32_t)
-    );
+    if (is_dirty) {
+        SDL_Rect dirty_rect = {dirty.x, dirty.y, dirty.width, dirty.height};
+
+        SDL_UpdateTexture(
+            render_buffer_texture,
+            &dirty_rect,
+            pixels + dirty.y * render_texture->width + dirty.x,
+            render_texture->width * sizeof(uint32_t)
+        );
+    }
 
     SDL_RenderClear(renderer);
 
@@ -156,6 +173,9 @@ bool platform_handle_event(event_t* event) {
             log_fatal("Error creating SDL frame buffer texture");
         }
 
+        // New frame buffer starts out empty
+        graphics_dirty_rectangle_add(graphics_render_texture_get(), NULL);
+
         return true;
     }
 
@@ -44,6 +44,9 @@ void mode7_renderer_render(mode7_renderer_t* renderer, texture_t* texture, mode7
     vec3_zero(st1);
     vec3_zero(work);
 
+    // Every scanline is drawn
+    graphics_dirty_rectangle_add(renderer->render_texture, NULL);
+
     for (int y = 0; y < renderer->render_texture->height; y++) {
         // Per scanline callback
         callback(y);
@@ -83,6 +86,10 @@ static void draw_scanline(mode7_renderer_t* renderer, int y, float s0, float t0,
     float current_s = s0;
     float current_t = t0;
 
+    // Distant scanlines read from a smaller mip level, if the texture has any
+    int level = graphics_texture_mipmap_level_get(texture, sqrtf(s_inc * s_inc + t_inc * t_inc));
+    texture_t* mipmap = graphics_texture_mipmap_get(texture, level);
+
     for (int x = 0; x <= scanline_width; x++) {
         float s = current_s;
         float t = current_t;
@@ -101,7 +108,7 @@ static void draw_scanline(mode7_renderer_t* renderer, int y, float s0, float t0,
             if (t < 0 && t > -1.0f) t = -1.0f;
         }
 
-        color_t c = graphics_texture_pixel_get(texture, s, t);
+        color_t c = graphics_texture_mipmap_pixel_get(texture, mipmap, level, s, t);
         c = draw_palette[c];
 
         if (c != graphics_draw_transparent_color_get()) {
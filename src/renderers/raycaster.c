@@ -6,6 +6,7 @@
 
 #include "../assets.h"
 #include "../graphics.h"
+#include "../graphics/blit.h"
 #include "../log.h"
 #include "../math.h"
 
@@ -283,8 +284,6 @@ static void ray_cast(ray_t* ray, raycaster_map_t* map) {
     }
 }
 
-static raycaster_renderer_t* active_renderer;
-
 /**
  * Shades given pixel to given brightness using the shade table.
  *
@@ -360,11 +359,15 @@ static void renderer_draw_wall_strip(raycaster_renderer_t* renderer, texture_t*
     const float t_step = wall_texture->height / (float)length;
     float t = start * t_step;
 
+    // Distant walls read from a smaller mip level, if the texture has any
+    const int level = graphics_texture_mipmap_level_get(wall_texture, t_step);
+    texture_t* mipmap = graphics_texture_mipmap_get(wall_texture, level);
+
     for (int i = start; i < length; i++) {
         int y = y0 + i;
         if (y >= bottom) break;
 
-        color_t c = graphics_texture_pixel_get(wall_texture, s, t + 0.0001f);
+        color_t c = graphics_texture_mipmap_pixel_get(wall_texture, mipmap, level, s, t + 0.0001f);
         t += t_step;
         if (c == graphics_draw_transparent_color_get()) continue;
 
@@ -436,8 +439,6 @@ void raycaster_renderer_render_map(raycaster_renderer_t* renderer, raycaster_map
         return;
     }
 
-    active_renderer = renderer;
-
     mfloat_t* position = renderer->camera.position;
     mfloat_t* direction = renderer->camera.direction;
     float fov = renderer->camera.fov;
@@ -451,6 +452,9 @@ void raycaster_renderer_render_map(raycaster_renderer_t* renderer, raycaster_map
     const float height = render_texture->height;
     const float half_height = height / 2.0f;
 
+    // Every column is drawn
+    graphics_dirty_rectangle_add(render_texture, NULL);
+
     // Ensure direction is normalized
     vec2_normalize(direction, direction);
 
@@ -599,6 +603,17 @@ void raycaster_renderer_render_map(raycaster_renderer_t* renderer, raycaster_map
 
         float brightness = renderer_distance_based_brightness_get(renderer, distance);
 
+        // Mip level of the last floor and ceiling texture drawn. Every pixel
+        // of the scanline steps the same distance, but textures may differ
+        // in size.
+        texture_t* floor_texture = NULL;
+        texture_t* floor_mipmap = NULL;
+        int floor_level = 0;
+
+        texture_t* ceiling_texture = NULL;
+        texture_t* ceiling_mipmap = NULL;
+        int ceiling_level = 0;
+
         // Draw current scanline for both floor and ceiling
         for (int i = 0; i < width; i++) {
             int tx = (int)floor_next[0];
@@ -614,7 +629,13 @@ void raycaster_renderer_render_map(raycaster_renderer_t* renderer, raycaster_map
                     int x = frac(floor_next[0]) * texture->width;
                     int y = frac(floor_next[1]) * texture->height;
 
-                    color_t color = graphics_texture_pixel_get(texture, x, y);
+                    if (texture != floor_texture) {
+                        floor_texture = texture;
+                        floor_level = graphics_texture_mipmap_level_get(texture, scale * texture->width);
+                        floor_mipmap = graphics_texture_mipmap_get(texture, floor_level);
+                    }
+
+                    color_t color = graphics_texture_mipmap_pixel_get(texture, floor_mipmap, floor_level, x, y);
 
                     // Floor
                     graphics_texture_pixel_set(
@@ -634,7 +655,13 @@ void raycaster_renderer_render_map(raycaster_renderer_t* renderer, raycaster_map
                     int x = frac(floor_next[0]) * texture->width;
                     int y = frac(floor_next[1]) * texture->height;
 
-                    color_t color = graphics_texture_pixel_get(texture, x, y);
+                    if (texture != ceiling_texture) {
+                        ceiling_texture = texture;
+                        ceiling_level = graphics_texture_mipmap_level_get(texture, scale * texture->width);
+                        ceiling_mipmap = graphics_texture_mipmap_get(texture, ceiling_level);
+                    }
+
+                    color_t color = graphics_texture_mipmap_pixel_get(texture, ceiling_mipmap, ceiling_level, x, y);
 
                     // Ceiling
                     graphics_texture_pixel_set(
@@ -649,41 +676,10 @@ void raycaster_renderer_render_map(raycaster_renderer_t* renderer, raycaster_map
     }
 }
 
-/** Depth of currently rendering sprite. */
-static float sprite_depth = FLT_MAX;
-
-/**
- * Pixel drawing function that respects ray depth.
- *
- * @param source_texture Texture to copy from
- * @param destination_texture Texture to copy to
- * @param sx Source x-coordinate
- * @param sy Source y-coordinate
- * @param dx Destination x-coordinate
- * @param dy Destination y-coordinate
- */
-static void sprite_depth_blit_func(texture_t* source_texture, texture_t* destination_texture, int sx, int sy, int dx, int dy) {
-    float depth = sprite_depth;
-    float d = renderer_depth_buffer_pixel_get(active_renderer, dx, dy);
-    if (d <= depth) return;
-
-    color_t pixel = graphics_texture_pixel_get(source_texture, sx, sy);
-    if (pixel == graphics_draw_transparent_color_get()) return;
-
-    renderer_depth_buffer_pixel_set(active_renderer, dx, dy, depth);
-
-    float brightness = renderer_distance_based_brightness_get(active_renderer, sprite_depth);
-    pixel = renderer_shade_pixel(active_renderer, pixel, brightness);
-
-    graphics_texture_pixel_set(destination_texture, dx, dy, pixel);
-}
-
 void raycaster_renderer_render_sprite(raycaster_renderer_t* renderer, texture_t* sprite, mfloat_t* position) {
     if (!renderer->render_texture) return;
     if (!sprite) return;
 
-    active_renderer = renderer;
-
     texture_t* render_texture = renderer->render_texture;
     mfloat_t* direction = renderer->camera.direction;
     mfloat_t* camera_position = renderer->camera.position;
@@ -737,17 +733,29 @@ void raycaster_renderer_render_sprite(raycaster_renderer_t* renderer, texture_t*
         sprite_height
     };
 
-    // Set sprite depth for blit func
-    sprite_depth = distance;
+    // Sprite is shaded evenly, so shade each color once up front
+    float brightness = renderer_distance_based_brightness_get(renderer, distance);
+    color_t shade[256];
+    color_t color = 0;
+
+    // Counts through all 256 colors and stops when the color wraps to 0
+    do {
+        shade[color] = renderer_shade_pixel(renderer, color, brightness);
+    } while (++color != 0);
+
+    rect_t bounds = {0, 0, render_texture->width, render_texture->height};
+    blit_t blit = {
+        .mode = BLIT_DEPTH_SHADED,
+        .transparent = graphics_draw_transparent_color_get(),
+        .palette = shade,
+        .depth_buffer = renderer->depth_buffer,
+        .depth_stride = render_texture->width,
+        .depth = distance
+    };
 
-    // Draw sprite
-    graphics_blit(
-        sprite,
-        render_texture,
-        NULL,
-        &rect,
-        sprite_depth_blit_func
-    );
+    // Draw sprite, respecting ray depth
+    graphics_blit_rect(render_texture, &bounds, sprite, NULL, &rect, &blit);
+    graphics_dirty_rectangle_add(render_texture, &rect);
 }
 
 /**
@@ -796,8 +804,6 @@ void raycaster_renderer_render_sprite_oriented(raycaster_renderer_t* renderer, t
     if (!renderer->render_texture) return;
     if (!sprite) return;
 
-    active_renderer = renderer;
-
     texture_t* render_texture = renderer->render_texture;
     mfloat_t* direction = renderer->camera.direction;
     mfloat_t* camera_position = renderer->camera.position;
@@ -1005,6 +1011,7 @@ void raycaster_renderer_render_sprite_oriented(raycaster_renderer_t* renderer, t
     float sprite_width = vec3_distance(b, a);
 
     // 5. Render sprite as raycast columns.
+    graphics_dirty_rectangle_add(render_texture, NULL);
 
     // Clamp to visible bounds
     left_bound = fminf(left_bound, half_width);
@@ -130,6 +130,7 @@ thread_pool_t* threads_thread_pool_new(size_t count) {
     pool->work_finished = threads_thread_condition_new();
     pool->thread_count = count;
     pool->active_thread_count = 0;
+    pool->stop = false;
 
     thread_t* thread = NULL;
     for (size_t i = 0; i < count; i++) {
@@ -191,6 +192,8 @@ void threads_thread_pool_free(thread_pool_t* thread_pool) {
     thread_pool_work_t* current = NULL;
     thread_pool_work_t* next = NULL;
 
+    threads_lock_lock(thread_pool->lock);
+
     // Clear out work queue
     current = thread_pool->head;
     while(current != NULL) {
@@ -3,6 +3,11 @@
 
 #include <stdlib.h>
 
+/**
+ * Storage class for variables with a separate instance for each thread.
+ */
+#define THREAD_LOCAL __thread
+
 typedef struct thread thread_t;
 
 /**